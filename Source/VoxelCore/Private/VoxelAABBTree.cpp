@@ -45,14 +45,19 @@ void FVoxelAABBTree::Initialize(TVoxelArray<FElement>&& InElements)
 			NodeLevel = -1;
 			NodeIndex = -1;
 		}
+		int64 GetAllocatedSize() const
+		{
+			return Elements.GetAllocatedSize();
+		}
 	};
+	using FNodePool = TVoxelObjectPool<FNodeToProcess>;
 
 	TVoxelArray<TUniquePtr<FNodeToProcess>> NodesToProcess;
 	NodesToProcess.Reserve(ExpectedNumNodes);
 
 	// Create root node
 	{
-		TUniquePtr<FNodeToProcess> NodeToProcess = MakeUnique<FNodeToProcess>();
+		TUniquePtr<FNodeToProcess> NodeToProcess = FNodePool::Allocate();
 		NodeToProcess->Elements = MoveTemp(InElements);
 		NodeToProcess->Bounds = FVoxelBox::InvertedInfinite;
 		for (const FElement& Element : NodeToProcess->Elements)
@@ -69,23 +74,12 @@ void FVoxelAABBTree::Initialize(TVoxelArray<FElement>&& InElements)
 		NodesToProcess.Add(MoveTemp(NodeToProcess));
 	}
 
-	TVoxelArray<TUniquePtr<FNodeToProcess>> PooledNodesToProcess;
-	const auto AllocateNodeToProcess = [&]
-	{
-		if (PooledNodesToProcess.Num() > 0)
-		{
-			return PooledNodesToProcess.Pop();
-		}
-		return MakeUnique<FNodeToProcess>();
-	};
-
 	while (NodesToProcess.Num())
 	{
 		TUniquePtr<FNodeToProcess> NodeToProcess = NodesToProcess.Pop();
 		ON_SCOPE_EXIT
 		{
-			NodeToProcess->Reset();
-			PooledNodesToProcess.Add(MoveTemp(NodeToProcess));
+			FNodePool::Return(MoveTemp(NodeToProcess));
 		};
 
 		Nodes.Reserve(Nodes.Num() + 2);
@@ -107,8 +101,8 @@ void FVoxelAABBTree::Initialize(TVoxelArray<FElement>&& InElements)
 			continue;
 		}
 
-		TUniquePtr<FNodeToProcess> ChildToProcess0 = AllocateNodeToProcess();
-		TUniquePtr<FNodeToProcess> ChildToProcess1 = AllocateNodeToProcess();
+		TUniquePtr<FNodeToProcess> ChildToProcess0 = FNodePool::Allocate();
+		TUniquePtr<FNodeToProcess> ChildToProcess1 = FNodePool::Allocate();
 
 		// Split on max center variance
 		// Could also split on max bound size, but variance should lead to better results
@@ -248,6 +242,15 @@ void FVoxelAABBTree::BulkRaycast(
 			check(RayPositions.Num() == RayDirections.Num());
 			return RayPositions.Num();
 		}
+		void Reset()
+		{
+			RayPositions.Reset();
+			RayDirections.Reset();
+		}
+		int64 GetAllocatedSize() const
+		{
+			return RayPositions.GetAllocatedSize() + RayDirections.GetAllocatedSize();
+		}
 
 		void Initialize(
 			const FCachedArray& Parent,
@@ -275,22 +278,7 @@ void FVoxelAABBTree::BulkRaycast(
 			}
 		}
 	};
-	TVoxelArray<TUniquePtr<FCachedArray>> PooledCachedArrays;
-
-	const auto AllocateCachedArray = [&]
-	{
-		if (PooledCachedArrays.Num() > 0)
-		{
-			return PooledCachedArrays.Pop();
-		}
-		return MakeUnique<FCachedArray>();
-	};
-	const auto ReturnToPool = [&](TUniquePtr<FCachedArray>& CachedArray)
-	{
-		CachedArray->RayPositions.Reset();
-		CachedArray->RayDirections.Reset();
-		PooledCachedArrays.Add(MoveTemp(CachedArray));
-	};
+	using FCachedArrayPool = TVoxelObjectPool<FCachedArray>;
 
 	struct FQueuedNode
 	{
@@ -302,7 +290,7 @@ void FVoxelAABBTree::BulkRaycast(
 	{
 		VOXEL_SCOPE_COUNTER("First copy");
 
-		TUniquePtr<FCachedArray> CachedArray = AllocateCachedArray();
+		TUniquePtr<FCachedArray> CachedArray = FCachedArrayPool::Allocate();
 		CachedArray->RayPositions = TVoxelArray<FVector3f>(InRayPositions);
 		CachedArray->RayDirections = TVoxelArray<FVector3f>(InRayDirections);
 
@@ -318,7 +306,7 @@ void FVoxelAABBTree::BulkRaycast(
 		FQueuedNode QueuedNode = QueuedNodes.Pop();
 		ON_SCOPE_EXIT
 		{
-			ReturnToPool(QueuedNode.CachedArray);
+			FCachedArrayPool::Return(MoveTemp(QueuedNode.CachedArray));
 		};
 
 		const FNode& Node = Nodes[QueuedNode.NodeIndex];
@@ -327,10 +315,10 @@ void FVoxelAABBTree::BulkRaycast(
 			const FLeaf& Leaf = Leaves[Node.LeafIndex];
 			for (const FElement& Element : Leaf.Elements)
 			{
-				TUniquePtr<FCachedArray> CachedArray = AllocateCachedArray();
+				TUniquePtr<FCachedArray> CachedArray = FCachedArrayPool::Allocate();
 				ON_SCOPE_EXIT
 				{
-					ReturnToPool(CachedArray);
+					FCachedArrayPool::Return(MoveTemp(CachedArray));
 				};
 				CachedArray->Initialize(*QueuedNode.CachedArray, Element.Bounds);
 
@@ -348,11 +336,11 @@ void FVoxelAABBTree::BulkRaycast(
 		else
 		{
 			{
-				TUniquePtr<FCachedArray> CachedArray = AllocateCachedArray();
+				TUniquePtr<FCachedArray> CachedArray = FCachedArrayPool::Allocate();
 				CachedArray->Initialize(*QueuedNode.CachedArray, Node.ChildBounds0);
 				if (CachedArray->Num() == 0)
 				{
-					ReturnToPool(CachedArray);
+					FCachedArrayPool::Return(MoveTemp(CachedArray));
 				}
 				else
 				{
@@ -360,11 +348,11 @@ void FVoxelAABBTree::BulkRaycast(
 				}
 			}
 			{
-				TUniquePtr<FCachedArray> CachedArray = AllocateCachedArray();
+				TUniquePtr<FCachedArray> CachedArray = FCachedArrayPool::Allocate();
 				CachedArray->Initialize(*QueuedNode.CachedArray, Node.ChildBounds1);
 				if (CachedArray->Num() == 0)
 				{
-					ReturnToPool(CachedArray);
+					FCachedArrayPool::Return(MoveTemp(CachedArray));
 				}
 				else
 				{
@@ -45,14 +45,19 @@ void FVoxelAABBTree2D::Initialize(TVoxelArray<FElement>&& InElements)
 			NodeLevel = -1;
 			NodeIndex = -1;
 		}
+		int64 GetAllocatedSize() const
+		{
+			return Elements.GetAllocatedSize();
+		}
 	};
+	using FNodePool = TVoxelObjectPool<FNodeToProcess>;
 
 	TVoxelArray<TUniquePtr<FNodeToProcess>> NodesToProcess;
 	NodesToProcess.Reserve(ExpectedNumNodes);
 
 	// Create root node
 	{
-		TUniquePtr<FNodeToProcess> NodeToProcess = MakeUnique<FNodeToProcess>();
+		TUniquePtr<FNodeToProcess> NodeToProcess = FNodePool::Allocate();
 		NodeToProcess->Elements = MoveTemp(InElements);
 		NodeToProcess->Bounds = FVoxelBox2D::InvertedInfinite;
 		for (const FElement& Element : NodeToProcess->Elements)
@@ -69,23 +74,12 @@ void FVoxelAABBTree2D::Initialize(TVoxelArray<FElement>&& InElements)
 		NodesToProcess.Add(MoveTemp(NodeToProcess));
 	}
 
-	TVoxelArray<TUniquePtr<FNodeToProcess>> PooledNodesToProcess;
-	const auto AllocateNodeToProcess = [&]
-	{
-		if (PooledNodesToProcess.Num() > 0)
-		{
-			return PooledNodesToProcess.Pop();
-		}
-		return MakeUnique<FNodeToProcess>();
-	};
-
 	while (NodesToProcess.Num())
 	{
 		TUniquePtr<FNodeToProcess> NodeToProcess = NodesToProcess.Pop();
 		ON_SCOPE_EXIT
 		{
-			NodeToProcess->Reset();
-			PooledNodesToProcess.Add(MoveTemp(NodeToProcess));
+			FNodePool::Return(MoveTemp(NodeToProcess));
 		};
 
 		Nodes.Reserve(Nodes.Num() + 2);
@@ -107,8 +101,8 @@ void FVoxelAABBTree2D::Initialize(TVoxelArray<FElement>&& InElements)
 			continue;
 		}
 
-		TUniquePtr<FNodeToProcess> ChildToProcess0 = AllocateNodeToProcess();
-		TUniquePtr<FNodeToProcess> ChildToProcess1 = AllocateNodeToProcess();
+		TUniquePtr<FNodeToProcess> ChildToProcess0 = FNodePool::Allocate();
+		TUniquePtr<FNodeToProcess> ChildToProcess1 = FNodePool::Allocate();
 
 		// Split on max center variance
 		// Could also split on max bound size, but variance should lead to better results
@@ -119,6 +119,8 @@ namespace Chaos
 
 			VOXEL_SCOPE_COUNTER("Fast cook");
 
+			using EElement = FVoxelFastAABBTree::EElement;
+
 			FVoxelFastAABBTree::FElementArray Elements;
 			Elements.SetNum(Triangles.Num());
 			{
@@ -131,15 +133,15 @@ namespace Chaos
 					const FVector3f VertexB = Vertices[Triangle.Y];
 					const FVector3f VertexC = Vertices[Triangle.Z];
 
-					Elements.Payload[Index] = Index;
+					Elements.Get<EElement::Payload>(Index) = Index;
 
-					Elements.MinX[Index] = FMath::Min3(VertexA.X, VertexB.X, VertexC.X);
-					Elements.MinY[Index] = FMath::Min3(VertexA.Y, VertexB.Y, VertexC.Y);
-					Elements.MinZ[Index] = FMath::Min3(VertexA.Z, VertexB.Z, VertexC.Z);
+					Elements.Get<EElement::MinX>(Index) = FMath::Min3(VertexA.X, VertexB.X, VertexC.X);
+					Elements.Get<EElement::MinY>(Index) = FMath::Min3(VertexA.Y, VertexB.Y, VertexC.Y);
+					Elements.Get<EElement::MinZ>(Index) = FMath::Min3(VertexA.Z, VertexB.Z, VertexC.Z);
 
-					Elements.MaxX[Index] = FMath::Max3(VertexA.X, VertexB.X, VertexC.X);
-					Elements.MaxY[Index] = FMath::Max3(VertexA.Y, VertexB.Y, VertexC.Y);
-					Elements.MaxZ[Index] = FMath::Max3(VertexA.Z, VertexB.Z, VertexC.Z);
+					Elements.Get<EElement::MaxX>(Index) = FMath::Max3(VertexA.X, VertexB.X, VertexC.X);
+					Elements.Get<EElement::MaxY>(Index) = FMath::Max3(VertexA.Y, VertexB.Y, VertexC.Y);
+					Elements.Get<EElement::MaxZ>(Index) = FMath::Max3(VertexA.Z, VertexB.Z, VertexC.Z);
 				}
 			}
 
@@ -205,16 +207,10 @@ namespace Chaos
 					{
 						TPayloadBoundsElement<int32, float>& DestElement = Elems[ElementIndex];
 
-						DestElement.Payload = SrcLeaf.Elements.Payload[ElementIndex];
+						DestElement.Payload = SrcLeaf.Elements.Get<EElement::Payload>(ElementIndex);
 						DestElement.Bounds = FAABB3f(
-							FVector3f(
-								SrcLeaf.Elements.MinX[ElementIndex],
-								SrcLeaf.Elements.MinY[ElementIndex],
-								SrcLeaf.Elements.MinZ[ElementIndex]),
-							FVector3f(
-								SrcLeaf.Elements.MaxX[ElementIndex],
-								SrcLeaf.Elements.MaxY[ElementIndex],
-								SrcLeaf.Elements.MaxZ[ElementIndex]));
+							FVoxelFastAABBTree::GetElementMin(SrcLeaf.Elements, ElementIndex),
+							FVoxelFastAABBTree::GetElementMax(SrcLeaf.Elements, ElementIndex));
 					}
 				}
 			}
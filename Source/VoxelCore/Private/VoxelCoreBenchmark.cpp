@@ -1,6 +1,11 @@
 ﻿// Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelMinimal.h"
+#include "VoxelFastOctree.h"
+#include "VoxelLinearOctree.h"
+#include "VoxelAABBTree.h"
+#include "VoxelFastAABBTree.h"
+#include "VoxelSpatialHashGrid.h"
 #include "VoxelWelfordVariance.h"
 #include "Misc/OutputDeviceConsole.h"
 #include "Framework/Application/SlateApplication.h"
@@ -709,6 +714,196 @@ CUSTOM_BENCHMARK
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+CUSTOM_BENCHMARK
+{
+	// Same capacity, increasing number of elements
+	constexpr int32 Capacity = 1 << 21;
+	constexpr int32 NumLookups = 1000000;
+
+	for (const double LoadFactor : { 0.25, 0.5, 0.75, 0.85 })
+	{
+		const int32 NumElements = int32(Capacity * LoadFactor);
+
+		TVoxelMap<int32, int32> VoxelMap;
+		TVoxelSwissMap<int32, int32> SwissMap;
+		Experimental::TRobinHoodHashMap<int32, int32> RobinHoodMap;
+
+		VoxelMap.Reserve(NumElements);
+		RobinHoodMap.Reserve(NumElements);
+
+		// Reserving NumElements would pick the smallest capacity that fits them, not Capacity
+		SwissMap.Reserve(Capacity / SwissMap.MaxLoadDenominator * SwissMap.MaxLoadNumerator);
+		check(SwissMap.GetCapacity() == Capacity);
+
+		FRandomStream Stream;
+		Stream.Initialize(1337);
+
+		TVoxelArray<int32> Keys;
+		while (Keys.Num() < NumElements)
+		{
+			const int32 Key = Stream.RandRange(0, MAX_int32 / 2);
+			if (SwissMap.Contains(Key))
+			{
+				continue;
+			}
+
+			Keys.Add(Key);
+			VoxelMap.Add_CheckNew(Key, Key);
+			SwissMap.Add_CheckNew(Key, Key);
+			RobinHoodMap.FindOrAdd(Key, Key);
+		}
+
+		check(SwissMap.GetCapacity() == Capacity);
+		check(FMath::IsNearlyEqual(double(SwissMap.Num()) / SwissMap.GetCapacity(), LoadFactor, 0.001));
+
+		TVoxelArray<int32> HitKeys;
+		TVoxelArray<int32> MissKeys;
+		for (int32 Index = 0; Index < NumLookups; Index++)
+		{
+			HitKeys.Add(Keys[Stream.RandRange(0, Keys.Num() - 1)]);
+			// Keys are all <= MAX_int32 / 2
+			MissKeys.Add(Stream.RandRange(MAX_int32 / 2 + 1, MAX_int32));
+		}
+
+		int32 Value = 0;
+		const FString Suffix = FString::Printf(TEXT(" (load factor %.2f)"), LoadFactor);
+
+		RunBenchmark<NumLookups>(
+			TEXT("TVoxelMap::Find hit") + Suffix,
+			[&]
+			{
+				for (const int32 Key : HitKeys)
+				{
+					Value += *VoxelMap.Find(Key);
+				}
+			},
+			TEXT("TVoxelSwissMap::Find hit") + Suffix,
+			[&]
+			{
+				for (const int32 Key : HitKeys)
+				{
+					Value += *SwissMap.Find(Key);
+				}
+			});
+
+		RunBenchmark<NumLookups>(
+			TEXT("TVoxelMap::Find miss") + Suffix,
+			[&]
+			{
+				for (const int32 Key : MissKeys)
+				{
+					Value += VoxelMap.Find(Key) != nullptr;
+				}
+			},
+			TEXT("TVoxelSwissMap::Find miss") + Suffix,
+			[&]
+			{
+				for (const int32 Key : MissKeys)
+				{
+					Value += SwissMap.Find(Key) != nullptr;
+				}
+			});
+
+		RunBenchmark<NumLookups>(
+			TEXT("TRobinHoodHashMap::Find hit") + Suffix,
+			[&]
+			{
+				for (const int32 Key : HitKeys)
+				{
+					Value += *RobinHoodMap.Find(Key);
+				}
+			},
+			TEXT("TVoxelSwissMap::Find hit") + Suffix,
+			[&]
+			{
+				for (const int32 Key : HitKeys)
+				{
+					Value += *SwissMap.Find(Key);
+				}
+			});
+
+		RunBenchmark<NumLookups>(
+			TEXT("TRobinHoodHashMap::Find miss") + Suffix,
+			[&]
+			{
+				for (const int32 Key : MissKeys)
+				{
+					Value += RobinHoodMap.Find(Key) != nullptr;
+				}
+			},
+			TEXT("TVoxelSwissMap::Find miss") + Suffix,
+			[&]
+			{
+				for (const int32 Key : MissKeys)
+				{
+					Value += SwissMap.Find(Key) != nullptr;
+				}
+			});
+
+		LOG("TVoxelMap: %s TVoxelSwissMap: %s",
+			*FVoxelUtilities::BytesToString(VoxelMap.GetAllocatedSize()),
+			*FVoxelUtilities::BytesToString(SwissMap.GetAllocatedSize()));
+	}
+}
+
+BENCHMARK
+{
+	TVoxelMap<int32, int32> VoxelMap;
+	TVoxelSwissMap<int32, int32> SwissMap;
+
+	Run(
+		"TVoxelMap::Remove + Add",
+		[&]
+		{
+			VoxelMap.Empty();
+			VoxelMap.Reserve(Num);
+
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				VoxelMap.Add_CheckNew(Index, Index);
+			}
+		},
+		[&]
+		{
+			FRandomStream Stream;
+			Stream.Initialize(1337);
+
+			for (int32 Run = 0; Run < Num; Run++)
+			{
+				const int32 Value = Stream.RandRange(0, Num - 1);
+				VoxelMap.Remove(Value);
+				VoxelMap.Add_CheckNew(Value, Value);
+			}
+		},
+		"TVoxelSwissMap::Remove + Add",
+		[&]
+		{
+			SwissMap.Empty();
+			SwissMap.Reserve(Num);
+
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				SwissMap.Add_CheckNew(Index, Index);
+			}
+		},
+		[&]
+		{
+			FRandomStream Stream;
+			Stream.Initialize(1337);
+
+			for (int32 Run = 0; Run < Num; Run++)
+			{
+				const int32 Value = Stream.RandRange(0, Num - 1);
+				SwissMap.Remove(Value);
+				SwissMap.Add_CheckNew(Value, Value);
+			}
+		});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 BENCHMARK
 {
 	TArray<int32> Array;
@@ -814,6 +1009,59 @@ CUSTOM_BENCHMARK
 		"FVoxelBitArray::CountSetBits makes use of the popcount intrinsics");
 }
 
+CUSTOM_BENCHMARK
+{
+	// Masks over a 256^3 volume
+	constexpr int32 Num = 256 * 256 * 256;
+
+	for (const float Density : { 0.001f, 0.01f, 0.5f })
+	{
+		FVoxelBitArray Array;
+		Array.SetNumZeroed(Num);
+
+		FRandomStream Stream(1337);
+		for (int32 Index = 0; Index < int32(Num * Density); Index++)
+		{
+			Array[Stream.RandRange(0, Num - 1)] = true;
+		}
+
+		const FVoxelHierarchicalBitArray HierarchicalArray(Array);
+
+		int64 Value = 0;
+
+		RunBenchmark<1>(
+			FString::Printf(TEXT("FVoxelBitArray::ForAllSetBits(%g%%)"), Density * 100),
+			[&]
+			{
+				Array.ForAllSetBits([&](const int32 Index)
+				{
+					Value += Index;
+				});
+			},
+			FString::Printf(TEXT("FVoxelHierarchicalBitArray::ForAllSetBits(%g%%)"), Density * 100),
+			[&]
+			{
+				HierarchicalArray.ForAllSetBits([&](const int32 Index)
+				{
+					Value += Index;
+				});
+			});
+
+		RunBenchmark<1>(
+			FString::Printf(TEXT("FVoxelBitArray::CountSetBits(%g%%)"), Density * 100),
+			[&]
+			{
+				Value += Array.CountSetBits();
+			},
+			FString::Printf(TEXT("FVoxelHierarchicalBitArray::CountSetBits(%g%%)"), Density * 100),
+			[&]
+			{
+				Value += HierarchicalArray.CountSetBits();
+			},
+			"Empty words are skipped 64 at a time, dense masks pay for the summary lookups");
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -1042,6 +1290,1017 @@ CUSTOM_BENCHMARK
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+CUSTOM_BENCHMARK
+{
+	constexpr int32 Depth = 16;
+	constexpr int32 NumSteps = 100;
+
+	TVoxelFastOctree<> FastOctree(Depth);
+	TVoxelLinearOctree<> LinearOctree(Depth);
+
+	// Typical LOD update: invoker moving along X, nodes subdivided if closer than 2x their size
+	const auto MakePredicate = [](const FIntVector& Invoker)
+	{
+		return [Invoker](const auto& NodeRef)
+		{
+			return NodeRef.GetBounds().SquaredDistanceToPoint(Invoker) < FMath::Square<uint64>(2 * NodeRef.GetSize());
+		};
+	};
+
+	int32 NumAdded = 0;
+	int32 NumRemoved = 0;
+
+	RunBenchmark<NumSteps>(
+		"TVoxelFastOctree::Update (LOD, moving invoker)",
+		[&]
+		{
+			FastOctree.MoveFrom(*MakeUnique<TVoxelFastOctree<>>(Depth));
+		},
+		[&]
+		{
+			for (int32 Step = 0; Step < NumSteps; Step++)
+			{
+				FastOctree.Update(
+					MakePredicate(FIntVector(Step * 64, 0, 0)),
+					[&](auto) { NumAdded++; },
+					[&](auto) { NumRemoved++; });
+			}
+		},
+		"TVoxelLinearOctree::Update (LOD, moving invoker)",
+		[&]
+		{
+			LinearOctree.MoveFrom(*MakeUnique<TVoxelLinearOctree<>>(Depth));
+		},
+		[&]
+		{
+			for (int32 Step = 0; Step < NumSteps; Step++)
+			{
+				LinearOctree.Update(
+					MakePredicate(FIntVector(Step * 64, 0, 0)),
+					[&](auto) { NumAdded++; },
+					[&](auto) { NumRemoved++; });
+			}
+		});
+
+	int64 Sum = 0;
+
+	RunBenchmark<1>(
+		"TVoxelFastOctree::TraverseBounds (LOD tree)",
+		[&]
+		{
+			FastOctree.TraverseBounds(FVoxelIntBox(FIntVector(-1000), FIntVector(1000)), [&](const TVoxelFastOctree<>::FNodeRef& NodeRef)
+			{
+				Sum += NodeRef.GetHeight();
+			});
+		},
+		"TVoxelLinearOctree::TraverseBounds (LOD tree)",
+		[&]
+		{
+			LinearOctree.TraverseBounds(FVoxelIntBox(FIntVector(-1000), FIntVector(1000)), [&](const TVoxelLinearOctree<>::FNodeRef& NodeRef)
+			{
+				Sum += NodeRef.GetHeight();
+			});
+		});
+
+	LOG("TVoxelFastOctree with %d nodes: %s TVoxelLinearOctree with %d nodes: %s",
+		FastOctree.NumNodes(),
+		*FVoxelUtilities::BytesToString(FastOctree.GetAllocatedSize()),
+		LinearOctree.NumNodes(),
+		*FVoxelUtilities::BytesToString(LinearOctree.GetAllocatedSize()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	constexpr int32 Depth = 16;
+	constexpr int32 NumSteps = 100;
+
+	TVoxelFastOctree<> FullOctree(Depth);
+	TVoxelFastOctree<> IncrementalOctree(Depth);
+
+	// Invoker moving by a few voxels per frame: only a thin band of nodes changes
+	const auto GetInvoker = [](const int32 Step)
+	{
+		return FVector(Step * 3., Step * -1., Step * 2.);
+	};
+	const auto GetThreshold = [](const int32 Height)
+	{
+		return 2. * (1 << Height);
+	};
+	const auto MakePredicate = [&](const FVector& Invoker, int64& NumVisitedNodes)
+	{
+		return [&, Invoker](const TVoxelFastOctree<>::FNodeRef& NodeRef)
+		{
+			NumVisitedNodes++;
+			return NodeRef.GetBounds().ToVoxelBox().DistanceToPoint(Invoker) < GetThreshold(NodeRef.GetHeight());
+		};
+	};
+
+	int64 NumFullVisitedNodes = 0;
+	int64 NumIncrementalVisitedNodes = 0;
+
+	RunBenchmark<NumSteps>(
+		"TVoxelFastOctree::Update (small invoker moves)",
+		[&]
+		{
+			FullOctree.MoveFrom(*MakeUnique<TVoxelFastOctree<>>(Depth));
+			FullOctree.Update(MakePredicate(GetInvoker(0), NumFullVisitedNodes), [](auto) {}, [](auto) {});
+			NumFullVisitedNodes = 0;
+		},
+		[&]
+		{
+			for (int32 Step = 1; Step <= NumSteps; Step++)
+			{
+				FullOctree.Update(MakePredicate(GetInvoker(Step), NumFullVisitedNodes), [](auto) {}, [](auto) {});
+			}
+		},
+		"TVoxelFastOctree::UpdateIncremental (small invoker moves)",
+		[&]
+		{
+			IncrementalOctree.MoveFrom(*MakeUnique<TVoxelFastOctree<>>(Depth));
+			IncrementalOctree.Update(MakePredicate(GetInvoker(0), NumIncrementalVisitedNodes), [](auto) {}, [](auto) {});
+			NumIncrementalVisitedNodes = 0;
+		},
+		[&]
+		{
+			for (int32 Step = 1; Step <= NumSteps; Step++)
+			{
+				IncrementalOctree.UpdateIncremental(
+					MakePredicate(GetInvoker(Step), NumIncrementalVisitedNodes),
+					TVoxelFastOctree<>::MakeDistanceBandFilter(GetInvoker(Step - 1), GetInvoker(Step), GetThreshold));
+			}
+		});
+
+	check(FullOctree.NumNodes() == IncrementalOctree.NumNodes());
+
+	LOG("Nodes visited per step: Update %lld UpdateIncremental %lld (%d nodes)",
+		NumFullVisitedNodes / NumSteps,
+		NumIncrementalVisitedNodes / NumSteps,
+		FullOctree.NumNodes());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	constexpr int32 NumElements = 10000;
+	constexpr int32 NumQueries = 1000;
+	constexpr int32 NumSteps = 10;
+
+	// Small objects moving every frame, queried by small boxes
+	TVoxelArray<FVoxelBox> Bounds;
+	TVoxelArray<FVector> Velocities;
+	TVoxelArray<int32> Payloads;
+	{
+		const FRandomStream Stream(1234);
+		for (int32 Index = 0; Index < NumElements; Index++)
+		{
+			const FVector Position = Stream.GetFraction() * FVector(10000.);
+			Bounds.Add(FVoxelBox(Position - 10., Position + 10.));
+			Velocities.Add(Stream.VRand() * 50.);
+			Payloads.Add(Index);
+		}
+	}
+
+	const auto MoveElements = [&](const int32 Step)
+	{
+		for (int32 Index = 0; Index < NumElements; Index++)
+		{
+			Bounds[Index] = Bounds[Index].ShiftBy((Step % 2 == 0 ? 1 : -1) * Velocities[Index]);
+		}
+	};
+	const auto GetQuery = [&](const int32 Index)
+	{
+		const FVector Center = Bounds[(Index * 7919) % NumElements].GetCenter();
+		return FVoxelBox(Center - 100., Center + 100.);
+	};
+
+	int64 Sum = 0;
+
+	TVoxelSpatialHashGrid<int32> Grid(100.);
+	TVoxelArray<int32> Ids;
+
+	RunBenchmark<NumSteps>(
+		"FVoxelAABBTree rebuild + queries",
+		[&]
+		{
+		},
+		[&]
+		{
+			for (int32 Step = 0; Step < NumSteps; Step++)
+			{
+				MoveElements(Step);
+
+				const TSharedRef<FVoxelAABBTree> Tree = FVoxelAABBTree::Create(Bounds);
+				for (int32 Query = 0; Query < NumQueries; Query++)
+				{
+					Tree->TraverseBounds(GetQuery(Query), [&](const int32 Payload)
+					{
+						Sum += Payload;
+					});
+				}
+			}
+		},
+		"TVoxelSpatialHashGrid::BulkUpdate + queries",
+		[&]
+		{
+			Grid.Reset();
+			Grid.BulkAdd(Bounds, Payloads, Ids);
+		},
+		[&]
+		{
+			for (int32 Step = 0; Step < NumSteps; Step++)
+			{
+				MoveElements(Step);
+
+				Grid.BulkUpdate(Ids, Bounds);
+				for (int32 Query = 0; Query < NumQueries; Query++)
+				{
+					Grid.ForeachIntersecting(GetQuery(Query), [&](int32, const int32 Payload)
+					{
+						Sum += Payload;
+					});
+				}
+			}
+		});
+
+	LOG("TVoxelSpatialHashGrid with %d elements: %s", Grid.Num(), *FVoxelUtilities::BytesToString(Grid.GetAllocatedSize()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	constexpr int32 Num = 1 << 16;
+
+	TVoxelArray<float> Values;
+	FVoxelUtilities::SetNumZeroed(Values, Num);
+
+	// Cost grows with the index: the last static slice does most of the work
+	const auto DoWork = [](float& Value, const int32 Index)
+	{
+		float Result = Value;
+		for (int32 Iteration = 0; Iteration < Index / 64; Iteration++)
+		{
+			Result = FMath::Sin(Result + Iteration);
+		}
+		Value = Result;
+	};
+
+	RunBenchmark<1>(
+		"ParallelFor static split",
+		[&]
+		{
+		},
+		[&]
+		{
+			ParallelFor(MakeVoxelArrayView(Values), [&](float& Value, const int32 Index)
+			{
+				DoWork(Value, Index);
+			});
+		},
+		"ParallelFor work stealing",
+		[&]
+		{
+		},
+		[&]
+		{
+			ParallelFor(MakeVoxelArrayView(Values), 64, [&](float& Value, const int32 Index)
+			{
+				DoWork(Value, Index);
+			});
+		},
+		"Load imbalanced work");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	for (const int32 Num : { 1000 * 1000, 10 * 1000 * 1000, VOXEL_DEBUG ? 10 * 1000 * 1000 : 100 * 1000 * 1000 })
+	{
+		const FRandomStream Stream(Num);
+
+		TVoxelArray<uint64> Keys;
+		FVoxelUtilities::SetNumFast(Keys, Num);
+		for (uint64& Key : Keys)
+		{
+			// 63-bit Morton codes
+			Key = FVoxelUtilities::MortonEncode3D(FIntVector(
+				Stream.RandHelper(1 << 21),
+				Stream.RandHelper(1 << 21),
+				Stream.RandHelper(1 << 21)));
+		}
+
+		TVoxelArray<uint64> AlgoData;
+		TVoxelArray<uint64> RadixData;
+
+		RunBenchmark<1>(
+			FString::Printf(TEXT("Algo::Sort %dM uint64"), Num / 1000000),
+			[&]
+			{
+				AlgoData = Keys;
+			},
+			[&]
+			{
+				Algo::Sort(AlgoData);
+			},
+			FString::Printf(TEXT("FVoxelUtilities::RadixSort %dM uint64"), Num / 1000000),
+			[&]
+			{
+				RadixData = Keys;
+			},
+			[&]
+			{
+				FVoxelUtilities::RadixSort(RadixData);
+			});
+
+		check(RadixData == AlgoData);
+	}
+
+	// Large enough to use the parallel passes, too slow for the startup tests
+	{
+		constexpr int32 Num = 1000 * 1000;
+		const FRandomStream Stream(42);
+
+		TVoxelArray<uint32> Keys;
+		TVoxelArray<uint32> Payloads;
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			// Few distinct high bits so that passes get skipped and keys collide
+			Keys.Add(Stream.GetUnsignedInt() & 0x00FF0FFF);
+			Payloads.Add(Index);
+		}
+
+		TVoxelArray<uint32> Sorted = Keys;
+		FVoxelUtilities::RadixSort(Sorted, Payloads);
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			check(Sorted[Index] == Keys[Payloads[Index]]);
+
+			if (Index > 0)
+			{
+				check(Sorted[Index - 1] <= Sorted[Index]);
+				// Stable
+				check(Sorted[Index - 1] != Sorted[Index] || Payloads[Index - 1] < Payloads[Index]);
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Large enough to use the parallel blocks, too slow for the startup tests
+	for (const int32 Num : { 1000 * 1000, 10 * 1000 * 1000 })
+	{
+		const FRandomStream Stream(Num);
+
+		TVoxelArray<int32> Values;
+		TVoxelArray<bool> Mask;
+		FVoxelUtilities::SetNumFast(Values, Num);
+		FVoxelUtilities::SetNumFast(Mask, Num);
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Values[Index] = Stream.RandRange(0, 4);
+			Mask[Index] = Values[Index] == 0;
+		}
+
+		TVoxelArray<int32> SerialScan;
+		TVoxelArray<int32> Scan;
+		FVoxelUtilities::SetNumFast(SerialScan, Num);
+		FVoxelUtilities::SetNumFast(Scan, Num);
+
+		RunBenchmark<1>(
+			FString::Printf(TEXT("Serial inclusive scan %dM"), Num / 1000000),
+			[&]
+			{
+				int32 Sum = 0;
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					Sum += Values[Index];
+					SerialScan[Index] = Sum;
+				}
+			},
+			FString::Printf(TEXT("FVoxelUtilities::InclusiveScan %dM"), Num / 1000000),
+			[&]
+			{
+				FVoxelUtilities::InclusiveScan(Values, Scan);
+			});
+
+		check(Scan == SerialScan);
+
+		TVoxelArray<int32> SerialIndices;
+		TVoxelArray<int32> Indices;
+
+		RunBenchmark<1>(
+			FString::Printf(TEXT("Serial compaction %dM"), Num / 1000000),
+			[&]
+			{
+				SerialIndices.Reset();
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					if (Mask[Index])
+					{
+						SerialIndices.Add(Index);
+					}
+				}
+			},
+			FString::Printf(TEXT("FVoxelUtilities::CompactIndices %dM"), Num / 1000000),
+			[&]
+			{
+				FVoxelUtilities::CompactIndices(Mask, Indices);
+			});
+
+		check(Indices == SerialIndices);
+
+		TVoxelArray<int32> Partitioned;
+		FVoxelUtilities::SetNumFast(Partitioned, Num);
+		check(FVoxelUtilities::PartitionIndices(Mask, Partitioned) == SerialIndices.Num());
+		check(FMemory::Memcmp(Partitioned.GetData(), SerialIndices.GetData(), SerialIndices.Num() * sizeof(int32)) == 0);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Oversubscribed: more tasks than cores, each holding the lock for a few microseconds
+	const int32 NumTasks = 4 * FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	constexpr int32 NumIterations = 1000;
+
+	FVoxelCriticalSection CriticalSection;
+	FVoxelHybridCriticalSection HybridCriticalSection("Benchmark");
+
+	TVoxelArray<float> Data;
+	FVoxelUtilities::SetNumZeroed(Data, 256);
+
+	const auto DoWork = [&]
+	{
+		for (float& Value : Data)
+		{
+			Value = FMath::Sqrt(Value + 1.f);
+		}
+	};
+
+	RunBenchmark<1>(
+		"FVoxelCriticalSection oversubscribed",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](int32)
+			{
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					VOXEL_SCOPE_LOCK(CriticalSection);
+					DoWork();
+				}
+			});
+		},
+		"FVoxelHybridCriticalSection oversubscribed",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](int32)
+			{
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					VOXEL_SCOPE_LOCK(HybridCriticalSection);
+					DoWork();
+				}
+			});
+		});
+
+	const FVoxelLockStats Stats = HybridCriticalSection.GetStats();
+	// RunBenchmark runs each side 100 times
+	check(Stats.NumAcquisitions == 100 * int64(NumTasks) * NumIterations);
+	check(Stats.NumContendedAcquisitions <= Stats.NumAcquisitions);
+
+	LOG("FVoxelHybridCriticalSection: %lld acquisitions, %lld contended, %fs waiting",
+		Stats.NumAcquisitions,
+		Stats.NumContendedAcquisitions,
+		Stats.WaitTime);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Many readers, no writers: measures how well read locks scale with the number of threads
+	const int32 NumTasks = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	constexpr int32 NumIterations = 100000;
+
+	FVoxelSharedCriticalSection SharedCriticalSection;
+	FVoxelShardedSharedCriticalSection ShardedCriticalSection;
+	TVoxelSeqLock<FIntVector4> SeqLock(FIntVector4(1, 2, 3, 4));
+	const FIntVector4 Data(1, 2, 3, 4);
+
+	TVoxelArray<int64> Sums;
+	FVoxelUtilities::SetNumZeroed(Sums, NumTasks);
+
+	RunBenchmark<1>(
+		"FVoxelSharedCriticalSection many readers",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				int64 Sum = 0;
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					VOXEL_SCOPE_READ_LOCK(SharedCriticalSection);
+					Sum += Data.X + Data.W;
+				}
+				Sums[TaskIndex] = Sum;
+			});
+		},
+		"FVoxelShardedSharedCriticalSection many readers",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				int64 Sum = 0;
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					VOXEL_SCOPE_READ_LOCK(ShardedCriticalSection);
+					Sum += Data.X + Data.W;
+				}
+				Sums[TaskIndex] = Sum;
+			});
+		});
+
+	RunBenchmark<1>(
+		"FVoxelShardedSharedCriticalSection many readers",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				int64 Sum = 0;
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					VOXEL_SCOPE_READ_LOCK(ShardedCriticalSection);
+					Sum += Data.X + Data.W;
+				}
+				Sums[TaskIndex] = Sum;
+			});
+		},
+		"TVoxelSeqLock many readers",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				int64 Sum = 0;
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					const FIntVector4 Value = SeqLock.Read();
+					Sum += Value.X + Value.W;
+				}
+				Sums[TaskIndex] = Sum;
+			});
+		});
+
+	// Oversubscribed readers with one write every 16 iterations
+	const int32 NumContendedTasks = 2 * NumTasks;
+	constexpr int32 NumContendedIterations = 1000;
+
+	const auto RunContended = [&](auto& CriticalSection, FIntVector4& Value)
+	{
+		ParallelFor(NumContendedTasks, [&](const int32 TaskIndex)
+		{
+			for (int32 Index = 0; Index < NumContendedIterations; Index++)
+			{
+				if (Index % 16 == 0)
+				{
+					VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+					Value.X++;
+					Value.W++;
+				}
+				else
+				{
+					VOXEL_SCOPE_READ_LOCK(CriticalSection);
+					check(Value.X == Value.W);
+				}
+			}
+		});
+	};
+
+	FIntVector4 SharedValue(ForceInit);
+	FIntVector4 ShardedValue(ForceInit);
+
+	RunBenchmark<1>(
+		"FVoxelSharedCriticalSection readers + writers",
+		[&]
+		{
+			RunContended(SharedCriticalSection, SharedValue);
+		},
+		"FVoxelShardedSharedCriticalSection readers + writers",
+		[&]
+		{
+			RunContended(ShardedCriticalSection, ShardedValue);
+		});
+
+	// RunBenchmark runs each side 100 times
+	check(ShardedValue.X == 100 * NumContendedTasks * FVoxelUtilities::DivideCeil_Positive(NumContendedIterations, 16));
+	check(SharedValue == ShardedValue);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Shared cache hit by an increasing number of threads, mostly hits
+	constexpr int32 NumKeys = 1 << 16;
+	constexpr int32 NumLookupsPerThread = 100000;
+
+	for (int32 NumThreads = 1; NumThreads <= FPlatformMisc::NumberOfCoresIncludingHyperthreads(); NumThreads *= 2)
+	{
+		FVoxelCriticalSection CriticalSection;
+		TVoxelMap<uint32, int32> Map_RequiresLock;
+		TVoxelConcurrentMap<uint32, int32> ConcurrentMap;
+
+		const auto GetKey = [](const int32 ThreadIndex, const int32 Index)
+		{
+			return FVoxelUtilities::MurmurHash32(ThreadIndex * NumLookupsPerThread + Index) % NumKeys;
+		};
+
+		RunBenchmark<NumLookupsPerThread>(
+			FString::Printf(TEXT("TVoxelMap + FVoxelCriticalSection %d threads"), NumThreads),
+			[&]
+			{
+				ParallelFor(NumThreads, [&](const int32 ThreadIndex)
+				{
+					for (int32 Index = 0; Index < NumLookupsPerThread; Index++)
+					{
+						const uint32 Key = GetKey(ThreadIndex, Index);
+
+						VOXEL_SCOPE_LOCK(CriticalSection);
+
+						if (!Map_RequiresLock.Contains(Key))
+						{
+							Map_RequiresLock.Add_CheckNew(Key, Key);
+						}
+					}
+				});
+			},
+			FString::Printf(TEXT("TVoxelConcurrentMap %d threads"), NumThreads),
+			[&]
+			{
+				ParallelFor(NumThreads, [&](const int32 ThreadIndex)
+				{
+					for (int32 Index = 0; Index < NumLookupsPerThread; Index++)
+					{
+						const uint32 Key = GetKey(ThreadIndex, Index);
+
+						ConcurrentMap.FindOrAdd(Key, [&]
+						{
+							return int32(Key);
+						});
+					}
+				});
+			});
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Parallel mesh generation: each task emits vertices in small batches
+	const int32 NumTasks = 4 * FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	constexpr int32 NumBatchesPerTask = 1000;
+	constexpr int32 NumPerBatch = 48;
+
+	const auto WriteBatch = [](const TVoxelArrayView<FVector3f> Vertices, const int32 TaskIndex, const int32 BatchIndex)
+	{
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			Vertices[Index] = FVector3f(float(TaskIndex), float(BatchIndex), float(Index));
+		}
+	};
+
+	TVoxelArray<TVoxelArray<FVector3f>> TaskVertices;
+	TVoxelArray<FVector3f> MergedVertices;
+	TVoxelConcurrentChunkedArray<FVector3f> ConcurrentVertices;
+
+	RunBenchmark<1>(
+		"Per-task arrays + merge",
+		[&]
+		{
+			TaskVertices.Reset();
+			TaskVertices.SetNum(NumTasks);
+			MergedVertices.Reset();
+		},
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				TVoxelArray<FVector3f>& Vertices = TaskVertices[TaskIndex];
+
+				for (int32 BatchIndex = 0; BatchIndex < NumBatchesPerTask; BatchIndex++)
+				{
+					const int32 Index = Vertices.AddUninitialized(NumPerBatch);
+					WriteBatch(MakeVoxelArrayView(Vertices).Slice(Index, NumPerBatch), TaskIndex, BatchIndex);
+				}
+			});
+
+			int32 Num = 0;
+			for (const TVoxelArray<FVector3f>& Vertices : TaskVertices)
+			{
+				Num += Vertices.Num();
+			}
+
+			MergedVertices.Reserve(Num);
+			for (const TVoxelArray<FVector3f>& Vertices : TaskVertices)
+			{
+				MergedVertices.Append(Vertices);
+			}
+		},
+		"TVoxelConcurrentChunkedArray",
+		[&]
+		{
+			ConcurrentVertices.Empty();
+		},
+		[&]
+		{
+			ParallelFor(NumTasks, [&](const int32 TaskIndex)
+			{
+				for (int32 BatchIndex = 0; BatchIndex < NumBatchesPerTask; BatchIndex++)
+				{
+					const int32 Index = ConcurrentVertices.AddUninitialized(NumPerBatch);
+
+					ConcurrentVertices.ForeachView(Index, NumPerBatch, [&](const int32 ViewIndex, const TVoxelArrayView<FVector3f> View)
+					{
+						WriteBatch(View, TaskIndex, BatchIndex);
+					});
+				}
+			});
+		},
+		"No merge step, no lock");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	// Per-chunk helper with a scratch buffer, created and destroyed by every task
+	struct FHelper
+	{
+		TVoxelArray<FVector3f> Positions;
+
+		void Reset()
+		{
+			Positions.Reset();
+		}
+		int64 GetAllocatedSize() const
+		{
+			return Positions.GetAllocatedSize();
+		}
+	};
+	using FPool = TVoxelObjectPool<FHelper>;
+
+	const int32 NumTasks = 4 * FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	constexpr int32 NumIterations = 1000;
+
+	const auto DoWork = [](FHelper& Helper)
+	{
+		Helper.Positions.Reserve(1024);
+		for (int32 Index = 0; Index < 64; Index++)
+		{
+			Helper.Positions.Add(FVector3f(float(Index)));
+		}
+	};
+
+	const int64 NumNewBefore = FPool::GetNumNew();
+
+	RunBenchmark<1>(
+		"MakeUnique",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](int32)
+			{
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					const TUniquePtr<FHelper> Helper = MakeUnique<FHelper>();
+					DoWork(*Helper);
+				}
+			});
+		},
+		"TVoxelObjectPool",
+		[&]
+		{
+			ParallelFor(NumTasks, [&](int32)
+			{
+				for (int32 Index = 0; Index < NumIterations; Index++)
+				{
+					TUniquePtr<FHelper> Helper = FPool::Allocate();
+					DoWork(*Helper);
+					FPool::Return(MoveTemp(Helper));
+				}
+			});
+		});
+
+	LOG("\tNote: TVoxelObjectPool created %lld objects", FPool::GetNumNew() - NumNewBefore);
+}
+
+CUSTOM_BENCHMARK
+{
+	// 32^3 chunk of materials using 16 distinct values
+	constexpr int32 Num = 32 * 32 * 32;
+	constexpr int32 NumReads = 1000000;
+
+	TVoxelArray<uint16> Array;
+	FVoxelUtilities::SetNumFast(Array, Num);
+
+	FRandomStream Stream(1337);
+	for (uint16& Value : Array)
+	{
+		Value = uint16(Stream.RandRange(0, 15) * 100);
+	}
+
+	TVoxelPaletteArray<uint16> PaletteArray;
+	PaletteArray.SetAll(Array);
+
+	TVoxelArray<int32> Indices;
+	FVoxelUtilities::SetNumFast(Indices, NumReads);
+	for (int32& Index : Indices)
+	{
+		Index = Stream.RandRange(0, Num - 1);
+	}
+
+	int64 Value = 0;
+
+	RunBenchmark<NumReads>(
+		"TVoxelArray random reads",
+		[&]
+		{
+			for (const int32 Index : Indices)
+			{
+				Value += Array[Index];
+			}
+		},
+		"TVoxelPaletteArray random reads",
+		[&]
+		{
+			for (const int32 Index : Indices)
+			{
+				Value += PaletteArray[Index];
+			}
+		});
+
+	TVoxelArray<uint16> DecodedValues;
+	FVoxelUtilities::SetNumFast(DecodedValues, Num);
+
+	RunBenchmark<1>(
+		"TVoxelPaletteArray::SetAll",
+		[&]
+		{
+			PaletteArray.SetAll(Array);
+		},
+		"TVoxelPaletteArray::GetAll",
+		[&]
+		{
+			PaletteArray.GetAll(DecodedValues);
+		});
+
+	LOG("\tNote: TVoxelArray uses %lldB, TVoxelPaletteArray uses %lldB",
+		Array.GetAllocatedSize(),
+		PaletteArray.GetAllocatedSize());
+}
+
+CUSTOM_BENCHMARK
+{
+	// Snapshot a 100k map every frame for async readers, with a few updates per frame
+	constexpr int32 Num = 100000;
+	constexpr int32 NumFrames = 100;
+	constexpr int32 NumUpdatesPerFrame = 100;
+
+	TVoxelMap<int32, int32> Map;
+	TVoxelPersistentMap<int32, int32> PersistentMap;
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		Map.Add_CheckNew(Index, Index);
+		PersistentMap.Add_CheckNew(Index, Index);
+	}
+
+	RunBenchmark<NumFrames>(
+		"TVoxelMap copy",
+		[&]
+		{
+			FRandomStream Stream(0);
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				for (int32 Index = 0; Index < NumUpdatesPerFrame; Index++)
+				{
+					Map.FindOrAdd(Stream.RandRange(0, Num - 1)) = Frame;
+				}
+
+				const TVoxelMap<int32, int32> Snapshot = Map;
+				check(Snapshot.Num() == Num);
+			}
+		},
+		"TVoxelPersistentMap copy",
+		[&]
+		{
+			FRandomStream Stream(0);
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				for (int32 Index = 0; Index < NumUpdatesPerFrame; Index++)
+				{
+					PersistentMap.Add(Stream.RandRange(0, Num - 1), Frame);
+				}
+
+				const TVoxelPersistentMap<int32, int32> Snapshot = PersistentMap;
+				check(Snapshot.Num() == Num);
+			}
+		},
+		"Time per frame: updates only copy the nodes on their path once per snapshot");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+CUSTOM_BENCHMARK
+{
+	constexpr int32 NumElements = 100000;
+	constexpr int32 NumQueries = 100000;
+
+	FRandomStream Stream(0);
+
+	FVoxelFastAABBTree::FElementArray Elements;
+	for (int32 Index = 0; Index < NumElements; Index++)
+	{
+		const FVector3f Min = FVector3f(Stream.FRandRange(-1000.f, 1000.f), Stream.FRandRange(-1000.f, 1000.f), Stream.FRandRange(-1000.f, 1000.f));
+		Elements.Add(Index, Min.X, Min.Y, Min.Z, Min.X + 5.f, Min.Y + 5.f, Min.Z + 5.f);
+	}
+
+	FVoxelFastAABBTree Tree;
+	Tree.Initialize(MoveTemp(Elements));
+
+	TVoxelArray<float> MinX;
+	TVoxelArray<float> MinY;
+	TVoxelArray<float> MinZ;
+	TVoxelArray<float> MaxX;
+	TVoxelArray<float> MaxY;
+	TVoxelArray<float> MaxZ;
+	for (int32 Index = 0; Index < NumQueries; Index++)
+	{
+		const FVector3f Min = FVector3f(Stream.FRandRange(-1000.f, 1000.f), Stream.FRandRange(-1000.f, 1000.f), Stream.FRandRange(-1000.f, 1000.f));
+		MinX.Add(Min.X);
+		MinY.Add(Min.Y);
+		MinZ.Add(Min.Z);
+		MaxX.Add(Min.X + 10.f);
+		MaxY.Add(Min.Y + 10.f);
+		MaxZ.Add(Min.Z + 10.f);
+	}
+
+	const FVoxelFastAABBTree::FQueryArrayView Queries{ MinX, MinY, MinZ, MaxX, MaxY, MaxZ };
+
+	int64 Value = 0;
+
+	RunBenchmark<1>(
+		"FVoxelFastAABBTree::Intersects loop",
+		[&]
+		{
+			for (int32 Index = 0; Index < NumQueries; Index++)
+			{
+				Value += Tree.Intersects(
+					FVector3f(MinX[Index], MinY[Index], MinZ[Index]),
+					FVector3f(MaxX[Index], MaxY[Index], MaxZ[Index]));
+			}
+		},
+		"FVoxelFastAABBTree::BulkIntersectsAny",
+		[&]
+		{
+			Value += Tree.BulkIntersectsAny(Queries).CountSetBits();
+		},
+		"100k queries against 100k boxes: queries are traversed as packets, and chunks run in parallel");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 }
 
 #undef RUN_BENCHMARK
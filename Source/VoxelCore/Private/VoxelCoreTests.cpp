@@ -1,6 +1,12 @@
 ﻿// Copyright Voxel Plugin SAS. All Rights Reserved.
 
 #include "VoxelMinimal.h"
+#include "VoxelFastOctree.h"
+#include "VoxelLinearOctree.h"
+#include "VoxelInvokerChunkTracker.h"
+#include "VoxelHeightmapPyramid.h"
+#include "VoxelSpatialHashGrid.h"
+#include "VoxelFastAABBTree.h"
 
 VOXEL_RUN_ON_STARTUP_GAME()
 {
@@ -24,4 +30,1399 @@ VOXEL_RUN_ON_STARTUP_GAME()
 		TVoxelSet<int32> Set2 = Set;
 		TVoxelSet<float> Set3 = TVoxelSet<float>(Set);
 	}
+
+	{
+		const FIntVector Position(123, 456789, 1);
+		check(FVoxelUtilities::MortonDecode3D(FVoxelUtilities::MortonEncode3D(Position)) == Position);
+	}
+
+	{
+		TVoxelFastOctree<> FastOctree(8);
+		TVoxelLinearOctree<> LinearOctree(8);
+
+		const auto Predicate = [](const auto& NodeRef)
+		{
+			return NodeRef.GetBounds().SquaredDistanceToPoint(FIntVector(10, -20, 30)) < FMath::Square<uint64>(2 * NodeRef.GetSize());
+		};
+
+		FastOctree.Update(Predicate, [](auto) {}, [](auto) {});
+		LinearOctree.Update(Predicate, [](auto) {}, [](auto) {});
+		check(FastOctree.NumNodes() == LinearOctree.NumNodes());
+
+		TVoxelLinearOctree<> BulkOctree(8);
+		BulkOctree.Initialize(LinearOctree.GetKeys());
+		check(FVoxelUtilities::Equal(BulkOctree.GetKeys(), LinearOctree.GetKeys()));
+
+		const TVoxelLinearOctree<>::FNodeRef Leaf = LinearOctree.FindLeaf(FIntVector(10, -20, 30));
+		check(Leaf.GetHeight() == 0);
+		check(Leaf.GetBounds().Contains(FIntVector(10, -20, 30)));
+
+		TVoxelLinearOctree<>::FNodeRef Neighbor = Leaf;
+		check(LinearOctree.TryGetNeighbor(Leaf, FIntVector(1, 0, 0), Neighbor));
+		check(Neighbor.GetMin() == Leaf.GetMin() + FIntVector(1, 0, 0));
+
+		// Further than the tree size, would wrap around if truncated to 21 bits
+		check(!LinearOctree.TryGetNeighbor(Leaf, FIntVector((1 << 21) + 1, 0, 0), Neighbor));
+		check(!LinearOctree.TryGetNeighbor(Leaf, FIntVector(0, 0, -(1 << 21) - 1), Neighbor));
+	}
+
+	{
+		const auto MakePredicate = [](const FVector& Invoker)
+		{
+			return [=](const TVoxelFastOctree<>::FNodeRef& NodeRef)
+			{
+				return NodeRef.GetBounds().DistanceToPoint(Invoker) < 2 * NodeRef.GetSize();
+			};
+		};
+		const auto GetThreshold = [](const int32 Height)
+		{
+			return 2 * (1 << Height);
+		};
+		// A node is identified by its center and its height
+		const auto GetNodes = [](const TVoxelFastOctree<>& Octree)
+		{
+			TVoxelSet<FIntVector4> Nodes;
+			Octree.Traverse([&](const TVoxelFastOctree<>::FNodeRef& NodeRef)
+			{
+				Nodes.Add_CheckNew(FIntVector4(NodeRef.GetCenter(), NodeRef.GetHeight()));
+			});
+			return Nodes;
+		};
+
+		TVoxelFastOctree<> FullOctree(10);
+		TVoxelFastOctree<> IncrementalOctree(10);
+		TVoxelFastOctree<> ParallelOctree(10);
+
+		FVector Invoker = FVector::ZeroVector;
+		FullOctree.Update(MakePredicate(Invoker), [](auto) {}, [](auto) {});
+		IncrementalOctree.Update(MakePredicate(Invoker), [](auto) {}, [](auto) {});
+		ParallelOctree.Update(MakePredicate(Invoker), [](auto) {}, [](auto) {});
+
+		for (int32 Step = 0; Step < 10; Step++)
+		{
+			const FVector NewInvoker = Invoker + FVector(7, -3, 5);
+
+			FullOctree.Update(MakePredicate(NewInvoker), [](auto) {}, [](auto) {});
+
+			IncrementalOctree.UpdateIncremental(
+				MakePredicate(NewInvoker),
+				TVoxelFastOctree<>::MakeDistanceBandFilter(Invoker, NewInvoker, GetThreshold));
+
+			ParallelOctree.UpdateParallel(MakePredicate(NewInvoker));
+
+			check(FullOctree.NumNodes() == IncrementalOctree.NumNodes());
+			check(FullOctree.NumNodes() == ParallelOctree.NumNodes());
+
+			const TVoxelSet<FIntVector4> FullNodes = GetNodes(FullOctree);
+			check(FullNodes.Num() == FullOctree.NumNodes());
+			check(FullNodes.OrderIndependentEqual(GetNodes(IncrementalOctree)));
+			check(FullNodes.OrderIndependentEqual(GetNodes(ParallelOctree)));
+
+			Invoker = NewInvoker;
+		}
+	}
+
+	{
+		FVoxelInvokerChunkTracker Tracker(FTransform::Identity, 32., 1 << 20);
+		TVoxelSet<FIntVector> Chunks;
+
+		const auto ApplyDelta = [&](const FVoxelInvokerChunkTracker::FDelta& Delta)
+		{
+			for (const FIntVector& Chunk : Delta.RemovedChunks)
+			{
+				Chunks.RemoveChecked(Chunk);
+			}
+			for (const FIntVector& Chunk : Delta.AddedChunks)
+			{
+				Chunks.Add_CheckNew(Chunk);
+			}
+		};
+
+		for (int32 Step = 0; Step < 10; Step++)
+		{
+			const TVoxelArray<FSphere> Invokers
+			{
+				FSphere(FVector(Step * 40., 0, 0), 300.),
+				FSphere(FVector(Step * 40., 0, 0), 100.),
+				FSphere(FVector(500., -Step * 70., 100.), 200.),
+			};
+
+			FVoxelInvokerChunkTracker::FDelta Delta;
+			check(Tracker.Update(Invokers, Delta));
+			ApplyDelta(Delta);
+
+			FVoxelInvokerChunkTracker FreshTracker(FTransform::Identity, 32., 1 << 20);
+			check(FreshTracker.Update(Invokers, Delta));
+			check(Chunks.OrderIndependentEqual(FreshTracker.GetChunks()));
+			check(Chunks.OrderIndependentEqual(Tracker.GetChunks()));
+		}
+
+		FVoxelInvokerChunkTracker::FDelta Delta;
+		FVoxelInvokerChunkTracker SmallTracker(FTransform::Identity, 32., 16);
+		check(!SmallTracker.Update(TVoxelArray<FSphere>{ FSphere(FVector::ZeroVector, 1000.) }, Delta));
+		check(SmallTracker.NumChunks() == 0);
+		check(Delta.IsEmpty());
+
+		Tracker.Reset(Delta);
+		ApplyDelta(Delta);
+		check(Chunks.Num() == 0);
+	}
+
+	{
+		const FIntPoint Size(33, 17);
+
+		TVoxelArray<float> Heights;
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				Heights.Add(FMath::Sin(X * 0.3f) * FMath::Cos(Y * 0.2f) * 4.f);
+			}
+		}
+
+		FVoxelHeightmapPyramid Pyramid;
+		Pyramid.Initialize(Size, Heights);
+
+		const FFloatInterval MinMax = FVoxelUtilities::GetMinMax(Heights);
+		const FFloatInterval Range = Pyramid.GetHeightRange(FVoxelBox2D(FVector2D::ZeroVector, FVector2D(Size)));
+		check(Range.Min == MinMax.Min);
+		check(Range.Max == MinMax.Max);
+
+		check(Pyramid.Classify(FVoxelBox(FVector(3, 3, 5), FVector(8, 8, 6))) == EVoxelHeightmapClassification::Above);
+		check(Pyramid.Classify(FVoxelBox(FVector(3, 3, -6), FVector(8, 8, -5))) == EVoxelHeightmapClassification::Below);
+		check(Pyramid.Classify(FVoxelBox(FVector(3, 3, -5), FVector(8, 8, 5))) == EVoxelHeightmapClassification::Intersecting);
+
+		double Time = 0;
+		check(Pyramid.RayIntersection(FVector(10.25, 5.5, 10), FVector(0, 0, -1), 100, Time));
+
+		const float CellMin = FMath::Min(
+			FMath::Min(Pyramid.GetHeight(10, 5), Pyramid.GetHeight(11, 5)),
+			FMath::Min(Pyramid.GetHeight(10, 6), Pyramid.GetHeight(11, 6)));
+		const float CellMax = FMath::Max(
+			FMath::Max(Pyramid.GetHeight(10, 5), Pyramid.GetHeight(11, 5)),
+			FMath::Max(Pyramid.GetHeight(10, 6), Pyramid.GetHeight(11, 6)));
+		check(CellMin - 1.e-3f <= 10 - Time && 10 - Time <= CellMax + 1.e-3f);
+
+		check(!Pyramid.RayIntersection(FVector(10, 5, 10), FVector(0, 0, 1), 100, Time));
+
+		// Outside of the footprint the surface is clamped to the edges, for rays & range queries alike
+		const float EdgeHeight = (Pyramid.GetHeight(0, 5) + Pyramid.GetHeight(0, 6)) / 2;
+		check(Pyramid.RayIntersection(FVector(-5, 5.5, 10), FVector(0, 0, -1), 100, Time));
+		check(FMath::IsNearlyEqual(10 - Time, double(EdgeHeight), 1.e-3));
+		check(Pyramid.Classify(FVoxelBox(FVector(-6, 5.5, EdgeHeight - 0.1f), FVector(-5, 5.5, EdgeHeight + 0.1f))) == EVoxelHeightmapClassification::Intersecting);
+
+		const float CornerHeight = Pyramid.GetHeight(Size.X - 1, Size.Y - 1);
+		check(Pyramid.RayIntersection(FVector(40, 30, -10), FVector(0, 0, 1), 100, Time));
+		check(FMath::IsNearlyEqual(Time - 10, double(CornerHeight), 1.e-3));
+		check(Pyramid.Classify(FVoxelBox(FVector(40, 30, CornerHeight + 1), FVector(41, 31, CornerHeight + 2))) == EVoxelHeightmapClassification::Above);
+		check(!Pyramid.RayIntersection(FVector(40, 30, CornerHeight + 1), FVector(1, 1, 0), 100, Time));
+	}
+
+	{
+		TVoxelSpatialHashGrid<int32> Grid(10.);
+
+		TVoxelArray<FVoxelBox> Bounds;
+		TVoxelArray<int32> Payloads;
+		for (int32 Index = 0; Index < 100; Index++)
+		{
+			const FVector Position = FVector(Index * 3.7, Index * -2.1, Index % 7);
+			Bounds.Add(FVoxelBox(Position, Position + Index % 25));
+			Payloads.Add(Index);
+		}
+
+		TVoxelArray<int32> Ids;
+		Grid.BulkAdd(Bounds, Payloads, Ids);
+
+		const auto CheckQuery = [&](const FVoxelBox& Query)
+		{
+			TVoxelSet<int32> Expected;
+			for (const int32 Id : Ids)
+			{
+				if (Grid.GetBounds(Id).Intersects(Query))
+				{
+					Expected.Add(Id);
+				}
+			}
+
+			TVoxelSet<int32> Found;
+			Grid.ForeachIntersecting(Query, [&](const int32 Id, const int32 Payload)
+			{
+				check(Grid.GetPayload(Id) == Payload);
+				Found.Add_CheckNew(Id);
+			});
+
+			check(Found.OrderIndependentEqual(Expected));
+		};
+
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(100, -100, 0), FVector(200, -50, 10)));
+
+		for (FVoxelBox& Box : Bounds)
+		{
+			Box = Box.ShiftBy(FVector(13, 0, -4));
+		}
+		Grid.BulkUpdate(Ids, Bounds);
+		Grid.Update(Ids[5], FVoxelBox(FVector(1000), FVector(1010)));
+		Grid.Remove(Ids[6]);
+		Ids.RemoveAt(6);
+
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(995), FVector(1000)));
+		check(Grid.Intersects(FVoxelBox(FVector(995), FVector(1000))));
+
+		// Elements and queries overlapping too many cells, up to coordinates that would overflow the cells
+		const int32 LargeId = Grid.Add(FVoxelBox(FVector(-1.e30), FVector(1.e30)), 1000);
+		Ids.Add(LargeId);
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(-1.e300), FVector(1.e300)));
+
+		CheckQuery(FVoxelBox(FVector(1.), FVector(4.)));
+
+		Grid.Update(LargeId, FVoxelBox(FVector(0.), FVector(5.)));
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(1.), FVector(4.)));
+
+		TVoxelArray<FVoxelBox> NewBounds;
+		for (const int32 Id : Ids)
+		{
+			NewBounds.Add(Grid.GetBounds(Id));
+		}
+		NewBounds[0] = FVoxelBox(FVector(-1000.), FVector(1000.));
+		NewBounds.Last() = FVoxelBox(FVector(2000.), FVector(2001.));
+		Grid.BulkUpdate(Ids, NewBounds);
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(1990.), FVector(2010.)));
+
+		Grid.Remove(Ids[0]);
+		Ids.RemoveAt(0);
+		CheckQuery(FVoxelBox(FVector(-50.), FVector(50.)));
+		CheckQuery(FVoxelBox(FVector(1.), FVector(4.)));
+	}
+
+	{
+		// Box shaped frustum
+		const FVector4f Planes[] =
+		{
+			FVector4f(1, 0, 0, 10.5f),
+			FVector4f(-1, 0, 0, 10.5f),
+			FVector4f(0, 1, 0, 10.5f),
+			FVector4f(0, -1, 0, 10.5f),
+			FVector4f(0, 0, 1, 10.5f),
+			FVector4f(0, 0, -1, 10.5f),
+		};
+		const FVoxelFrustum Frustum(Planes, FVector::ZeroVector);
+		const FVoxelBox FrustumBox(FVector(-10.5), FVector(10.5));
+
+		check(Frustum.Test(FVoxelBox(FVector(-1), FVector(1))) == EVoxelFrustumTest::Inside);
+		check(Frustum.Test(FVoxelBox(FVector(5), FVector(15))) == EVoxelFrustumTest::Intersecting);
+		check(Frustum.Test(FVoxelBox(FVector(11), FVector(15))) == EVoxelFrustumTest::Outside);
+		check(FVoxelFrustum(Planes, FVector::ZeroVector, 5.).Test(FVoxelBox(FVector(4), FVector(6))) == EVoxelFrustumTest::Outside);
+
+		TVoxelFastOctree<> Octree(8);
+		Octree.Update([](const TVoxelFastOctree<>::FNodeRef& NodeRef)
+		{
+			return NodeRef.GetBounds().DistanceToPoint(FVector(3, 0, 0)) < 2 * NodeRef.GetSize();
+		}, [](auto) {}, [](auto) {});
+
+		int32 NumBoundsNodes = 0;
+		Octree.TraverseBounds(FVoxelIntBox(FIntVector(-11), FIntVector(11)), [&](const TVoxelFastOctree<>::FNodeRef&)
+		{
+			NumBoundsNodes++;
+		});
+
+		int32 NumFrustumNodes = 0;
+		Octree.TraverseFrustum(Frustum, [&](const TVoxelFastOctree<>::FNodeRef&)
+		{
+			NumFrustumNodes++;
+		});
+		check(NumBoundsNodes == NumFrustumNodes);
+
+		FVoxelFastAABBTree::FElementArray Elements;
+		for (int32 Index = 0; Index < 200; Index++)
+		{
+			const FVector3f Position = FVector3f(Index % 13 - 6, Index % 7 - 3, Index % 11 - 5) * 3.f;
+			Elements.Add(
+				Index,
+				Position.X,
+				Position.Y,
+				Position.Z,
+				Position.X + 1.f,
+				Position.Y + 1.f,
+				Position.Z + 1.f);
+		}
+
+		TVoxelSet<int32> Expected;
+		for (int32 Index = 0; Index < Elements.Num(); Index++)
+		{
+			if (FVoxelBox(
+				FVector(FVoxelFastAABBTree::GetElementMin(Elements, Index)),
+				FVector(FVoxelFastAABBTree::GetElementMax(Elements, Index))).Intersects(FrustumBox))
+			{
+				Expected.Add(Elements.Get<FVoxelFastAABBTree::EElement::Payload>(Index));
+			}
+		}
+
+		FVoxelFastAABBTree Tree;
+		Tree.Initialize(MoveTemp(Elements));
+
+		TVoxelSet<int32> Found;
+		int32 NumVisited = 0;
+		const FVoxelFrustum Frustums[] = { Frustum, FVoxelFrustum() };
+		Tree.TraverseFrustums(Frustums, [&](const int32 Payload, const uint32 VisibleMask)
+		{
+			// Second frustum sees everything
+			check(VisibleMask & 0x2);
+			NumVisited++;
+
+			if (VisibleMask & 0x1)
+			{
+				Found.Add_CheckNew(Payload);
+			}
+		});
+		check(NumVisited == 200);
+		check(Found.OrderIndependentEqual(Expected));
+	}
+
+	{
+		TVoxelArray<int32> Values;
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			Values.Add(Index);
+		}
+
+		TVoxelArray<TVoxelAtomic<int32>> NumVisits;
+		NumVisits.SetNum(Values.Num());
+
+		ParallelFor(Values, 7, [&](const int32& Value, const int32 Index)
+		{
+			check(Value == Index);
+			NumVisits[Index].Add(1);
+		});
+
+		for (const TVoxelAtomic<int32>& NumVisit : NumVisits)
+		{
+			check(NumVisit.Get() == 1);
+		}
+
+		const int64 Sum = ParallelTransformReduce(
+			Values,
+			int64(0),
+			[](const int32 Value)
+			{
+				return int64(Value);
+			},
+			[](const int64 A, const int64 B)
+			{
+				return A + B;
+			});
+		check(Sum == int64(Values.Num()) * (Values.Num() - 1) / 2);
+
+		const int32 Max = ParallelReduce(
+			Values.Num(),
+			MIN_int32,
+			[&](const int32 StartIndex, const int32 EndIndex, int32& Accumulator)
+			{
+				for (int32 Index = StartIndex; Index < EndIndex; Index++)
+				{
+					Accumulator = FMath::Max(Accumulator, Values[Index]);
+				}
+			},
+			[](const int32 A, const int32 B)
+			{
+				return FMath::Max(A, B);
+			},
+			3);
+		check(Max == Values.Num() - 1);
+
+		check(ParallelReduce(0, 42, [](int32, int32, int32&) { check(false); }, [](int32 A, int32 B) { return A + B; }) == 42);
+	}
+
+	{
+		for (const EVoxelParallelForTileOrder Order : { EVoxelParallelForTileOrder::Linear, EVoxelParallelForTileOrder::Morton })
+		{
+			const FVoxelIntBox Bounds(FIntVector(-5, 3, 7), FIntVector(30, 20, 40));
+
+			TVoxelArray<TVoxelAtomic<int32>> NumVisits;
+			NumVisits.SetNum(Bounds.Count_int32());
+
+			ParallelFor(Bounds, FIntVector(8, 16, 4), [&](const FVoxelIntBox& Tile)
+			{
+				check(Bounds.Contains(Tile));
+
+				Tile.Iterate([&](const FIntVector& Position)
+				{
+					const FIntVector LocalPosition = Position - Bounds.Min;
+					NumVisits[FVoxelUtilities::Get3DIndex<int32>(Bounds.Size(), LocalPosition)].Add(1);
+				});
+			}, Order);
+
+			for (const TVoxelAtomic<int32>& NumVisit : NumVisits)
+			{
+				check(NumVisit.Get() == 1);
+			}
+		}
+
+		for (const EVoxelParallelForTileOrder Order : { EVoxelParallelForTileOrder::Linear, EVoxelParallelForTileOrder::Morton })
+		{
+			const FVoxelIntBox2D Bounds(FIntPoint(-7, 2), FIntPoint(50, 33));
+
+			TVoxelArray<TVoxelAtomic<int32>> NumVisits;
+			NumVisits.SetNum(Bounds.Count_int32());
+
+			ParallelFor(Bounds, 8, [&](const FVoxelIntBox2D& Tile)
+			{
+				check(Bounds.Contains(Tile));
+
+				Tile.Iterate([&](const FIntPoint& Position)
+				{
+					const FIntPoint LocalPosition = Position - Bounds.Min;
+					NumVisits[LocalPosition.X + LocalPosition.Y * Bounds.Size().X].Add(1);
+				});
+			}, Order);
+
+			for (const TVoxelAtomic<int32>& NumVisit : NumVisits)
+			{
+				check(NumVisit.Get() == 1);
+			}
+		}
+
+		for (int32 Value = 0; Value < 1000; Value += 7)
+		{
+			const FIntPoint Position(Value, 3 * Value + 1);
+			check(FVoxelUtilities::MortonDecode2D(FVoxelUtilities::MortonEncode2D(Position)) == Position);
+		}
+	}
+
+	{
+		const FRandomStream Stream(42);
+
+		for (const int32 Num : { 0, 1, 100, 5000 })
+		{
+			TVoxelArray<uint32> Keys32;
+			TVoxelArray<uint64> Keys64;
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				// Few distinct high bits so that passes get skipped and keys collide
+				Keys32.Add(Stream.GetUnsignedInt() & 0x00FF0FFF);
+				Keys64.Add((uint64(Stream.GetUnsignedInt()) << 32) | (Stream.GetUnsignedInt() & 0xFF));
+			}
+
+			{
+				TVoxelArray<uint32> Expected = Keys32;
+				Algo::Sort(Expected);
+
+				TVoxelArray<uint32> Sorted = Keys32;
+				FVoxelUtilities::RadixSort(Sorted);
+				check(Sorted == Expected);
+			}
+			{
+				TVoxelArray<uint64> Expected = Keys64;
+				Algo::Sort(Expected);
+
+				TVoxelArray<uint64> Sorted = Keys64;
+				FVoxelUtilities::RadixSort(Sorted);
+				check(Sorted == Expected);
+			}
+			{
+				TVoxelArray<uint32> Sorted = Keys32;
+				TVoxelArray<uint32> Payloads;
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					Payloads.Add(Index);
+				}
+
+				FVoxelUtilities::RadixSort(Sorted, Payloads);
+
+				for (int32 Index = 0; Index < Num; Index++)
+				{
+					check(Sorted[Index] == Keys32[Payloads[Index]]);
+
+					if (Index > 0)
+					{
+						check(Sorted[Index - 1] <= Sorted[Index]);
+						// Stable
+						check(Sorted[Index - 1] != Sorted[Index] || Payloads[Index - 1] < Payloads[Index]);
+					}
+				}
+			}
+		}
+	}
+
+	{
+		const FRandomStream Stream(1337);
+
+		for (const int32 Num : { 0, 1, 37, 5000 })
+		{
+			TVoxelArray<int32> Values;
+			TVoxelArray<bool> Mask;
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				Values.Add(Stream.RandRange(0, 4));
+				Mask.Add(Values.Last() == 0);
+			}
+
+			TVoxelArray<int32> Inclusive;
+			FVoxelUtilities::SetNumFast(Inclusive, Num);
+			TVoxelArray<int32> Exclusive = Values;
+
+			const int32 InclusiveSum = FVoxelUtilities::InclusiveScan(Values, Inclusive);
+			// In-place
+			const int32 ExclusiveSum = FVoxelUtilities::ExclusiveScan(Exclusive, Exclusive);
+
+			int32 Sum = 0;
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				check(Exclusive[Index] == Sum);
+				Sum += Values[Index];
+				check(Inclusive[Index] == Sum);
+			}
+			check(InclusiveSum == Sum);
+			check(ExclusiveSum == Sum);
+
+			TVoxelArray<int32> ExpectedTrue;
+			TVoxelArray<int32> ExpectedFalse;
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				(Mask[Index] ? ExpectedTrue : ExpectedFalse).Add(Index);
+			}
+
+			TVoxelArray<int32> Compacted;
+			FVoxelUtilities::CompactIndices(Mask, Compacted);
+			check(Compacted == ExpectedTrue);
+
+			TVoxelArray<int32> Partitioned;
+			FVoxelUtilities::SetNumFast(Partitioned, Num);
+			check(FVoxelUtilities::PartitionIndices(Mask, Partitioned) == ExpectedTrue.Num());
+			for (int32 Index = 0; Index < Num; Index++)
+			{
+				check(Partitioned[Index] == (Index < ExpectedTrue.Num()
+					? ExpectedTrue[Index]
+					: ExpectedFalse[Index - ExpectedTrue.Num()]));
+			}
+
+			const TVoxelArray<int32> NonZeroValues = FVoxelUtilities::CompactIf(MakeVoxelArrayView(Values), [](const int32 Value)
+			{
+				return Value != 0;
+			});
+			check(NonZeroValues.Num() == ExpectedFalse.Num());
+			for (int32 Index = 0; Index < NonZeroValues.Num(); Index++)
+			{
+				check(NonZeroValues[Index] == Values[ExpectedFalse[Index]]);
+			}
+		}
+	}
+
+	{
+		FVoxelHybridCriticalSection CriticalSection("VoxelCoreTests");
+		int64 Counter = 0;
+
+		// Smoke test, contention is measured in the benchmark
+		ParallelFor(4, [&](int32)
+		{
+			for (int32 Index = 0; Index < 100; Index++)
+			{
+				VOXEL_SCOPE_LOCK(CriticalSection);
+				Counter++;
+			}
+		});
+
+		check(Counter == 400);
+		check(CriticalSection.GetStats().NumAcquisitions == Counter);
+		check(CriticalSection.GetStats().NumContendedAcquisitions <= Counter);
+
+		check(CriticalSection.TryLock());
+		check(!CriticalSection.TryLock());
+		CriticalSection.Unlock();
+		check(!CriticalSection.IsLocked());
+	}
+
+	{
+		FVoxelShardedSharedCriticalSection CriticalSection;
+		int64 A = 0;
+		int64 B = 0;
+
+		TVoxelSeqLock<FInt64Vector2> SeqLock;
+
+		// Smoke test, contention is measured in the benchmark
+		constexpr int32 NumTasks = 4;
+		ParallelFor(NumTasks, [&](int32)
+		{
+			for (int32 Index = 0; Index < 100; Index++)
+			{
+				if (Index % 16 == 0)
+				{
+					VOXEL_SCOPE_WRITE_LOCK(CriticalSection);
+					check(CriticalSection.IsLocked_Write());
+					A++;
+					B++;
+
+					SeqLock.Update([](FInt64Vector2& Value)
+					{
+						Value.X++;
+						Value.Y++;
+					});
+				}
+				else
+				{
+					VOXEL_SCOPE_READ_LOCK(CriticalSection);
+					check(CriticalSection.IsLocked_Read());
+					check(A == B);
+
+					const FInt64Vector2 Value = SeqLock.Read();
+					check(Value.X == Value.Y);
+				}
+			}
+		});
+
+		check(A == NumTasks * FVoxelUtilities::DivideCeil_Positive(100, 16));
+		check(SeqLock.Read().X == A);
+		check(!CriticalSection.IsLocked_Read());
+
+		check(CriticalSection.TryReadLock());
+		check(!CriticalSection.TryWriteLock());
+		CriticalSection.ReadUnlock();
+		check(CriticalSection.TryWriteLock());
+		check(!CriticalSection.TryReadLock());
+		CriticalSection.WriteUnlock();
+	}
+
+	{
+		struct FValue
+		{
+			int32 A = 0;
+			int32 B = 0;
+
+			~FValue()
+			{
+				// Make use-after-free visible to readers
+				A = -1;
+			}
+		};
+
+		TVoxelAtomic<FValue*> Value = new FValue();
+
+		ParallelFor(2 * FPlatformMisc::NumberOfCoresIncludingHyperthreads(), [&](const int32 TaskIndex)
+		{
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				if (Index % 16 == 0)
+				{
+					FValue* NewValue = new FValue();
+					NewValue->A = TaskIndex * 1000 + Index;
+					NewValue->B = NewValue->A;
+
+					FVoxelEpoch::Retire(Value.Set_ReturnOld(NewValue));
+					FVoxelEpoch::ReclaimIfNeeded();
+				}
+				else
+				{
+					FVoxelEpochScope Scope;
+					check(FVoxelEpoch::IsInEpoch());
+
+					const FValue* CurrentValue = Value.Get();
+					check(CurrentValue->A == CurrentValue->B);
+				}
+			}
+		});
+
+		check(!FVoxelEpoch::IsInEpoch());
+		FVoxelEpoch::Reclaim();
+
+		delete Value.Get();
+	}
+
+	{
+		TVoxelSwissMap<int32, int32> SwissMap;
+		TVoxelMap<int32, int32> Map;
+		TVoxelSwissSet<int32> SwissSet;
+
+		FRandomStream Stream(1337);
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			// Small key range to stress removal of colliding elements
+			const int32 Key = Stream.RandRange(0, 1000);
+
+			if (Stream.FRand() < 0.4f)
+			{
+				const bool bRemoved = Map.Remove(Key);
+				check(SwissMap.Remove(Key) == bRemoved);
+				check(SwissSet.Remove(Key) == bRemoved);
+				continue;
+			}
+
+			SwissMap.FindOrAdd(Key) = Index;
+			Map.FindOrAdd(Key) = Index;
+			SwissSet.Add(Key);
+
+			check(SwissMap.Num() == Map.Num());
+		}
+
+		check(SwissMap.Num() == Map.Num());
+		check(SwissSet.Num() == Map.Num());
+		for (const auto& It : Map)
+		{
+			check(SwissMap[It.Key] == It.Value);
+		}
+
+		int32 Num = 0;
+		for (const auto& It : SwissMap)
+		{
+			check(Map[It.Key] == It.Value);
+			Num++;
+		}
+		check(Num == Map.Num());
+
+		const TVoxelSwissMap<int32, int32> Copy = SwissMap;
+		check(Copy.Num() == SwissMap.Num());
+		check(!Copy.Contains(-1));
+
+		SwissMap.Reset();
+		check(SwissMap.Num() == 0);
+		check(!SwissMap.Contains(0));
+	}
+
+	{
+		TVoxelConcurrentMap<int32, int32> Map;
+		TVoxelArray<FVoxelCounter32> NumConstructs;
+		NumConstructs.SetNum(1000);
+
+		ParallelFor(2 * FPlatformMisc::NumberOfCoresIncludingHyperthreads(), [&](const int32 TaskIndex)
+		{
+			for (int32 Index = 0; Index < 10000; Index++)
+			{
+				const int32 Key = (TaskIndex * 7 + Index) % 1000;
+
+				const int32 Value = Map.FindOrAdd(Key, [&]
+				{
+					NumConstructs[Key].Increment();
+					return 2 * Key;
+				});
+				check(Value == 2 * Key);
+			}
+		});
+
+		for (const FVoxelCounter32& Count : NumConstructs)
+		{
+			check(Count.Get() == 1);
+		}
+
+		check(Map.Num() == 1000);
+		check(Map.GetSnapshot().Num() == 1000);
+
+		int32 NumInShards = 0;
+		for (const FVoxelConcurrentMapShardStats& Stats : Map.GetShardStats())
+		{
+			NumInShards += Stats.Num;
+		}
+		check(NumInShards == 1000);
+
+		int32 NumVisited = 0;
+		Map.ForEach([&](const int32& Key, const int32& Value)
+		{
+			check(Value == 2 * Key);
+			NumVisited++;
+		});
+		check(NumVisited == 1000);
+
+		check(Map.Remove(0));
+		check(!Map.Contains(0));
+		check(!Map.Find(0).IsSet());
+		check(Map.Add(0, 5));
+		check(Map.FindRef(0) == 5);
+	}
+
+	{
+		constexpr int32 NumTasks = 64;
+		constexpr int32 NumPerTask = 500;
+
+		TVoxelConcurrentChunkedArray<int32> Array;
+
+		ParallelFor(NumTasks, [&](const int32 TaskIndex)
+		{
+			int32 NumAdded = 0;
+			while (NumAdded < NumPerTask)
+			{
+				// Mix single adds with ranges, some of them crossing chunk boundaries
+				const int32 Count = FMath::Min(
+					NumPerTask - NumAdded,
+					NumAdded % 3 == 0 ? 1 : 1 + (NumAdded * 7919) % 200);
+
+				const int32 StartIndex = Array.AddUninitialized(Count);
+
+				Array.ForeachView(StartIndex, Count, [&](const int32 ViewIndex, const TVoxelArrayView<int32> View)
+				{
+					for (int32 Index = 0; Index < View.Num(); Index++)
+					{
+						View[Index] = TaskIndex * NumPerTask + NumAdded + ViewIndex - StartIndex + Index;
+					}
+				});
+
+				NumAdded += Count;
+			}
+		});
+
+		check(Array.Num() == NumTasks * NumPerTask);
+
+		FVoxelBitArray Visited;
+		Visited.SetNum(Array.Num(), false);
+
+		Array.ForeachView([&](const int32 ViewIndex, const TConstVoxelArrayView<int32> View)
+		{
+			for (const int32 Value : View)
+			{
+				check(!Visited[Value]);
+				Visited[Value] = true;
+			}
+		});
+
+		const TVoxelChunkedArray<int32> ChunkedArray = Array.MoveToChunkedArray();
+		check(Array.Num() == 0);
+		check(ChunkedArray.Num() == NumTasks * NumPerTask);
+
+		int64 Sum = 0;
+		for (const int32 Value : ChunkedArray)
+		{
+			Sum += Value;
+		}
+		check(Sum == int64(ChunkedArray.Num()) * (ChunkedArray.Num() - 1) / 2);
+	}
+
+	{
+		FVoxelArena Arena;
+		{
+			FVoxelArenaScope Scope(Arena);
+			check(FVoxelArena::GetThreadArena() == &Arena);
+
+			TVoxelArenaArray<int32> Array;
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				Array.Add(Index);
+			}
+
+			// Last allocation, grown in place
+			check(Arena.GetUsedSize() == Array.Max() * sizeof(int32));
+
+			TVoxelArenaMap<int32, int32> Map;
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				Map.Add_CheckNew(Index, 2 * Index);
+			}
+
+			{
+				// Nested scope: Array still grows in Arena
+				FVoxelArenaScope NestedScope;
+				check(FVoxelArena::GetThreadArena() != &Arena);
+
+				TVoxelArenaArray<int32> NestedArray;
+				NestedArray.SetNum(1000);
+
+				Array.Add(-1);
+			}
+
+			check(FVoxelArena::GetThreadArena() == &Arena);
+
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				check(Array[Index] == Index);
+			}
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				check(Map.FindChecked(Index) == 2 * Index);
+			}
+		}
+		check(!FVoxelArena::GetThreadArena());
+
+		const int64 HighWaterMark = Arena.GetHighWaterMark();
+		check(HighWaterMark >= 1000 * sizeof(int32));
+		check(FVoxelArena::GetGlobalHighWaterMark() >= HighWaterMark);
+
+		Arena.Reset();
+		check(Arena.GetUsedSize() == 0);
+		check(Arena.GetHighWaterMark() == HighWaterMark);
+
+		// No arena: heap allocated
+		TVoxelArenaArray<int32> HeapArray;
+		HeapArray.Add(1);
+		check(Arena.GetUsedSize() == 0);
+	}
+
+	{
+		struct FPooledObject
+		{
+			TVoxelArray<int32> Data;
+			int32 NumResets = 0;
+
+			void Reset()
+			{
+				Data.Reset();
+				NumResets++;
+			}
+			int64 GetAllocatedSize() const
+			{
+				return Data.GetAllocatedSize();
+			}
+		};
+		using FPool = TVoxelObjectPool<FPooledObject>;
+
+		TUniquePtr<FPooledObject> Object = FPool::Allocate();
+		Object->Data.SetNum(100);
+
+		const FPooledObject* RawObject = Object.Get();
+		FPool::Return(MoveTemp(Object));
+
+		// Magazines are LIFO
+		TUniquePtr<FPooledObject> ReusedObject = FPool::Allocate();
+		check(ReusedObject.Get() == RawObject);
+		check(ReusedObject->NumResets == 1);
+		check(ReusedObject->Data.Num() == 0);
+		check(ReusedObject->Data.Max() >= 100);
+		check(FPool::GetNumNew() == 1);
+		check(FPool::GetNumReused() == 1);
+
+		// Too big to be pooled
+		ReusedObject->Data.SetNum(FPool::MaxMagazineSize / sizeof(int32));
+		FPool::Return(MoveTemp(ReusedObject));
+		check(FPool::GetNumTrimmed() == 1);
+
+		ParallelFor(64, [&](int32)
+		{
+			for (int32 Index = 0; Index < 1000; Index++)
+			{
+				TUniquePtr<FPooledObject> ObjectA = FPool::Allocate();
+				TUniquePtr<FPooledObject> ObjectB = FPool::Allocate();
+				ObjectA->Data.Add(Index);
+				ObjectB->Data.Add(Index);
+				FPool::Return(MoveTemp(ObjectA));
+				FPool::Return(MoveTemp(ObjectB));
+			}
+		});
+
+		check(FPool::GetNumNew() + FPool::GetNumReused() == 2 + 64 * 2000);
+		check(FPool::GetNumReused() > FPool::GetNumNew());
+
+		FPool::Trim();
+	}
+
+	{
+		TVoxelPersistentMap<int32, int32> PersistentMap;
+		TVoxelMap<int32, int32> Map;
+
+		TVoxelPersistentMap<int32, int32> Snapshot;
+		TVoxelMap<int32, int32> SnapshotMap;
+
+		FRandomStream Stream(1337);
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			if (Index == 50000)
+			{
+				Snapshot = PersistentMap;
+				SnapshotMap = Map;
+				check(Snapshot.IsSharedWith(PersistentMap));
+			}
+
+			const int32 Key = Stream.RandRange(0, 10000);
+
+			if (Stream.FRand() < 0.4f)
+			{
+				check(PersistentMap.Remove(Key) == Map.Remove(Key));
+				continue;
+			}
+
+			check(PersistentMap.Add(Key, Index) == !Map.Contains(Key));
+			Map.FindOrAdd(Key) = Index;
+		}
+
+		const auto CheckEqual = [](const TVoxelPersistentMap<int32, int32>& A, const TVoxelMap<int32, int32>& B)
+		{
+			check(A.Num() == B.Num());
+			for (const auto& It : B)
+			{
+				check(A.FindChecked(It.Key) == It.Value);
+			}
+
+			int32 Num = 0;
+			A.ForEach([&](const int32 Key, const int32 Value)
+			{
+				check(B[Key] == Value);
+				Num++;
+			});
+			check(Num == B.Num());
+		};
+
+		CheckEqual(PersistentMap, Map);
+		// The snapshot must not have seen any of the changes made after it
+		CheckEqual(Snapshot, SnapshotMap);
+
+		for (const auto& It : Map)
+		{
+			check(PersistentMap.Remove(It.Key));
+		}
+		check(PersistentMap.Num() == 0);
+		check(PersistentMap.GetAllocatedSize() == 0);
+
+		CheckEqual(Snapshot, SnapshotMap);
+	}
+
+	{
+		constexpr int32 Num = 100000;
+
+		FVoxelHierarchicalBitArray Array;
+		Array.SetNumZeroed(Num);
+
+		FVoxelBitArray Reference;
+		Reference.SetNumZeroed(Num);
+
+		FRandomStream Stream(1337);
+		for (int32 Iteration = 0; Iteration < 1000; Iteration++)
+		{
+			const bool bValue = Stream.FRand() < 0.4f;
+
+			if (Stream.FRand() < 0.5f)
+			{
+				const int32 Index = Stream.RandRange(0, Num - 1);
+				Array.Set(Index, bValue);
+				Reference[Index] = bValue;
+				continue;
+			}
+
+			const int32 Index = Stream.RandRange(0, Num - 1);
+			const int32 Count = Stream.RandRange(0, FMath::Min(Num - Index, 5000));
+			Array.SetRange(Index, Count, bValue);
+			Reference.SetRange(Index, Count, bValue);
+		}
+
+		check(Array.GetBits() == Reference);
+		check(Array.CountSetBits() == Reference.CountSetBits());
+		check(FVoxelHierarchicalBitArray(Reference).CountSetBits() == Reference.CountSetBits());
+
+		TVoxelArray<int32> SetBits;
+		Array.ForAllSetBits([&](const int32 Index)
+		{
+			SetBits.Add(Index);
+		});
+
+		TVoxelArray<int32> ReferenceSetBits;
+		Reference.ForAllSetBits([&](const int32 Index)
+		{
+			ReferenceSetBits.Add(Index);
+		});
+
+		check(SetBits == ReferenceSetBits);
+
+		for (int32 Iteration = 0; Iteration < 1000; Iteration++)
+		{
+			const int32 Index = Stream.RandRange(0, Num - 1);
+			const int32 Count = Stream.RandRange(0, FMath::Min(Num - Index, 5000));
+
+			check(Array.CountSetBits(Index) == Reference.CountSetBits(Index));
+			check(Array.TestRange(Index, Count) == Reference.TestRange(Index, Count));
+			check(Array.TestRangeAny(Index, Count) == (Reference.CountSetBits(Index + Count) - Reference.CountSetBits(Index) > 0));
+		}
+	}
+
+	{
+		constexpr int32 Num = 32 * 32 * 32;
+
+		TVoxelPaletteArray<uint16> Array(Num, 0);
+		TVoxelArray<uint16> Reference;
+		Reference.SetNumZeroed(Num);
+
+		check(Array.IsUniform());
+
+		FRandomStream Stream(1337);
+		for (int32 Iteration = 0; Iteration < 100000; Iteration++)
+		{
+			// Grow then shrink the palette a few times
+			const int32 NumValues = (Iteration / 10000) % 2 == 0 ? 100 : 3;
+
+			const int32 Index = Stream.RandRange(0, Num - 1);
+			const uint16 Value = uint16(Stream.RandRange(0, NumValues - 1));
+
+			Array.Set(Index, Value);
+			Reference[Index] = Value;
+		}
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			check(Array[Index] == Reference[Index]);
+		}
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Array.Set(Index, uint16(Index % 3));
+			Reference[Index] = uint16(Index % 3);
+		}
+
+		// 3 values don't fit in 1 bit, and the width only shrinks to 2 bits once 2 values are left
+		check(Array.GetPaletteNum() == 3);
+		check(Array.GetBitsPerIndex() == 3);
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			check(Array[Index] == Reference[Index]);
+		}
+
+		TVoxelArray<uint16> Values;
+		Values.SetNumZeroed(Num);
+		Array.GetAll(Values);
+		check(Values == Reference);
+
+		TVoxelPaletteArray<uint16> OtherArray;
+		OtherArray.SetAll(Reference);
+		check(OtherArray.GetPaletteNum() == Array.GetPaletteNum());
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			check(OtherArray[Index] == Reference[Index]);
+		}
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Array.Set(Index, 7);
+		}
+		check(Array.IsUniform());
+		check(Array.GetPaletteNum() == 1);
+		check(Array[0] == 7);
+	}
+
+	{
+		// Don't touch the project directory
+		const FString Path = FPaths::CreateTempFilename(FPlatformProcess::UserTempDir(), TEXT("VoxelMappedFileTest"), TEXT(".bin"));
+		ON_SCOPE_EXIT
+		{
+			IFileManager::Get().Delete(*Path, false, false, true);
+		};
+
+		TArray<int32> Values;
+		for (int32 Index = 0; Index < 100000; Index++)
+		{
+			Values.Add(Index * 7);
+		}
+
+		FVoxelWriter Writer;
+		Writer << Values;
+		const TVoxelArray64<uint8> Bytes = Writer.Move();
+		verify(FFileHelper::SaveArrayToFile(Bytes, *Path));
+
+		{
+			const TSharedPtr<FVoxelMappedFile> MappedFile = FVoxelMappedFile::Create(Path);
+			check(MappedFile);
+			check(MappedFile->Num() == Bytes.Num());
+			check(FVoxelUtilities::Equal(MappedFile->GetView(), Bytes));
+
+			MappedFile->Prefetch();
+			MappedFile->Prefetch(1000, 1000);
+			check(FVoxelUtilities::Equal(MappedFile->GetView(1000, 1000), Bytes.View().Slice(1000, 1000)));
+
+			TArray<int32> ReadValues;
+			FVoxelReader Reader(MappedFile->GetView());
+			Reader << ReadValues;
+			check(Reader.IsAtEndWithoutError());
+			check(ReadValues == Values);
+
+			const TConstVoxelArrayView64<uint8> MappedView = MappedFile->GetView();
+			const TVoxelArrayView64<uint8> MutableView = MappedFile->GetMutableView();
+			MutableView[0]++;
+			check(!MappedFile->IsMapped());
+			check(MappedFile->GetView()[0] == uint8(Bytes[0] + 1));
+			check(MappedView[0] == Bytes[0]);
+		}
+
+		{
+			// Writes through GetMutableView must not reach the file
+			const TSharedPtr<FVoxelMappedFile> MappedFile = FVoxelMappedFile::Create(Path);
+			check(MappedFile);
+			check(FVoxelUtilities::Equal(MappedFile->GetView(), Bytes));
+		}
+
+		verify(IFileManager::Get().Delete(*Path));
+		check(!FVoxelMappedFile::Create(Path));
+	}
+
+	{
+		TVoxelSoAArray<int32, float, uint8> Array;
+		TVoxelArray<int32> Reference;
+		for (int32 Index = 0; Index < 1000; Index++)
+		{
+			check(Array.Add(Index, Index * 0.5f, uint8(Index)) == Index);
+			Reference.Add(Index);
+		}
+
+		check(IsAligned(Array.GetColumn<0>().GetData(), PLATFORM_CACHE_LINE_SIZE));
+		check(IsAligned(Array.GetColumn<1>().GetData(), PLATFORM_CACHE_LINE_SIZE));
+		check(IsAligned(Array.GetColumn<2>().GetData(), PLATFORM_CACHE_LINE_SIZE));
+
+		const auto CheckArray = [&](const TVoxelSoAArray<int32, float, uint8>& ArrayToCheck)
+		{
+			check(ArrayToCheck.Num() == Reference.Num());
+
+			for (int32 Index = 0; Index < Reference.Num(); Index++)
+			{
+				const int32 Value = Reference[Index];
+				check(ArrayToCheck.Get<0>(Index) == Value);
+				check(ArrayToCheck.Get<1>(Index) == Value * 0.5f);
+				check(ArrayToCheck.Get<2>(Index) == uint8(Value));
+			}
+		};
+		CheckArray(Array);
+
+		FRandomStream Stream(1);
+		for (int32 Iteration = 0; Iteration < 500; Iteration++)
+		{
+			const int32 IndexA = Stream.RandRange(0, Array.Num() - 1);
+			const int32 IndexB = Stream.RandRange(0, Array.Num() - 1);
+			Array.Swap(IndexA, IndexB);
+			Swap(Reference[IndexA], Reference[IndexB]);
+		}
+		CheckArray(Array);
+
+		for (int32 Iteration = 0; Iteration < 300; Iteration++)
+		{
+			const int32 Index = Stream.RandRange(0, Array.Num() - 1);
+			Array.RemoveAtSwap(Index);
+			Reference.RemoveAtSwap(Index);
+		}
+		CheckArray(Array);
+
+		const TVoxelSoAArray<int32, float, uint8> Copy = Array;
+		CheckArray(Copy);
+
+		TVoxelArray<int32> Indices;
+		for (int32 Index = 0; Index < 100; Index++)
+		{
+			Indices.Add(Stream.RandRange(0, Array.Num() - 1));
+		}
+
+		const TVoxelSoAArray<int32, float, uint8> Gathered = Array.Gather(Indices);
+		check(Gathered.Num() == Indices.Num());
+		for (int32 Index = 0; Index < Indices.Num(); Index++)
+		{
+			check(Gathered.Get<0>(Index) == Reference[Indices[Index]]);
+			check(Gathered.Get<2>(Index) == uint8(Reference[Indices[Index]]));
+		}
+
+		const TVoxelSoAArrayView<int32, float, uint8> RightView = Array.View().RightOf(100);
+		check(RightView.Num() == Array.Num() - 100);
+		check(RightView.Get<0>(0) == Reference[100]);
+		check(RightView.GetColumn<1>()[5] == Reference[105] * 0.5f);
+
+		TVoxelSoAArray<int32, float, uint8> Zeroed;
+		Zeroed.SetNumZeroed(10);
+		check(Zeroed.GetColumn<1>()[9] == 0.f);
+		Zeroed.Empty();
+		check(Zeroed.GetAllocatedSize() == 0);
+
+		// Adding elements of the array itself while it grows
+		TVoxelSoAArray<int32, float, uint8> SelfAdd;
+		SelfAdd.Add(7, 1.f, 3);
+		for (int32 Index = 0; Index < 100; Index++)
+		{
+			SelfAdd.Add(SelfAdd.Get<0>(0), SelfAdd.Get<1>(Index), SelfAdd.Get<2>(0));
+		}
+		for (int32 Index = 0; Index < SelfAdd.Num(); Index++)
+		{
+			check(SelfAdd.Get<0>(Index) == 7);
+			check(SelfAdd.Get<1>(Index) == 1.f);
+			check(SelfAdd.Get<2>(Index) == 3);
+		}
+
+		TVoxelSoAArray<int32, float, uint8> Grown;
+		int32 NumReallocations = 0;
+		for (int32 Index = 0; Index < 10000; Index++)
+		{
+			const int32 OldMax = Grown.Max();
+			Grown.SetNum(Grown.Num() + 1);
+			NumReallocations += Grown.Max() != OldMax;
+		}
+		check(NumReallocations < 20);
+	}
+
+	{
+		FRandomStream Stream(1337);
+
+		FVoxelFastAABBTree::FElementArray Elements;
+		for (int32 Index = 0; Index < 1000; Index++)
+		{
+			const FVector3f Min = FVector3f(Stream.FRandRange(-100.f, 100.f), Stream.FRandRange(-100.f, 100.f), Stream.FRandRange(-100.f, 100.f));
+			const FVector3f Size = FVector3f(Stream.FRandRange(0.f, 5.f), Stream.FRandRange(0.f, 5.f), Stream.FRandRange(0.f, 5.f));
+
+			Elements.Add(Index, Min.X, Min.Y, Min.Z, Min.X + Size.X, Min.Y + Size.Y, Min.Z + Size.Z);
+		}
+
+		FVoxelFastAABBTree Tree;
+		Tree.Initialize(MoveTemp(Elements));
+
+		TVoxelArray<float> MinX;
+		TVoxelArray<float> MinY;
+		TVoxelArray<float> MinZ;
+		TVoxelArray<float> MaxX;
+		TVoxelArray<float> MaxY;
+		TVoxelArray<float> MaxZ;
+		for (int32 Index = 0; Index < 500; Index++)
+		{
+			// Every 4th query is outside of the tree and can't hit anything
+			const float Offset = Index % 4 == 0 ? 1000.f : 0.f;
+			const FVector3f Min = FVector3f(Stream.FRandRange(-110.f, 110.f), Stream.FRandRange(-110.f, 110.f), Stream.FRandRange(-110.f, 110.f) + Offset);
+			const FVector3f Size = FVector3f(Stream.FRandRange(0.f, 20.f), Stream.FRandRange(0.f, 20.f), Stream.FRandRange(0.f, 20.f));
+
+			MinX.Add(Min.X);
+			MinY.Add(Min.Y);
+			MinZ.Add(Min.Z);
+			MaxX.Add(Min.X + Size.X);
+			MaxY.Add(Min.Y + Size.Y);
+			MaxZ.Add(Min.Z + Size.Z);
+		}
+
+		const FVoxelFastAABBTree::FQueryArrayView Queries{ MinX, MinY, MinZ, MaxX, MaxY, MaxZ };
+
+		// Small chunks to go through the parallel path too
+		for (const int32 QueriesPerChunk : { 1024, 64 })
+		{
+			const TVoxelArray<FVoxelFastAABBTree::FQueryHit> Hits = Tree.BulkIntersects(Queries, QueriesPerChunk);
+			const FVoxelBitArray AnyHits = Tree.BulkIntersectsAny(Queries, QueriesPerChunk);
+			check(AnyHits.Num() == Queries.Num());
+
+			int32 HitIndex = 0;
+			int32 NumQueriesWithoutHits = 0;
+			for (int32 QueryIndex = 0; QueryIndex < Queries.Num(); QueryIndex++)
+			{
+				const FVector3f QueryMin(MinX[QueryIndex], MinY[QueryIndex], MinZ[QueryIndex]);
+				const FVector3f QueryMax(MaxX[QueryIndex], MaxY[QueryIndex], MaxZ[QueryIndex]);
+
+				TVoxelSet<int32> Expected;
+				Tree.Traverse(QueryMin, QueryMax, [&](const int32 Payload)
+				{
+					Expected.Add_CheckNew(Payload);
+				});
+
+				check(Tree.Intersects(QueryMin, QueryMax) == (Expected.Num() > 0));
+				check(AnyHits[QueryIndex] == (Expected.Num() > 0));
+
+				if (Expected.Num() == 0)
+				{
+					NumQueriesWithoutHits++;
+				}
+
+				TVoxelSet<int32> Found;
+				while (
+					HitIndex < Hits.Num() &&
+					Hits[HitIndex].QueryIndex == QueryIndex)
+				{
+					Found.Add_CheckNew(Hits[HitIndex].Payload);
+					HitIndex++;
+				}
+				check(Found.OrderIndependentEqual(Expected));
+			}
+			check(HitIndex == Hits.Num());
+			check(NumQueriesWithoutHits >= Queries.Num() / 4);
+		}
+
+		const FVoxelFastAABBTree::FQueryArrayView EmptyQueries;
+		check(Tree.BulkIntersects(EmptyQueries).Num() == 0);
+		check(Tree.BulkIntersectsAny(EmptyQueries).Num() == 0);
+
+		const FVoxelFastAABBTree EmptyTree;
+		check(EmptyTree.BulkIntersects(Queries).Num() == 0);
+		check(EmptyTree.BulkIntersectsAny(Queries).Num() == Queries.Num());
+		check(EmptyTree.BulkIntersectsAny(Queries).AllEqual(false));
+	}
 }
\ No newline at end of file
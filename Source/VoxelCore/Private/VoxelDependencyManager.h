@@ -16,8 +16,12 @@ public:
 	TVoxelChunkedSparseArray<FVoxelDependencyTracker> Trackers_RequiresLock;
 
 public:
-	mutable FVoxelCriticalSection SnapshotCriticalSection;
-	TVoxelSparseArray<FVoxelDependencySnapshot*> Snapshots_RequiresLock;
+	using FSnapshots = TVoxelArray<FVoxelDependencySnapshot*>;
+
+	// Only used by writers: snapshots are copy-on-write so that InvalidateTrackers can read them without locking
+	// Old arrays & removed snapshots are retired through FVoxelEpoch
+	FVoxelCriticalSection SnapshotCriticalSection;
+	TVoxelAtomic<FSnapshots*> Snapshots = new FSnapshots();
 
 public:
 	VOXEL_ALLOCATED_SIZE_TRACKER(STAT_VoxelDependencyTrackerMemory);
@@ -37,9 +41,9 @@ public:
 
 		{
 			VOXEL_SCOPE_COUNTER("Snapshots");
-			VOXEL_SCOPE_LOCK(SnapshotCriticalSection);
+			FVoxelEpochScope EpochScope;
 
-			for (FVoxelDependencySnapshot* Snapshot : Snapshots_RequiresLock)
+			for (FVoxelDependencySnapshot* Snapshot : *Snapshots.Get())
 			{
 				VOXEL_SCOPE_WRITE_LOCK(Snapshot->CriticalSection);
 
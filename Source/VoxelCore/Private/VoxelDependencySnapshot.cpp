@@ -9,20 +9,30 @@ TSharedRef<FVoxelDependencySnapshot> FVoxelDependencySnapshot::Create()
 {
 	FVoxelDependencySnapshot* Snapshot = new FVoxelDependencySnapshot();
 
-	int32 Index;
 	{
 		VOXEL_SCOPE_LOCK(GVoxelDependencyManager->SnapshotCriticalSection);
-		Index = GVoxelDependencyManager->Snapshots_RequiresLock.Add(Snapshot);
+
+		FVoxelDependencyManager::FSnapshots* NewSnapshots = new FVoxelDependencyManager::FSnapshots(*GVoxelDependencyManager->Snapshots.Get());
+		NewSnapshots->Add(Snapshot);
+
+		FVoxelEpoch::Retire(GVoxelDependencyManager->Snapshots.Set_ReturnOld(NewSnapshots));
 	}
 
 	return MakeShareable_CustomDestructor(Snapshot, [=]
 	{
 		{
 			VOXEL_SCOPE_LOCK(GVoxelDependencyManager->SnapshotCriticalSection);
-			verify(GVoxelDependencyManager->Snapshots_RequiresLock.RemoveAt_ReturnValue(Index) == Snapshot);
+
+			FVoxelDependencyManager::FSnapshots* NewSnapshots = new FVoxelDependencyManager::FSnapshots(*GVoxelDependencyManager->Snapshots.Get());
+			const int32 Index = NewSnapshots->Find(Snapshot);
+			check(Index != -1);
+			NewSnapshots->RemoveAtSwap(Index);
+
+			FVoxelEpoch::Retire(GVoxelDependencyManager->Snapshots.Set_ReturnOld(NewSnapshots));
 		}
 
-		delete Snapshot;
+		// InvalidateTrackers might still be iterating an old array
+		FVoxelEpoch::Retire(Snapshot);
 	});
 }
 
@@ -44,12 +44,12 @@ void FVoxelFastAABBTree::Initialize(FElementArray&& InElements)
 		void Compute()
 		{
 			ispc::VoxelFastAABBTree_Compute(
-				Elements.MinX.GetData(),
-				Elements.MinY.GetData(),
-				Elements.MinZ.GetData(),
-				Elements.MaxX.GetData(),
-				Elements.MaxY.GetData(),
-				Elements.MaxZ.GetData(),
+				Elements.GetColumn<EElement::MinX>().GetData(),
+				Elements.GetColumn<EElement::MinY>().GetData(),
+				Elements.GetColumn<EElement::MinZ>().GetData(),
+				Elements.GetColumn<EElement::MaxX>().GetData(),
+				Elements.GetColumn<EElement::MaxY>().GetData(),
+				Elements.GetColumn<EElement::MaxZ>().GetData(),
 				Elements.Num(),
 				MinX,
 				MinY,
@@ -66,18 +66,20 @@ void FVoxelFastAABBTree::Initialize(FElementArray&& InElements)
 		}
 	};
 
-	TVoxelChunkedArray<FNodeToProcess> NodesToProcess;
+	// Pooled to keep the chunks around between builds
+	using FNodesToProcessPool = TVoxelObjectPool<TVoxelChunkedArray<FNodeToProcess>>;
+
+	TUniquePtr<TVoxelChunkedArray<FNodeToProcess>> NodesToProcessPtr = FNodesToProcessPool::Allocate();
+	ON_SCOPE_EXIT
+	{
+		FNodesToProcessPool::Return(MoveTemp(NodesToProcessPtr));
+	};
+	TVoxelChunkedArray<FNodeToProcess>& NodesToProcess = *NodesToProcessPtr;
 
 	// Create root node
 	{
 		FNodeToProcess& RootNode = NodesToProcess.Emplace_GetRef();
-		RootNode.Elements.Payload = Elements.Payload;
-		RootNode.Elements.MinX = Elements.MinX;
-		RootNode.Elements.MinY = Elements.MinY;
-		RootNode.Elements.MinZ = Elements.MinZ;
-		RootNode.Elements.MaxX = Elements.MaxX;
-		RootNode.Elements.MaxY = Elements.MaxY;
-		RootNode.Elements.MaxZ = Elements.MaxZ;
+		RootNode.Elements = Elements.View();
 		RootNode.NodeLevel = 0;
 		RootNode.NodeIndex = Nodes.Emplace();
 		RootNode.Compute();
@@ -145,9 +147,9 @@ void FVoxelFastAABBTree::Initialize(FElementArray&& InElements)
 			switch (SplitAxis)
 			{
 			default: VOXEL_ASSUME(false);
-			case EVoxelAxis::X: return Parent.Elements.MinX;
-			case EVoxelAxis::Y: return Parent.Elements.MinY;
-			case EVoxelAxis::Z: return Parent.Elements.MinZ;
+			case EVoxelAxis::X: return Parent.Elements.GetColumn<EElement::MinX>();
+			case EVoxelAxis::Y: return Parent.Elements.GetColumn<EElement::MinY>();
+			case EVoxelAxis::Z: return Parent.Elements.GetColumn<EElement::MinZ>();
 			}
 		};
 
@@ -156,9 +158,9 @@ void FVoxelFastAABBTree::Initialize(FElementArray&& InElements)
 			switch (SplitAxis)
 			{
 			default: VOXEL_ASSUME(false);
-			case EVoxelAxis::X: return Parent.Elements.MaxX;
-			case EVoxelAxis::Y: return Parent.Elements.MaxY;
-			case EVoxelAxis::Z: return Parent.Elements.MaxZ;
+			case EVoxelAxis::X: return Parent.Elements.GetColumn<EElement::MaxX>();
+			case EVoxelAxis::Y: return Parent.Elements.GetColumn<EElement::MaxY>();
+			case EVoxelAxis::Z: return Parent.Elements.GetColumn<EElement::MaxZ>();
 			}
 		};
 
@@ -213,21 +215,8 @@ void FVoxelFastAABBTree::Initialize(FElementArray&& InElements)
 				}
 			}
 
-			Child0.Elements.Payload = Parent.Elements.Payload.LeftOf(Num0);
-			Child0.Elements.MinX = Parent.Elements.MinX.LeftOf(Num0);
-			Child0.Elements.MinY = Parent.Elements.MinY.LeftOf(Num0);
-			Child0.Elements.MinZ = Parent.Elements.MinZ.LeftOf(Num0);
-			Child0.Elements.MaxX = Parent.Elements.MaxX.LeftOf(Num0);
-			Child0.Elements.MaxY = Parent.Elements.MaxY.LeftOf(Num0);
-			Child0.Elements.MaxZ = Parent.Elements.MaxZ.LeftOf(Num0);
-
-			Child1.Elements.Payload = Parent.Elements.Payload.RightOf(Num0);
-			Child1.Elements.MinX = Parent.Elements.MinX.RightOf(Num0);
-			Child1.Elements.MinY = Parent.Elements.MinY.RightOf(Num0);
-			Child1.Elements.MinZ = Parent.Elements.MinZ.RightOf(Num0);
-			Child1.Elements.MaxX = Parent.Elements.MaxX.RightOf(Num0);
-			Child1.Elements.MaxY = Parent.Elements.MaxY.RightOf(Num0);
-			Child1.Elements.MaxZ = Parent.Elements.MaxZ.RightOf(Num0);
+			Child0.Elements = Parent.Elements.LeftOf(Num0);
+			Child1.Elements = Parent.Elements.RightOf(Num0);
 		}
 
 		// Failed to split
@@ -271,4 +260,272 @@ void FVoxelFastAABBTree::Shrink()
 
 	Nodes.Shrink();
 	Leaves.Shrink();
-}
\ No newline at end of file
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelArray<FVoxelFastAABBTree::FQueryHit> FVoxelFastAABBTree::BulkIntersects(
+	const FQueryArrayView& Queries,
+	const int32 QueriesPerChunk) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Queries.Num(), 128);
+
+	return BulkIntersectsImpl(Queries, QueriesPerChunk, false);
+}
+
+FVoxelBitArray FVoxelFastAABBTree::BulkIntersectsAny(
+	const FQueryArrayView& Queries,
+	const int32 QueriesPerChunk) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Queries.Num(), 128);
+
+	FVoxelBitArray Result;
+	Result.SetNum(Queries.Num(), false);
+
+	for (const FQueryHit& Hit : BulkIntersectsImpl(Queries, QueriesPerChunk, true))
+	{
+		Result[Hit.QueryIndex] = true;
+	}
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelFastAABBTree::BulkIntersectsChunk(
+	const FQueryArrayView& Queries,
+	const int32 StartIndex,
+	const int32 Num,
+	const bool bStopAtFirstHit,
+	TVoxelArray<FQueryHit>& OutHits) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 128);
+	checkVoxelSlow(Nodes.Num() > 0);
+
+	// Scratch buffers below don't outlive this call, allocate them from a thread arena
+	FVoxelArenaScope ArenaScope;
+
+	// Active query indices of all queued nodes are stored in a single stack-like buffer:
+	// since traversal is depth-first, the node we pop always owns the last range of the buffer
+	TVoxelArenaArray<int32> QueryIndices;
+	FVoxelUtilities::SetNumFast(QueryIndices, Num);
+
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		QueryIndices[Index] = StartIndex + Index;
+	}
+
+	struct FQueuedNode
+	{
+		int32 NodeIndex = -1;
+		int32 QueryIndicesStart = 0;
+		int32 QueryIndicesNum = 0;
+	};
+	TVoxelInlineArray<FQueuedNode, 64> QueuedNodes;
+	QueuedNodes.Add_EnsureNoGrow(FQueuedNode{ 0, 0, Num });
+
+	// Only used if bStopAtFirstHit
+	FVoxelBitArray IsHit;
+	if (bStopAtFirstHit)
+	{
+		IsHit.SetNum(Num, false);
+	}
+
+	const auto Filter = [&](
+		const int32 InStart,
+		const int32 InNum,
+		const FVector3f& BoundsMin,
+		const FVector3f& BoundsMax,
+		const int32 OutStart)
+	{
+		int32 OutNum = 0;
+		ispc::VoxelFastAABBTree_FilterQueries(
+			Queries.MinX.GetData(),
+			Queries.MinY.GetData(),
+			Queries.MinZ.GetData(),
+			Queries.MaxX.GetData(),
+			Queries.MaxY.GetData(),
+			Queries.MaxZ.GetData(),
+			QueryIndices.GetData() + InStart,
+			InNum,
+			BoundsMin.X,
+			BoundsMin.Y,
+			BoundsMin.Z,
+			BoundsMax.X,
+			BoundsMax.Y,
+			BoundsMax.Z,
+			QueryIndices.GetData() + OutStart,
+			OutNum);
+		return OutNum;
+	};
+
+	// Only used if bStopAtFirstHit: queries that hit don't need to go further down the tree
+	const auto RemoveHitQueries = [&](const int32 InStart, const int32 InNum)
+	{
+		int32 OutNum = 0;
+		for (int32 Index = InStart; Index < InStart + InNum; Index++)
+		{
+			const int32 QueryIndex = QueryIndices[Index];
+			if (!IsHit[QueryIndex - StartIndex])
+			{
+				QueryIndices[InStart + OutNum++] = QueryIndex;
+			}
+		}
+		return OutNum;
+	};
+
+	while (QueuedNodes.Num() > 0)
+	{
+		FQueuedNode QueuedNode = QueuedNodes.Pop();
+		checkVoxelSlow(QueuedNode.QueryIndicesNum > 0);
+
+		if (bStopAtFirstHit)
+		{
+			// Drop the queries that hit since this node was queued
+			QueuedNode.QueryIndicesNum = RemoveHitQueries(QueuedNode.QueryIndicesStart, QueuedNode.QueryIndicesNum);
+
+			if (QueuedNode.QueryIndicesNum == 0)
+			{
+				continue;
+			}
+		}
+
+		// Drop ranges of nodes we're done with
+		const int32 FreeStart = QueuedNode.QueryIndicesStart + QueuedNode.QueryIndicesNum;
+		checkVoxelSlow(FreeStart <= QueryIndices.Num());
+
+		const FNode& Node = Nodes[QueuedNode.NodeIndex];
+		if (Node.bLeaf)
+		{
+			const FLeaf& Leaf = Leaves[Node.LeafIndex];
+
+			FVoxelUtilities::SetNumFast(QueryIndices, FreeStart + QueuedNode.QueryIndicesNum);
+
+			for (int32 Index = 0; Index < Leaf.Elements.Num(); Index++)
+			{
+				const int32 NumHits = Filter(
+					QueuedNode.QueryIndicesStart,
+					QueuedNode.QueryIndicesNum,
+					GetElementMin(Leaf.Elements, Index),
+					GetElementMax(Leaf.Elements, Index),
+					FreeStart);
+
+				const int32 Payload = Leaf.Elements.Get<EElement::Payload>(Index);
+				for (int32 HitIndex = 0; HitIndex < NumHits; HitIndex++)
+				{
+					const int32 QueryIndex = QueryIndices[FreeStart + HitIndex];
+
+					if (bStopAtFirstHit)
+					{
+						checkVoxelSlow(!IsHit[QueryIndex - StartIndex]);
+						IsHit[QueryIndex - StartIndex] = true;
+					}
+
+					OutHits.Add(FQueryHit{ QueryIndex, Payload });
+				}
+
+				if (bStopAtFirstHit &&
+					NumHits > 0)
+				{
+					QueuedNode.QueryIndicesNum = RemoveHitQueries(QueuedNode.QueryIndicesStart, QueuedNode.QueryIndicesNum);
+
+					if (QueuedNode.QueryIndicesNum == 0)
+					{
+						break;
+					}
+				}
+			}
+
+			QueryIndices.SetNum(FreeStart, EAllowShrinking::No);
+			continue;
+		}
+
+		// Make sure the filter output won't reallocate
+		FVoxelUtilities::SetNumFast(QueryIndices, FreeStart + 2 * QueuedNode.QueryIndicesNum);
+
+		const int32 Num0 = Filter(
+			QueuedNode.QueryIndicesStart,
+			QueuedNode.QueryIndicesNum,
+			Node.ChildBounds0_Min,
+			Node.ChildBounds0_Max,
+			FreeStart);
+
+		const int32 Num1 = Filter(
+			QueuedNode.QueryIndicesStart,
+			QueuedNode.QueryIndicesNum,
+			Node.ChildBounds1_Min,
+			Node.ChildBounds1_Max,
+			FreeStart + Num0);
+
+		QueryIndices.SetNum(FreeStart + Num0 + Num1, EAllowShrinking::No);
+
+		// The range of the last queued node needs to be the last range of the buffer
+		if (Num0 > 0)
+		{
+			QueuedNodes.Add_EnsureNoGrow(FQueuedNode{ Node.ChildIndex0, FreeStart, Num0 });
+		}
+		if (Num1 > 0)
+		{
+			QueuedNodes.Add_EnsureNoGrow(FQueuedNode{ Node.ChildIndex1, FreeStart + Num0, Num1 });
+		}
+	}
+
+	Algo::Sort(OutHits, [](const FQueryHit& A, const FQueryHit& B)
+	{
+		return A.QueryIndex < B.QueryIndex;
+	});
+}
+
+TVoxelArray<FVoxelFastAABBTree::FQueryHit> FVoxelFastAABBTree::BulkIntersectsImpl(
+	const FQueryArrayView& Queries,
+	const int32 QueriesPerChunk,
+	const bool bStopAtFirstHit) const
+{
+	const int32 NumQueries = Queries.Num();
+	if (Nodes.Num() == 0 ||
+		NumQueries == 0)
+	{
+		return {};
+	}
+
+	const int32 ChunkSize = FMath::Max(QueriesPerChunk, 1);
+	const int32 NumChunks = FVoxelUtilities::DivideCeil_Positive(NumQueries, ChunkSize);
+	if (NumChunks == 1)
+	{
+		TVoxelArray<FQueryHit> Hits;
+		BulkIntersectsChunk(Queries, 0, NumQueries, bStopAtFirstHit, Hits);
+		return Hits;
+	}
+
+	TVoxelArray<TVoxelArray<FQueryHit>> ChunkHits;
+	ChunkHits.SetNum(NumChunks);
+
+	ParallelFor(NumChunks, [&](const int32 ChunkIndex)
+	{
+		const int32 StartIndex = ChunkIndex * ChunkSize;
+		const int32 EndIndex = FMath::Min(StartIndex + ChunkSize, NumQueries);
+
+		BulkIntersectsChunk(Queries, StartIndex, EndIndex - StartIndex, bStopAtFirstHit, ChunkHits[ChunkIndex]);
+	});
+
+	int32 NumHits = 0;
+	for (const TVoxelArray<FQueryHit>& Hits : ChunkHits)
+	{
+		NumHits += Hits.Num();
+	}
+
+	TVoxelArray<FQueryHit> Result;
+	Result.Reserve(NumHits);
+
+	// Chunks are in query order, no need to sort again
+	for (const TVoxelArray<FQueryHit>& Hits : ChunkHits)
+	{
+		Result.Append(Hits);
+	}
+
+	return Result;
+}
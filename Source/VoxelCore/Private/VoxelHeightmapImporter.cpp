@@ -43,6 +43,52 @@ bool FVoxelHeightmapImporter::Import(const FString& Path, FString& OutError, FIn
 	return true;
 }
 
+TVoxelArray<float> FVoxelHeightmapImporter::GetNormalizedHeights() const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	const int64 Num = int64(Size.X) * int64(Size.Y);
+
+	TVoxelArray<float> Heights;
+	if (!ensure(Num < MAX_int32))
+	{
+		return Heights;
+	}
+	FVoxelUtilities::SetNumFast(Heights, Num);
+
+	if (BitDepth == 8)
+	{
+		if (!ensure(Data.Num() == Num))
+		{
+			return {};
+		}
+
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Heights[Index] = Data[Index] / float(MAX_uint8);
+		}
+		return Heights;
+	}
+
+	if (BitDepth == 16)
+	{
+		if (!ensure(Data.Num() == Num * sizeof(uint16)))
+		{
+			return {};
+		}
+
+		const uint16* Data16 = reinterpret_cast<const uint16*>(Data.GetData());
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			Heights[Index] = Data16[Index] / float(MAX_uint16);
+		}
+		return Heights;
+	}
+
+	ensure(false);
+	return {};
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -51,12 +97,13 @@ bool FVoxelHeightmapImporter_PNG::Import()
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	TArray64<uint8> RawData;
-	if (!FFileHelper::LoadFileToArray(RawData, *Path))
+	const TSharedPtr<FVoxelMappedFile> MappedFile = FVoxelMappedFile::Create(Path, true);
+	if (!MappedFile)
 	{
 		Error = "Failed to load " + Path;
 		return false;
 	}
+	const TConstVoxelArrayView64<uint8> RawData = MappedFile->GetView();
 
 	IImageWrapperModule& ImageWrapperModule = FModuleManager::Get().LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
 
@@ -106,20 +153,20 @@ bool FVoxelHeightmapImporter_Raw::Import()
 {
 	VOXEL_FUNCTION_COUNTER();
 
-	TArray64<uint8> RawData;
-	if (!FFileHelper::LoadFileToArray(RawData, *Path))
+	// Raw files are already 16 bit pixels: load them straight into Data, mapping them would only add a copy
+	if (!FFileHelper::LoadFileToArray(Data, *Path))
 	{
 		Error = "Failed to load " + Path;
 		return false;
 	}
 
-	if (RawData.Num() % 2 != 0)
+	if (Data.Num() % 2 != 0)
 	{
 		Error = "Invalid file size " + Path + ": possibly not 16 bit?";
 		return false;
 	}
 
-	const int64 NumPixels = RawData.Num() / 2;
+	const int64 NumPixels = Data.Num() / 2;
 	const int32 SquareSize = FMath::TruncToInt(FMath::Sqrt(double(NumPixels)));
 	if (NumPixels != SquareSize * SquareSize)
 	{
@@ -130,7 +177,6 @@ bool FVoxelHeightmapImporter_Raw::Import()
 	Size.X = SquareSize;
 	Size.Y = SquareSize;
 	BitDepth = 16;
-	Data = RawData;
 
 	return true;
 }
\ No newline at end of file
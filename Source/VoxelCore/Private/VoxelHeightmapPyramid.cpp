@@ -0,0 +1,501 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelHeightmapPyramid.h"
+
+void FVoxelHeightmapPyramid::Initialize(
+	const FIntPoint& NewSize,
+	const TConstVoxelArrayView<float> NewHeights)
+{
+	VOXEL_SCOPE_COUNTER_FORMAT("FVoxelHeightmapPyramid::Initialize %dx%d", NewSize.X, NewSize.Y);
+
+	Size = FIntPoint::ZeroValue;
+	Heights.Empty();
+	Levels.Empty();
+
+	if (!ensure(NewSize.X >= 2) ||
+		!ensure(NewSize.Y >= 2) ||
+		!ensure(NewHeights.Num() == int64(NewSize.X) * int64(NewSize.Y)))
+	{
+		return;
+	}
+
+	Size = NewSize;
+	Heights = TVoxelArray<float>(NewHeights);
+
+	// Small levels aren't worth the ParallelFor overhead
+	const auto ForEachRow = [](const FIntPoint& LevelSize, const auto& Lambda)
+	{
+		if (LevelSize.X * LevelSize.Y < 4096)
+		{
+			for (int32 Y = 0; Y < LevelSize.Y; Y++)
+			{
+				Lambda(Y);
+			}
+			return;
+		}
+
+		ParallelFor(LevelSize.Y, [&](const int32 Y)
+		{
+			Lambda(Y);
+		});
+	};
+
+	{
+		VOXEL_SCOPE_COUNTER("Level 0");
+
+		FLevel& Level = Levels.Emplace_GetRef();
+		Level.Size = Size - FIntPoint(1, 1);
+		FVoxelUtilities::SetNumFast(Level.MinHeights, Level.Size.X * Level.Size.Y);
+		FVoxelUtilities::SetNumFast(Level.MaxHeights, Level.Size.X * Level.Size.Y);
+
+		ForEachRow(Level.Size, [&](const int32 Y)
+		{
+			for (int32 X = 0; X < Level.Size.X; X++)
+			{
+				const float Height00 = GetHeight(X + 0, Y + 0);
+				const float Height10 = GetHeight(X + 1, Y + 0);
+				const float Height01 = GetHeight(X + 0, Y + 1);
+				const float Height11 = GetHeight(X + 1, Y + 1);
+
+				const int32 Index = Level.GetIndex(X, Y);
+				Level.MinHeights[Index] = FMath::Min(FMath::Min(Height00, Height10), FMath::Min(Height01, Height11));
+				Level.MaxHeights[Index] = FMath::Max(FMath::Max(Height00, Height10), FMath::Max(Height01, Height11));
+			}
+		});
+	}
+
+	while (Levels.Last().Size != FIntPoint(1, 1))
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("Level %d", Levels.Num());
+
+		const FLevel& Child = Levels.Last();
+
+		FLevel Level;
+		Level.Size = FIntPoint(
+			FVoxelUtilities::DivideCeil_Positive(Child.Size.X, 2),
+			FVoxelUtilities::DivideCeil_Positive(Child.Size.Y, 2));
+		FVoxelUtilities::SetNumFast(Level.MinHeights, Level.Size.X * Level.Size.Y);
+		FVoxelUtilities::SetNumFast(Level.MaxHeights, Level.Size.X * Level.Size.Y);
+
+		ForEachRow(Level.Size, [&](const int32 Y)
+		{
+			for (int32 X = 0; X < Level.Size.X; X++)
+			{
+				float Min = MAX_flt;
+				float Max = -MAX_flt;
+
+				for (int32 ChildY = 2 * Y; ChildY < FMath::Min(2 * Y + 2, Child.Size.Y); ChildY++)
+				{
+					for (int32 ChildX = 2 * X; ChildX < FMath::Min(2 * X + 2, Child.Size.X); ChildX++)
+					{
+						const int32 ChildIndex = Child.GetIndex(ChildX, ChildY);
+						Min = FMath::Min(Min, Child.MinHeights[ChildIndex]);
+						Max = FMath::Max(Max, Child.MaxHeights[ChildIndex]);
+					}
+				}
+
+				const int32 Index = Level.GetIndex(X, Y);
+				Level.MinHeights[Index] = Min;
+				Level.MaxHeights[Index] = Max;
+			}
+		});
+
+		Levels.Add(MoveTemp(Level));
+	}
+}
+
+int64 FVoxelHeightmapPyramid::GetAllocatedSize() const
+{
+	int64 AllocatedSize = Heights.GetAllocatedSize() + Levels.GetAllocatedSize();
+	for (const FLevel& Level : Levels)
+	{
+		AllocatedSize += Level.MinHeights.GetAllocatedSize();
+		AllocatedSize += Level.MaxHeights.GetAllocatedSize();
+	}
+	return AllocatedSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FFloatInterval FVoxelHeightmapPyramid::GetHeightRange(const FVoxelBox2D& InBounds) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	FFloatInterval Result;
+	if (IsEmpty())
+	{
+		return Result;
+	}
+
+	// Clamp to the heightmap edges
+	const FVector2D CellsSize = FVector2D(Levels[0].Size);
+	const FVoxelBox2D Bounds(
+		FVoxelUtilities::Clamp(InBounds.Min, FVector2D::ZeroVector, CellsSize),
+		FVoxelUtilities::Clamp(InBounds.Max, FVector2D::ZeroVector, CellsSize));
+
+	struct FQueuedCell
+	{
+		int32 LevelIndex;
+		int32 X;
+		int32 Y;
+	};
+	TVoxelInlineArray<FQueuedCell, 64> QueuedCells;
+	QueuedCells.Add({ Levels.Num() - 1, 0, 0 });
+
+	while (QueuedCells.Num() > 0)
+	{
+		const FQueuedCell Cell = QueuedCells.Pop();
+		const FLevel& Level = Levels[Cell.LevelIndex];
+		const int32 Index = Level.GetIndex(Cell.X, Cell.Y);
+
+		if (Result.Min <= Level.MinHeights[Index] &&
+			Level.MaxHeights[Index] <= Result.Max)
+		{
+			// Won't change anything
+			continue;
+		}
+
+		const FVoxelBox2D CellBounds = GetCellBounds(Cell.LevelIndex, Cell.X, Cell.Y);
+		if (!CellBounds.Intersects(Bounds))
+		{
+			continue;
+		}
+
+		if (Cell.LevelIndex == 0 ||
+			Bounds.Contains(CellBounds))
+		{
+			Result.Include(Level.MinHeights[Index]);
+			Result.Include(Level.MaxHeights[Index]);
+			continue;
+		}
+
+		const FLevel& Child = Levels[Cell.LevelIndex - 1];
+		for (int32 ChildY = 2 * Cell.Y; ChildY < FMath::Min(2 * Cell.Y + 2, Child.Size.Y); ChildY++)
+		{
+			for (int32 ChildX = 2 * Cell.X; ChildX < FMath::Min(2 * Cell.X + 2, Child.Size.X); ChildX++)
+			{
+				QueuedCells.Add({ Cell.LevelIndex - 1, ChildX, ChildY });
+			}
+		}
+	}
+
+	return Result;
+}
+
+EVoxelHeightmapClassification FVoxelHeightmapPyramid::Classify(const FVoxelBox& Box) const
+{
+	const FFloatInterval Range = GetHeightRange(FVoxelBox2D(Box));
+	if (!ensureVoxelSlow(Range.IsValid()))
+	{
+		return EVoxelHeightmapClassification::Intersecting;
+	}
+
+	if (Box.Min.Z > Range.Max)
+	{
+		return EVoxelHeightmapClassification::Above;
+	}
+	if (Box.Max.Z < Range.Min)
+	{
+		return EVoxelHeightmapClassification::Below;
+	}
+	return EVoxelHeightmapClassification::Intersecting;
+}
+
+bool FVoxelHeightmapPyramid::RayIntersection(
+	const FVector& RayOrigin,
+	const FVector& RayDirection,
+	const double MaxTime,
+	double& OutTime) const
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	if (IsEmpty())
+	{
+		return false;
+	}
+
+	struct FQueuedCell
+	{
+		int32 LevelIndex;
+		int32 X;
+		int32 Y;
+		double Time;
+	};
+	TVoxelInlineArray<FQueuedCell, 64> QueuedCells;
+
+	const auto QueueCell = [&](const int32 LevelIndex, const int32 X, const int32 Y, const double BestTime)
+	{
+		const FLevel& Level = Levels[LevelIndex];
+		const int32 Index = Level.GetIndex(X, Y);
+
+		const FVoxelBox CellBounds = GetCellBounds(LevelIndex, X, Y).ToBox3D(
+			Level.MinHeights[Index],
+			Level.MaxHeights[Index]);
+
+		double TimeMin;
+		double TimeMax;
+		CellBounds.RayBoxIntersection(RayOrigin, RayDirection, TimeMin, TimeMax);
+
+		TimeMin = FMath::Max(TimeMin, 0.);
+		if (TimeMax < TimeMin ||
+			TimeMin > BestTime)
+		{
+			return;
+		}
+
+		QueuedCells.Add({ LevelIndex, X, Y, TimeMin });
+	};
+
+	double BestTime = MaxTime;
+	bool bHit = false;
+
+	QueueCell(Levels.Num() - 1, 0, 0, BestTime);
+
+	while (QueuedCells.Num() > 0)
+	{
+		const FQueuedCell Cell = QueuedCells.Pop();
+		if (Cell.Time > BestTime)
+		{
+			continue;
+		}
+
+		if (Cell.LevelIndex == 0)
+		{
+			const FVector Vertex00(Cell.X + 0, Cell.Y + 0, GetHeight(Cell.X + 0, Cell.Y + 0));
+			const FVector Vertex10(Cell.X + 1, Cell.Y + 0, GetHeight(Cell.X + 1, Cell.Y + 0));
+			const FVector Vertex01(Cell.X + 0, Cell.Y + 1, GetHeight(Cell.X + 0, Cell.Y + 1));
+			const FVector Vertex11(Cell.X + 1, Cell.Y + 1, GetHeight(Cell.X + 1, Cell.Y + 1));
+
+			for (int32 Triangle = 0; Triangle < 2; Triangle++)
+			{
+				double Time;
+				if (!FVoxelUtilities::RayTriangleIntersection(
+					RayOrigin,
+					RayDirection,
+					Vertex00,
+					Triangle == 0 ? Vertex10 : Vertex11,
+					Triangle == 0 ? Vertex11 : Vertex01,
+					false,
+					Time))
+				{
+					continue;
+				}
+
+				if (Time <= BestTime)
+				{
+					BestTime = Time;
+					bHit = true;
+				}
+			}
+			continue;
+		}
+
+		const FLevel& Child = Levels[Cell.LevelIndex - 1];
+		const int32 NumQueued = QueuedCells.Num();
+
+		for (int32 ChildY = 2 * Cell.Y; ChildY < FMath::Min(2 * Cell.Y + 2, Child.Size.Y); ChildY++)
+		{
+			for (int32 ChildX = 2 * Cell.X; ChildX < FMath::Min(2 * Cell.X + 2, Child.Size.X); ChildX++)
+			{
+				QueueCell(Cell.LevelIndex - 1, ChildX, ChildY, BestTime);
+			}
+		}
+
+		// Pop the closest child first
+		Algo::Sort(MakeVoxelArrayView(QueuedCells).RightOf(NumQueued), [](const FQueuedCell& A, const FQueuedCell& B)
+		{
+			return A.Time > B.Time;
+		});
+	}
+
+	// Outside of the footprint the surface is clamped to the edges, check the parts of the ray before & after the footprint
+	// Only the parts where the ray is within the height range of the heightmap can hit
+	double StartTime = 0.;
+	double EndTime = BestTime;
+	{
+		const FLevel& RootLevel = Levels.Last();
+
+		double TimeMin;
+		double TimeMax;
+		FVoxelBox(
+			FVector(-MAX_dbl, -MAX_dbl, RootLevel.MinHeights[0]),
+			FVector(MAX_dbl, MAX_dbl, RootLevel.MaxHeights[0])).RayBoxIntersection(RayOrigin, RayDirection, TimeMin, TimeMax);
+
+		StartTime = FMath::Max(StartTime, TimeMin);
+		EndTime = FMath::Min(EndTime, TimeMax);
+	}
+
+	if (StartTime <= EndTime)
+	{
+		const FVector2D CellsSize = FVector2D(Levels[0].Size);
+
+		double FootprintTimeMin;
+		double FootprintTimeMax;
+		FVoxelBox(
+			FVector(0., 0., -MAX_dbl),
+			FVector(CellsSize.X, CellsSize.Y, MAX_dbl)).RayBoxIntersection(RayOrigin, RayDirection, FootprintTimeMin, FootprintTimeMax);
+
+		double Time;
+		if (FootprintTimeMin > FootprintTimeMax)
+		{
+			if (RayIntersectionOutside(RayOrigin, RayDirection, StartTime, EndTime, Time))
+			{
+				BestTime = Time;
+				bHit = true;
+			}
+		}
+		else if (RayIntersectionOutside(RayOrigin, RayDirection, StartTime, FMath::Min(EndTime, FootprintTimeMin), Time))
+		{
+			// Before any hit inside the footprint
+			BestTime = Time;
+			bHit = true;
+		}
+		else if (RayIntersectionOutside(RayOrigin, RayDirection, FMath::Max(StartTime, FootprintTimeMax), EndTime, Time))
+		{
+			// EndTime is BestTime if we hit inside the footprint
+			BestTime = Time;
+			bHit = true;
+		}
+	}
+
+	if (!bHit)
+	{
+		return false;
+	}
+
+	OutTime = BestTime;
+	return true;
+}
+
+double FVoxelHeightmapPyramid::GetEdgeHeight(const FVector2D& Position) const
+{
+	const FVector2D CellsSize = FVector2D(Levels[0].Size);
+	const FVector2D Clamped = FVoxelUtilities::Clamp(Position, FVector2D::ZeroVector, CellsSize);
+
+	// Negative if outside of the footprint
+	const double DistanceToEdgeX = FMath::Min(Position.X, CellsSize.X - Position.X);
+	const double DistanceToEdgeY = FMath::Min(Position.Y, CellsSize.Y - Position.Y);
+
+	// The surface is linear between two samples along an edge
+	if (DistanceToEdgeX <= DistanceToEdgeY)
+	{
+		const int32 X = Position.X < CellsSize.X / 2 ? 0 : Size.X - 1;
+		const int32 Y = FMath::Min(FMath::FloorToInt(Clamped.Y), Size.Y - 2);
+		return FMath::Lerp<double>(GetHeight(X, Y), GetHeight(X, Y + 1), Clamped.Y - Y);
+	}
+	else
+	{
+		const int32 X = FMath::Min(FMath::FloorToInt(Clamped.X), Size.X - 2);
+		const int32 Y = Position.Y < CellsSize.Y / 2 ? 0 : Size.Y - 1;
+		return FMath::Lerp<double>(GetHeight(X, Y), GetHeight(X + 1, Y), Clamped.X - X);
+	}
+}
+
+bool FVoxelHeightmapPyramid::RayIntersectionOutside(
+	const FVector& RayOrigin,
+	const FVector& RayDirection,
+	const double StartTime,
+	const double EndTime,
+	double& OutTime) const
+{
+	if (StartTime > EndTime)
+	{
+		return false;
+	}
+
+	// The clamped position moves linearly between two crossings of a sample row/column,
+	// so the surface height along the ray is linear between two crossings too
+	struct FAxis
+	{
+		double Origin = 0.;
+		double Direction = 0.;
+		int32 Max = 0;
+		// Next sample coordinate crossed
+		int32 Next = 0;
+
+		FAxis(
+			const double InOrigin,
+			const double InDirection,
+			const int32 InMax,
+			const double StartTime)
+			: Origin(InOrigin)
+			, Direction(InDirection)
+			, Max(InMax)
+		{
+			// Clamp to avoid overflows, crossings outside of the footprint don't matter
+			const double Start = FMath::Clamp(Origin + StartTime * Direction, -1., Max + 1.);
+			Next = Direction > 0 ? FMath::FloorToInt(Start) + 1 : FMath::CeilToInt(Start) - 1;
+		}
+
+		double GetNextTime() const
+		{
+			if (Direction == 0 ||
+				Next < 0 ||
+				Next > Max)
+			{
+				return MAX_dbl;
+			}
+			return (Next - Origin) / Direction;
+		}
+		void Advance()
+		{
+			Next += Direction > 0 ? 1 : -1;
+		}
+	};
+
+	FAxis AxisX(RayOrigin.X, RayDirection.X, Size.X - 1, StartTime);
+	FAxis AxisY(RayOrigin.Y, RayDirection.Y, Size.Y - 1, StartTime);
+
+	// Height of the ray above the surface
+	const auto GetDelta = [&](const double Time)
+	{
+		const FVector Position = RayOrigin + Time * RayDirection;
+		return Position.Z - GetEdgeHeight(FVector2D(Position));
+	};
+
+	double Time = StartTime;
+	double Delta = GetDelta(Time);
+
+	while (true)
+	{
+		if (Delta == 0)
+		{
+			OutTime = Time;
+			return true;
+		}
+		if (Time >= EndTime)
+		{
+			return false;
+		}
+
+		const double TimeX = AxisX.GetNextTime();
+		const double TimeY = AxisY.GetNextTime();
+		const double NextTime = FMath::Min3(TimeX, TimeY, EndTime);
+
+		if (TimeX <= NextTime)
+		{
+			AxisX.Advance();
+		}
+		if (TimeY <= NextTime)
+		{
+			AxisY.Advance();
+		}
+		if (NextTime <= Time)
+		{
+			// Crossing behind us because of precision issues
+			continue;
+		}
+
+		const double NextDelta = GetDelta(NextTime);
+		if (FMath::Sign(Delta) != FMath::Sign(NextDelta))
+		{
+			OutTime = Time + (NextTime - Time) * Delta / (Delta - NextDelta);
+			return true;
+		}
+
+		Time = NextTime;
+		Delta = NextDelta;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,475 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelInvokerChunkTracker.h"
+
+// Offset due to chunk position being the chunk lower corner
+constexpr double GVoxelInvokerChunkOffset = 0.5;
+// Same as ComputeInvokerChunks: we check the chunk center against the invoker radius offset by the chunk half diagonal
+constexpr double GVoxelInvokerChunkHalfDiagonal = UE_SQRT_3 / 2.;
+
+bool FVoxelInvokerChunkTracker::FChunkedInvoker::GetColumn(
+	const int32 X,
+	const int32 Y,
+	int32& OutMinZ,
+	int32& OutMaxZ) const
+{
+	const FIntVector Min = GetMin();
+	const FIntVector Max = GetMax();
+
+	if (X < Min.X || X > Max.X ||
+		Y < Min.Y || Y > Max.Y)
+	{
+		return false;
+	}
+
+	const double RemainingSquared =
+		FMath::Square(RadiusInChunks + GVoxelInvokerChunkHalfDiagonal) -
+		FMath::Square(X + GVoxelInvokerChunkOffset - Center.X) -
+		FMath::Square(Y + GVoxelInvokerChunkOffset - Center.Y);
+
+	if (RemainingSquared < 0)
+	{
+		return false;
+	}
+
+	const double HalfHeight = FMath::Sqrt(RemainingSquared);
+
+	OutMinZ = FMath::Max(Min.Z, FMath::CeilToInt32(Center.Z - GVoxelInvokerChunkOffset - HalfHeight));
+	OutMaxZ = FMath::Min(Max.Z, FMath::FloorToInt32(Center.Z - GVoxelInvokerChunkOffset + HalfHeight));
+
+	return OutMinZ <= OutMaxZ;
+}
+
+FIntVector FVoxelInvokerChunkTracker::FChunkedInvoker::GetMin() const
+{
+	return FVoxelUtilities::FloorToInt(Center - RadiusInChunks - GVoxelInvokerChunkOffset);
+}
+
+FIntVector FVoxelInvokerChunkTracker::FChunkedInvoker::GetMax() const
+{
+	return FVoxelUtilities::CeilToInt(Center + RadiusInChunks - GVoxelInvokerChunkOffset);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelInvokerChunkTracker::FVoxelInvokerChunkTracker(
+	const FTransform& LocalToWorld,
+	const double ChunkSize,
+	const int32 MaxNumChunks)
+	: LocalToWorld(LocalToWorld)
+	, ChunkSize(ChunkSize)
+	, MaxNumChunks(MaxNumChunks)
+{
+	ensure(ChunkSize > 0);
+}
+
+bool FVoxelInvokerChunkTracker::Update(
+	const TConstVoxelArrayView<FSphere> Invokers,
+	FDelta& OutDelta)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Invokers.Num(), 1);
+
+	OutDelta.AddedChunks.Reset();
+	OutDelta.RemovedChunks.Reset();
+
+	TVoxelArray<FChunkedInvoker> NewInvokers = MakeChunkedInvokers(Invokers);
+
+	// Pair every new invoker with an old one so that we only need to rasterize the shell between the two
+	// Pairing only affects performance, not correctness: any pairing removes all the old invokers and adds all the new ones
+	struct FPair
+	{
+		const FChunkedInvoker* OldInvoker = nullptr;
+		const FChunkedInvoker* NewInvoker = nullptr;
+	};
+	TVoxelArray<FPair> Pairs;
+	{
+		VOXEL_SCOPE_COUNTER("Pair invokers");
+
+		FVoxelBitArray IsOldUsed;
+		IsOldUsed.SetNum(ChunkedInvokers.Num(), false);
+
+		TVoxelArray<const FChunkedInvoker*> UnpairedNewInvokers;
+
+		for (const FChunkedInvoker& NewInvoker : NewInvokers)
+		{
+			const int32 OldIndex = ChunkedInvokers.IndexOfByPredicate([&](const FChunkedInvoker& OldInvoker)
+			{
+				return OldInvoker == NewInvoker;
+			});
+
+			if (OldIndex != -1 &&
+				!IsOldUsed[OldIndex])
+			{
+				// Didn't move, nothing to do
+				IsOldUsed[OldIndex] = true;
+				continue;
+			}
+
+			UnpairedNewInvokers.Add(&NewInvoker);
+		}
+
+		for (const FChunkedInvoker* NewInvoker : UnpairedNewInvokers)
+		{
+			int32 BestOldIndex = -1;
+			double BestDistanceSquared = MAX_dbl;
+
+			for (int32 OldIndex = 0; OldIndex < ChunkedInvokers.Num(); OldIndex++)
+			{
+				if (IsOldUsed[OldIndex])
+				{
+					continue;
+				}
+
+				const double DistanceSquared = FVector::DistSquared(ChunkedInvokers[OldIndex].Center, NewInvoker->Center);
+				if (DistanceSquared < BestDistanceSquared)
+				{
+					BestOldIndex = OldIndex;
+					BestDistanceSquared = DistanceSquared;
+				}
+			}
+
+			FPair& Pair = Pairs.Emplace_GetRef();
+			Pair.NewInvoker = NewInvoker;
+
+			if (BestOldIndex != -1)
+			{
+				IsOldUsed[BestOldIndex] = true;
+				Pair.OldInvoker = &ChunkedInvokers[BestOldIndex];
+			}
+		}
+
+		for (int32 OldIndex = 0; OldIndex < ChunkedInvokers.Num(); OldIndex++)
+		{
+			if (IsOldUsed[OldIndex])
+			{
+				continue;
+			}
+
+			FPair& Pair = Pairs.Emplace_GetRef();
+			Pair.OldInvoker = &ChunkedInvokers[OldIndex];
+		}
+	}
+
+	TVoxelArray<FIntVector> AddedCells;
+	TVoxelArray<FIntVector> RemovedCells;
+	for (const FPair& Pair : Pairs)
+	{
+		RasterizeShell(
+			Pair.OldInvoker,
+			Pair.NewInvoker,
+			AddedCells,
+			RemovedCells);
+	}
+
+	// Apply all the additions before the removals: this way a chunk covered by both an old and a new invoker never reaches 0
+	{
+		VOXEL_SCOPE_COUNTER_NUM("Add", AddedCells.Num(), 1);
+
+		ChunkToRefCount.ReserveGrow(AddedCells.Num());
+
+		for (const FIntVector& Cell : AddedCells)
+		{
+			int32& RefCount = ChunkToRefCount.FindOrAdd(Cell);
+			if (RefCount++ == 0)
+			{
+				OutDelta.AddedChunks.Add(Cell);
+			}
+		}
+	}
+
+	{
+		VOXEL_SCOPE_COUNTER_NUM("Remove", RemovedCells.Num(), 1);
+
+		for (const FIntVector& Cell : RemovedCells)
+		{
+			int32& RefCount = ChunkToRefCount.FindChecked(Cell);
+			checkVoxelSlow(RefCount > 0);
+
+			if (--RefCount == 0)
+			{
+				ChunkToRefCount.RemoveChecked(Cell);
+				OutDelta.RemovedChunks.Add(Cell);
+			}
+		}
+	}
+
+	if (ChunkToRefCount.Num() > MaxNumChunks)
+	{
+		VOXEL_SCOPE_COUNTER("Revert");
+
+		for (const FIntVector& Cell : RemovedCells)
+		{
+			ChunkToRefCount.FindOrAdd(Cell)++;
+		}
+
+		for (const FIntVector& Cell : AddedCells)
+		{
+			int32& RefCount = ChunkToRefCount.FindChecked(Cell);
+			if (--RefCount == 0)
+			{
+				ChunkToRefCount.RemoveChecked(Cell);
+			}
+		}
+
+		OutDelta.AddedChunks.Reset();
+		OutDelta.RemovedChunks.Reset();
+		return false;
+	}
+
+	ChunkedInvokers = MoveTemp(NewInvokers);
+	return true;
+}
+
+void FVoxelInvokerChunkTracker::Reset(FDelta& OutDelta)
+{
+	VOXEL_FUNCTION_COUNTER();
+
+	OutDelta.AddedChunks.Reset();
+	OutDelta.RemovedChunks = ChunkToRefCount.KeyArray();
+
+	ChunkedInvokers.Empty();
+	ChunkToRefCount.Empty();
+}
+
+TVoxelSet<FIntVector> FVoxelInvokerChunkTracker::GetChunks() const
+{
+	VOXEL_FUNCTION_COUNTER();
+	return ChunkToRefCount.KeySet();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelInvokerChunkTracker::RemoveContainedInvokers(TVoxelArray<FChunkedInvoker>& Invokers)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Invokers.Num(), 1);
+
+	if (Invokers.Num() <= 1)
+	{
+		return;
+	}
+
+	Invokers.Sort([](const FChunkedInvoker& A, const FChunkedInvoker& B)
+	{
+		return A.Center.X < B.Center.X;
+	});
+
+	double MaxRadius = 0;
+	for (const FChunkedInvoker& Invoker : Invokers)
+	{
+		MaxRadius = FMath::Max(MaxRadius, Invoker.RadiusInChunks);
+	}
+
+	FVoxelBitArray IsContained;
+	IsContained.SetNum(Invokers.Num(), false);
+
+	for (int32 IndexA = 0; IndexA < Invokers.Num(); IndexA++)
+	{
+		const FChunkedInvoker& InvokerA = Invokers[IndexA];
+
+		// B can only contain A if |B.X - A.X| <= B.Radius - A.Radius <= MaxRadius - A.Radius
+		const double MaxDistance = MaxRadius - InvokerA.RadiusInChunks;
+
+		const auto CheckInvoker = [&](const int32 IndexB)
+		{
+			if (IsContained[IndexB])
+			{
+				// If B is contained in C, C will also contain A
+				return false;
+			}
+
+			const FChunkedInvoker& InvokerB = Invokers[IndexB];
+
+			const double RadiusDelta = InvokerB.RadiusInChunks - InvokerA.RadiusInChunks;
+			if (RadiusDelta < 0)
+			{
+				return false;
+			}
+
+			// Make sure to only remove one of two identical invokers
+			if (RadiusDelta == 0 &&
+				IndexB > IndexA)
+			{
+				return false;
+			}
+
+			return FVector::DistSquared(InvokerA.Center, InvokerB.Center) <= FMath::Square(RadiusDelta);
+		};
+
+		bool bContained = false;
+		for (int32 IndexB = IndexA - 1; !bContained && IndexB >= 0 && InvokerA.Center.X - Invokers[IndexB].Center.X <= MaxDistance; IndexB--)
+		{
+			bContained = CheckInvoker(IndexB);
+		}
+		for (int32 IndexB = IndexA + 1; !bContained && IndexB < Invokers.Num() && Invokers[IndexB].Center.X - InvokerA.Center.X <= MaxDistance; IndexB++)
+		{
+			bContained = CheckInvoker(IndexB);
+		}
+
+		IsContained[IndexA] = bContained;
+	}
+
+	TVoxelArray<FChunkedInvoker> Result;
+	Result.Reserve(Invokers.Num());
+
+	for (int32 Index = 0; Index < Invokers.Num(); Index++)
+	{
+		if (!IsContained[Index])
+		{
+			Result.Add(Invokers[Index]);
+		}
+	}
+
+	Invokers = MoveTemp(Result);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+TVoxelArray<FVoxelInvokerChunkTracker::FChunkedInvoker> FVoxelInvokerChunkTracker::MakeChunkedInvokers(const TConstVoxelArrayView<FSphere> Invokers) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Invokers.Num(), 1);
+
+	const FMatrix WorldToLocal = LocalToWorld.ToInverseMatrixWithScale();
+	const double WorldToLocalScale = WorldToLocal.GetMaximumAxisScale();
+
+	TVoxelArray<FChunkedInvoker> Result;
+	Result.Reserve(Invokers.Num());
+
+	for (const FSphere& Invoker : Invokers)
+	{
+		FChunkedInvoker ChunkedInvoker;
+		ChunkedInvoker.Center = WorldToLocal.TransformPosition(Invoker.Center) / ChunkSize;
+		ChunkedInvoker.RadiusInChunks = Invoker.W * WorldToLocalScale / ChunkSize;
+		Result.Add(ChunkedInvoker);
+	}
+
+	RemoveContainedInvokers(Result);
+
+	return Result;
+}
+
+void FVoxelInvokerChunkTracker::RasterizeShell(
+	const FChunkedInvoker* OldInvoker,
+	const FChunkedInvoker* NewInvoker,
+	TVoxelArray<FIntVector>& OutAdded,
+	TVoxelArray<FIntVector>& OutRemoved)
+{
+	if (!OldInvoker &&
+		!NewInvoker)
+	{
+		return;
+	}
+
+	FIntVector Min = FIntVector(MAX_int32);
+	FIntVector Max = FIntVector(MIN_int32);
+	if (OldInvoker)
+	{
+		Min = FVoxelUtilities::ComponentMin(Min, OldInvoker->GetMin());
+		Max = FVoxelUtilities::ComponentMax(Max, OldInvoker->GetMax());
+	}
+	if (NewInvoker)
+	{
+		Min = FVoxelUtilities::ComponentMin(Min, NewInvoker->GetMin());
+		Max = FVoxelUtilities::ComponentMax(Max, NewInvoker->GetMax());
+	}
+
+	const int32 NumX = Max.X - Min.X + 1;
+	VOXEL_FUNCTION_COUNTER_NUM(NumX, 1);
+
+	// Each thread rasterizes a slab of X columns, comparing the Z ranges of the old & new spheres
+	// Work is proportional to the shell volume + the number of columns, not to the sphere volume
+	const int32 NumSlabs = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, NumX);
+	const int32 NumXPerSlab = FVoxelUtilities::DivideCeil_Positive(NumX, NumSlabs);
+
+	TVoxelArray<TVoxelArray<FIntVector>> SlabAdded;
+	TVoxelArray<TVoxelArray<FIntVector>> SlabRemoved;
+	SlabAdded.SetNum(NumSlabs);
+	SlabRemoved.SetNum(NumSlabs);
+
+	ParallelFor(NumSlabs, [&](const int32 SlabIndex)
+	{
+		VOXEL_SCOPE_COUNTER("Rasterize slab");
+
+		TVoxelArray<FIntVector>& Added = SlabAdded[SlabIndex];
+		TVoxelArray<FIntVector>& Removed = SlabRemoved[SlabIndex];
+
+		const int32 StartX = Min.X + SlabIndex * NumXPerSlab;
+		const int32 EndX = FMath::Min(StartX + NumXPerSlab, Max.X + 1);
+
+		for (int32 X = StartX; X < EndX; X++)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; Y++)
+			{
+				// Empty ranges are MinZ > MaxZ
+				int32 OldMinZ = 0;
+				int32 OldMaxZ = -1;
+				int32 NewMinZ = 0;
+				int32 NewMaxZ = -1;
+
+				if (OldInvoker &&
+					!OldInvoker->GetColumn(X, Y, OldMinZ, OldMaxZ))
+				{
+					OldMinZ = 0;
+					OldMaxZ = -1;
+				}
+				if (NewInvoker &&
+					!NewInvoker->GetColumn(X, Y, NewMinZ, NewMaxZ))
+				{
+					NewMinZ = 0;
+					NewMaxZ = -1;
+				}
+
+				// Add [A, B] minus [C, D]
+				const auto AddDifference = [&](
+					TVoxelArray<FIntVector>& Cells,
+					const int32 MinA,
+					const int32 MaxA,
+					const int32 MinB,
+					const int32 MaxB)
+				{
+					if (MinA > MaxA)
+					{
+						return;
+					}
+
+					if (MinB > MaxB)
+					{
+						for (int32 Z = MinA; Z <= MaxA; Z++)
+						{
+							Cells.Add(FIntVector(X, Y, Z));
+						}
+						return;
+					}
+
+					for (int32 Z = MinA; Z <= FMath::Min(MaxA, MinB - 1); Z++)
+					{
+						Cells.Add(FIntVector(X, Y, Z));
+					}
+					for (int32 Z = FMath::Max(MinA, MaxB + 1); Z <= MaxA; Z++)
+					{
+						Cells.Add(FIntVector(X, Y, Z));
+					}
+				};
+
+				AddDifference(Added, NewMinZ, NewMaxZ, OldMinZ, OldMaxZ);
+				AddDifference(Removed, OldMinZ, OldMaxZ, NewMinZ, NewMaxZ);
+			}
+		}
+	});
+
+	VOXEL_SCOPE_COUNTER("Concatenate");
+
+	for (const TVoxelArray<FIntVector>& Added : SlabAdded)
+	{
+		OutAdded.Append(Added);
+	}
+	for (const TVoxelArray<FIntVector>& Removed : SlabRemoved)
+	{
+		OutRemoved.Append(Removed);
+	}
+}
\ No newline at end of file
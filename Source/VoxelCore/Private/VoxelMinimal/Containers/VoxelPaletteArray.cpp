@@ -0,0 +1,95 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "VoxelPaletteArrayImpl.ispc.generated.h"
+
+void FVoxelPaletteArrayHelpers::PackIndices(
+	const TConstVoxelArrayView<uint32> Indices,
+	const int32 BitsPerIndex,
+	const TVoxelArrayView<uint32> Words)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Indices.Num(), 1024);
+	check(0 < BitsPerIndex && BitsPerIndex <= 32);
+	check(Words.Num() == GetNumWords(Indices.Num(), BitsPerIndex));
+
+	ispc::PaletteArray_PackIndices(
+		Indices.GetData(),
+		Indices.Num(),
+		BitsPerIndex,
+		Words.GetData(),
+		Words.Num());
+}
+
+void FVoxelPaletteArrayHelpers::UnpackIndices(
+	const TConstVoxelArrayView<uint32> Words,
+	const int32 BitsPerIndex,
+	const TVoxelArrayView<uint32> OutIndices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(OutIndices.Num(), 1024);
+	check(0 < BitsPerIndex && BitsPerIndex <= 32);
+	check(Words.Num() == GetNumWords(OutIndices.Num(), BitsPerIndex));
+
+	ispc::PaletteArray_UnpackIndices(
+		Words.GetData(),
+		BitsPerIndex,
+		OutIndices.GetData(),
+		OutIndices.Num());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelPaletteArrayHelpers::Decode(
+	const TConstVoxelArrayView<uint32> Words,
+	const int32 BitsPerIndex,
+	const TConstVoxelArrayView<uint8> Palette,
+	const TVoxelArrayView<uint8> OutValues)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(OutValues.Num(), 1024);
+	check(0 < BitsPerIndex && BitsPerIndex <= 32);
+	check(Words.Num() == GetNumWords(OutValues.Num(), BitsPerIndex));
+
+	ispc::PaletteArray_Decode_uint8(
+		Words.GetData(),
+		BitsPerIndex,
+		Palette.GetData(),
+		OutValues.GetData(),
+		OutValues.Num());
+}
+
+void FVoxelPaletteArrayHelpers::Decode(
+	const TConstVoxelArrayView<uint32> Words,
+	const int32 BitsPerIndex,
+	const TConstVoxelArrayView<uint16> Palette,
+	const TVoxelArrayView<uint16> OutValues)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(OutValues.Num(), 1024);
+	check(0 < BitsPerIndex && BitsPerIndex <= 32);
+	check(Words.Num() == GetNumWords(OutValues.Num(), BitsPerIndex));
+
+	ispc::PaletteArray_Decode_uint16(
+		Words.GetData(),
+		BitsPerIndex,
+		Palette.GetData(),
+		OutValues.GetData(),
+		OutValues.Num());
+}
+
+void FVoxelPaletteArrayHelpers::Decode(
+	const TConstVoxelArrayView<uint32> Words,
+	const int32 BitsPerIndex,
+	const TConstVoxelArrayView<uint32> Palette,
+	const TVoxelArrayView<uint32> OutValues)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(OutValues.Num(), 1024);
+	check(0 < BitsPerIndex && BitsPerIndex <= 32);
+	check(Words.Num() == GetNumWords(OutValues.Num(), BitsPerIndex));
+
+	ispc::PaletteArray_Decode_uint32(
+		Words.GetData(),
+		BitsPerIndex,
+		Palette.GetData(),
+		OutValues.GetData(),
+		OutValues.Num());
+}
\ No newline at end of file
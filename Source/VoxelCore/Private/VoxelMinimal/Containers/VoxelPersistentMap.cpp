@@ -0,0 +1,5 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelPersistentMapMemory);
\ No newline at end of file
@@ -384,6 +384,411 @@ int64 FVoxelUtilities::CountSetBits(const TConstVoxelArrayView<uint32> Data)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace Voxel::RadixSort
+{
+	constexpr int32 NumBuckets = 256;
+	// Below this, a single block is faster than the ParallelFor overhead
+	constexpr int32 MinBlockSize = 1 << 16;
+
+	FORCEINLINE void Histogram(
+		const uint32* Keys,
+		const int32 Num,
+		const int32 Shift,
+		uint32* OutHistogram)
+	{
+		ispc::ArrayUtilities_RadixHistogram_uint32(Keys, Num, Shift, OutHistogram);
+	}
+	FORCEINLINE void Histogram(
+		const uint64* Keys,
+		const int32 Num,
+		const int32 Shift,
+		uint32* OutHistogram)
+	{
+		ispc::ArrayUtilities_RadixHistogram_uint64(Keys, Num, Shift, OutHistogram);
+	}
+
+	template<typename KeyType, bool bHasPayloads>
+	void Sort(
+		const TVoxelArrayView<KeyType> Keys,
+		const TVoxelArrayView<uint32> Payloads)
+	{
+		VOXEL_SCOPE_COUNTER_NUM("RadixSort", Keys.Num(), 1024);
+		checkVoxelSlow(!bHasPayloads || Keys.Num() == Payloads.Num());
+
+		const int32 Num = Keys.Num();
+		if (Num <= 1)
+		{
+			return;
+		}
+
+		// Bits that differ between keys, passes where they are all zero won't change the order
+		const KeyType FirstKey = Keys[0];
+		const KeyType ChangingBits = ParallelTransformReduce(
+			Keys,
+			KeyType(0),
+			[&](const KeyType Key)
+			{
+				return Key ^ FirstKey;
+			},
+			[](const KeyType A, const KeyType B)
+			{
+				return A | B;
+			},
+			MinBlockSize);
+
+		if (ChangingBits == 0)
+		{
+			return;
+		}
+
+		const int32 NumBlocks = FMath::Clamp(
+			FVoxelUtilities::DivideCeil_Positive(Num, MinBlockSize),
+			1,
+			FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+
+		const auto GetBlockStart = [&](const int32 Block)
+		{
+			return int32(int64(Num) * Block / NumBlocks);
+		};
+
+		TVoxelArray<KeyType> TempKeys;
+		FVoxelUtilities::SetNumFast(TempKeys, Num);
+
+		TVoxelArray<uint32> TempPayloads;
+		if constexpr (bHasPayloads)
+		{
+			FVoxelUtilities::SetNumFast(TempPayloads, Num);
+		}
+
+		KeyType* SrcKeys = Keys.GetData();
+		KeyType* DstKeys = TempKeys.GetData();
+		uint32* SrcPayloads = bHasPayloads ? Payloads.GetData() : nullptr;
+		uint32* DstPayloads = bHasPayloads ? TempPayloads.GetData() : nullptr;
+
+		// Block-major, one histogram per block, then turned into scatter offsets
+		TVoxelArray<uint32> Offsets;
+		FVoxelUtilities::SetNumFast(Offsets, NumBlocks * NumBuckets);
+
+		for (int32 Shift = 0; Shift < int32(8 * sizeof(KeyType)); Shift += 8)
+		{
+			if (((ChangingBits >> Shift) & 0xFF) == 0)
+			{
+				continue;
+			}
+
+			VOXEL_SCOPE_COUNTER_FORMAT("Pass %d", Shift / 8);
+
+			ParallelFor(NumBlocks, [&](const int32 Block)
+			{
+				const int32 Start = GetBlockStart(Block);
+				const int32 End = GetBlockStart(Block + 1);
+
+				Histogram(
+					SrcKeys + Start,
+					End - Start,
+					Shift,
+					&Offsets[Block * NumBuckets]);
+			});
+
+			// Elements of a bucket are ordered by block, then by index in the block: this keeps the sort stable
+			uint32 Offset = 0;
+			for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+			{
+				for (int32 Block = 0; Block < NumBlocks; Block++)
+				{
+					uint32& BlockOffset = Offsets[Block * NumBuckets + Bucket];
+					const uint32 Count = BlockOffset;
+					BlockOffset = Offset;
+					Offset += Count;
+				}
+			}
+			checkVoxelSlow(Offset == uint32(Num));
+
+			// Scatter is serial within a block: ISPC would need conflict detection for it to be stable
+			ParallelFor(NumBlocks, [&](const int32 Block)
+			{
+				const int32 Start = GetBlockStart(Block);
+				const int32 End = GetBlockStart(Block + 1);
+
+				uint32 BlockOffsets[NumBuckets];
+				FMemory::Memcpy(BlockOffsets, &Offsets[Block * NumBuckets], sizeof(BlockOffsets));
+
+				for (int32 Index = Start; Index < End; Index++)
+				{
+					const KeyType Key = SrcKeys[Index];
+					const uint32 DstIndex = BlockOffsets[(Key >> Shift) & 0xFF]++;
+
+					DstKeys[DstIndex] = Key;
+
+					if constexpr (bHasPayloads)
+					{
+						DstPayloads[DstIndex] = SrcPayloads[Index];
+					}
+				}
+			});
+
+			Swap(SrcKeys, DstKeys);
+			Swap(SrcPayloads, DstPayloads);
+		}
+
+		if (SrcKeys != Keys.GetData())
+		{
+			FVoxelUtilities::Memcpy(Keys, MakeVoxelArrayView(TempKeys));
+
+			if constexpr (bHasPayloads)
+			{
+				FVoxelUtilities::Memcpy(Payloads, MakeVoxelArrayView(TempPayloads));
+			}
+		}
+	}
+}
+
+void FVoxelUtilities::RadixSort(const TVoxelArrayView<uint32> Keys)
+{
+	Voxel::RadixSort::Sort<uint32, false>(Keys, {});
+}
+
+void FVoxelUtilities::RadixSort(const TVoxelArrayView<uint64> Keys)
+{
+	Voxel::RadixSort::Sort<uint64, false>(Keys, {});
+}
+
+void FVoxelUtilities::RadixSort(
+	const TVoxelArrayView<uint32> Keys,
+	const TVoxelArrayView<uint32> Payloads)
+{
+	if (!ensure(Keys.Num() == Payloads.Num()))
+	{
+		return;
+	}
+
+	Voxel::RadixSort::Sort<uint32, true>(Keys, Payloads);
+}
+
+void FVoxelUtilities::RadixSort(
+	const TVoxelArrayView<uint64> Keys,
+	const TVoxelArrayView<uint32> Payloads)
+{
+	if (!ensure(Keys.Num() == Payloads.Num()))
+	{
+		return;
+	}
+
+	Voxel::RadixSort::Sort<uint64, true>(Keys, Payloads);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace Voxel::Scan
+{
+	// Below this, a single SIMD pass is faster than the ParallelFor overhead
+	constexpr int32 MinBlockSize = 1 << 16;
+
+	FORCEINLINE int32 GetNumBlocks(const int32 Num)
+	{
+		return FMath::Clamp(
+			FVoxelUtilities::DivideCeil_Positive(Num, MinBlockSize),
+			1,
+			FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	}
+	FORCEINLINE int32 GetBlockStart(const int32 Num, const int32 NumBlocks, const int32 Block)
+	{
+		return int32(int64(Num) * Block / NumBlocks);
+	}
+
+	template<bool bInclusive>
+	int32 Scan(
+		const TConstVoxelArrayView<int32> Values,
+		const TVoxelArrayView<int32> OutValues)
+	{
+		VOXEL_SCOPE_COUNTER_NUM("Scan", Values.Num(), 4096);
+
+		if (!ensure(Values.Num() == OutValues.Num()) ||
+			Values.Num() == 0)
+		{
+			return 0;
+		}
+
+		const auto ScanBlock = [&](const int32 Start, const int32 End, const int32 Offset)
+		{
+			if constexpr (bInclusive)
+			{
+				return ispc::ArrayUtilities_InclusiveScan_int32(
+					Values.GetData() + Start,
+					OutValues.GetData() + Start,
+					End - Start,
+					Offset);
+			}
+			else
+			{
+				return ispc::ArrayUtilities_ExclusiveScan_int32(
+					Values.GetData() + Start,
+					OutValues.GetData() + Start,
+					End - Start,
+					Offset);
+			}
+		};
+
+		const int32 Num = Values.Num();
+		const int32 NumBlocks = GetNumBlocks(Num);
+		if (NumBlocks == 1)
+		{
+			return ScanBlock(0, Num, 0);
+		}
+
+		TVoxelArray<int32> BlockOffsets;
+		FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks);
+
+		ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			const int32 Start = GetBlockStart(Num, NumBlocks, Block);
+			const int32 End = GetBlockStart(Num, NumBlocks, Block + 1);
+
+			BlockOffsets[Block] = ispc::ArrayUtilities_Sum_int32(Values.GetData() + Start, End - Start);
+		});
+
+		int32 Sum = 0;
+		for (int32& BlockOffset : BlockOffsets)
+		{
+			const int32 BlockSum = BlockOffset;
+			BlockOffset = Sum;
+			Sum += BlockSum;
+		}
+
+		// Each block only reads and writes its own range, so in-place scans are safe
+		ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			ScanBlock(
+				GetBlockStart(Num, NumBlocks, Block),
+				GetBlockStart(Num, NumBlocks, Block + 1),
+				BlockOffsets[Block]);
+		});
+
+		return Sum;
+	}
+
+	// GetOutIndices is called with the number of true values once they are counted
+	// Returns the number of true values
+	template<bool bPartition>
+	int32 Compact(
+		const TConstVoxelArrayView<bool> Mask,
+		const TFunctionRef<int32*(int32 NumTrue)> GetOutIndices)
+	{
+		const int32 Num = Mask.Num();
+		const int32 NumBlocks = GetNumBlocks(Num);
+		const uint8* MaskData = ReinterpretCastPtr<uint8>(Mask.GetData());
+
+		TVoxelArray<int32> BlockOffsets;
+		FVoxelUtilities::SetNumFast(BlockOffsets, NumBlocks);
+
+		ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			const int32 Start = GetBlockStart(Num, NumBlocks, Block);
+			const int32 End = GetBlockStart(Num, NumBlocks, Block + 1);
+
+			BlockOffsets[Block] = ispc::ArrayUtilities_CountNonZero_uint8(MaskData + Start, End - Start);
+		});
+
+		int32 NumTrue = 0;
+		for (int32& BlockOffset : BlockOffsets)
+		{
+			const int32 BlockNumTrue = BlockOffset;
+			BlockOffset = NumTrue;
+			NumTrue += BlockNumTrue;
+		}
+
+		int32* OutIndices = GetOutIndices(NumTrue);
+
+		ParallelFor(NumBlocks, [&](const int32 Block)
+		{
+			const int32 Start = GetBlockStart(Num, NumBlocks, Block);
+			const int32 End = GetBlockStart(Num, NumBlocks, Block + 1);
+			const int32 TrueOffset = BlockOffsets[Block];
+
+			if constexpr (bPartition)
+			{
+				// False values before this block are the values before this block that aren't true
+				const int32 FalseOffset = NumTrue + Start - TrueOffset;
+
+				ispc::ArrayUtilities_PartitionIndices(
+					MaskData + Start,
+					End - Start,
+					Start,
+					OutIndices + TrueOffset,
+					OutIndices + FalseOffset);
+			}
+			else
+			{
+				ispc::ArrayUtilities_CompactIndices(
+					MaskData + Start,
+					End - Start,
+					Start,
+					OutIndices + TrueOffset);
+			}
+		});
+
+		return NumTrue;
+	}
+}
+
+int32 FVoxelUtilities::InclusiveScan(
+	const TConstVoxelArrayView<int32> Values,
+	const TVoxelArrayView<int32> OutValues)
+{
+	return Voxel::Scan::Scan<true>(Values, OutValues);
+}
+
+int32 FVoxelUtilities::ExclusiveScan(
+	const TConstVoxelArrayView<int32> Values,
+	const TVoxelArrayView<int32> OutValues)
+{
+	return Voxel::Scan::Scan<false>(Values, OutValues);
+}
+
+void FVoxelUtilities::CompactIndices(
+	const TConstVoxelArrayView<bool> Mask,
+	TVoxelArray<int32>& OutIndices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Mask.Num(), 4096);
+
+	OutIndices.Reset();
+
+	if (Mask.Num() == 0)
+	{
+		return;
+	}
+
+	Voxel::Scan::Compact<false>(Mask, [&](const int32 NumTrue)
+	{
+		FVoxelUtilities::SetNumFast(OutIndices, NumTrue);
+		return OutIndices.GetData();
+	});
+}
+
+int32 FVoxelUtilities::PartitionIndices(
+	const TConstVoxelArrayView<bool> Mask,
+	const TVoxelArrayView<int32> OutIndices)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Mask.Num(), 4096);
+
+	if (!ensure(Mask.Num() == OutIndices.Num()) ||
+		Mask.Num() == 0)
+	{
+		return 0;
+	}
+
+	return Voxel::Scan::Compact<true>(Mask, [&](int32)
+	{
+		return OutIndices.GetData();
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 struct FVoxelOodleHeader
 {
 	uint64 Tag = MAKE_TAG_64("OODLE_VO");
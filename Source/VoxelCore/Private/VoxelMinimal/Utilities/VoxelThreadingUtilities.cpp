@@ -35,6 +35,322 @@ void Voxel::AsyncTask_ThreadPool_Impl(TVoxelUniqueFunction<void()> Lambda)
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace Voxel::ParallelFor
+{
+	FORCEINLINE int32 GetGrainSize(const int32 Num, const int32 GrainSize)
+	{
+		if (GrainSize > 0)
+		{
+			return GrainSize;
+		}
+
+		// Enough ranges per worker for stealing to balance things out
+		return FMath::Max(1, Num / (FPlatformMisc::NumberOfCoresIncludingHyperthreads() * 32));
+	}
+
+	// Start in the low bits, End in the high bits, so that both can be updated with a single CAS
+	FORCEINLINE uint64 PackRange(const int32 StartIndex, const int32 EndIndex)
+	{
+		return uint64(uint32(StartIndex)) | (uint64(uint32(EndIndex)) << 32);
+	}
+	FORCEINLINE void UnpackRange(const uint64 Range, int32& OutStartIndex, int32& OutEndIndex)
+	{
+		OutStartIndex = int32(uint32(Range));
+		OutEndIndex = int32(uint32(Range >> 32));
+	}
+}
+
+int32 ParallelFor_Adaptive_GetNumWorkers(
+	const int32 Num,
+	const int32 GrainSize)
+{
+	if (Num <= 0)
+	{
+		return 0;
+	}
+
+	return FMath::Clamp(
+		FVoxelUtilities::DivideCeil_Positive(Num, Voxel::ParallelFor::GetGrainSize(Num, GrainSize)),
+		1,
+		FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+}
+
+void ParallelFor_Adaptive(
+	const int32 Num,
+	const int32 InGrainSize,
+	const TFunctionRef<void(int32 WorkerIndex, int32 StartIndex, int32 EndIndex)> Lambda)
+{
+	using namespace Voxel::ParallelFor;
+
+	const int32 NumWorkers = ParallelFor_Adaptive_GetNumWorkers(Num, InGrainSize);
+	if (NumWorkers == 0)
+	{
+		return;
+	}
+
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 1);
+
+	const int32 GrainSize = GetGrainSize(Num, InGrainSize);
+
+	if (NumWorkers == 1)
+	{
+		Lambda(0, 0, Num);
+		return;
+	}
+
+	TVoxelArray<TVoxelAtomic_WithPadding<uint64>> Ranges;
+	Ranges.Reserve(NumWorkers);
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++)
+	{
+		Ranges.Add(PackRange(
+			int32(int64(Num) * WorkerIndex / NumWorkers),
+			int32(int64(Num) * (WorkerIndex + 1) / NumWorkers)));
+	}
+
+	ParallelFor(NumWorkers, [&](const int32 WorkerIndex)
+	{
+		TVoxelAtomic_WithPadding<uint64>& Range = Ranges[WorkerIndex];
+
+		while (true)
+		{
+			// Pop GrainSize elements from the front of our own range
+			{
+				uint64 OldRange = Range.Get();
+				while (true)
+				{
+					int32 StartIndex;
+					int32 EndIndex;
+					UnpackRange(OldRange, StartIndex, EndIndex);
+
+					if (StartIndex >= EndIndex)
+					{
+						break;
+					}
+
+					const int32 NewStartIndex = FMath::Min(StartIndex + GrainSize, EndIndex);
+					if (!Range.CompareExchangeWeak(OldRange, PackRange(NewStartIndex, EndIndex)))
+					{
+						continue;
+					}
+
+					Lambda(WorkerIndex, StartIndex, NewStartIndex);
+					OldRange = Range.Get();
+				}
+			}
+
+			// Our range is empty: steal the back half of the largest range
+			// Ranges of GrainSize or less are left to their owner
+			bool bStolen = false;
+			while (!bStolen)
+			{
+				int32 VictimIndex = -1;
+				int32 VictimNum = GrainSize;
+				uint64 VictimRange = 0;
+
+				for (int32 Index = 0; Index < NumWorkers; Index++)
+				{
+					if (Index == WorkerIndex)
+					{
+						continue;
+					}
+
+					const uint64 OtherRange = Ranges[Index].Get();
+
+					int32 StartIndex;
+					int32 EndIndex;
+					UnpackRange(OtherRange, StartIndex, EndIndex);
+
+					if (EndIndex - StartIndex > VictimNum)
+					{
+						VictimIndex = Index;
+						VictimNum = EndIndex - StartIndex;
+						VictimRange = OtherRange;
+					}
+				}
+
+				if (VictimIndex == -1)
+				{
+					// Nothing left to steal, remaining ranges are being processed by their owners
+					return;
+				}
+
+				int32 StartIndex;
+				int32 EndIndex;
+				UnpackRange(VictimRange, StartIndex, EndIndex);
+
+				const int32 MiddleIndex = StartIndex + (EndIndex - StartIndex) / 2;
+				if (!Ranges[VictimIndex].CompareExchangeStrong(VictimRange, PackRange(StartIndex, MiddleIndex)))
+				{
+					// Victim made progress or got stolen from, retry
+					continue;
+				}
+
+				// Only we can write to our own range, and it's empty so no one is stealing from it
+				Range.Set(PackRange(MiddleIndex, EndIndex));
+				bStolen = true;
+			}
+		}
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void ParallelFor_Tiles(
+	const FVoxelIntBox& Bounds,
+	const FIntVector& TileSize,
+	const EVoxelParallelForTileOrder Order,
+	const TFunctionRef<void(const FVoxelIntBox& Tile)> Lambda)
+{
+	if (!Bounds.IsValid() ||
+		!ensure(TileSize.X > 0) ||
+		!ensure(TileSize.Y > 0) ||
+		!ensure(TileSize.Z > 0))
+	{
+		return;
+	}
+
+	const FIntVector NumTiles(
+		FVoxelUtilities::DivideCeil_Positive(Bounds.Size().X, TileSize.X),
+		FVoxelUtilities::DivideCeil_Positive(Bounds.Size().Y, TileSize.Y),
+		FVoxelUtilities::DivideCeil_Positive(Bounds.Size().Z, TileSize.Z));
+
+	const int64 Num64 = int64(NumTiles.X) * int64(NumTiles.Y) * int64(NumTiles.Z);
+	if (!ensure(Num64 <= MAX_int32))
+	{
+		return;
+	}
+	const int32 Num = int32(Num64);
+
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 1);
+
+	const auto GetTile = [&](const FIntVector& TilePosition)
+	{
+		const FIntVector Min = Bounds.Min + TilePosition * TileSize;
+		return FVoxelIntBox(Min, FVoxelUtilities::ComponentMin(Min + TileSize, Bounds.Max));
+	};
+
+	if (Order == EVoxelParallelForTileOrder::Linear)
+	{
+		// Tiles are expensive enough to not need batching
+		ParallelFor_Adaptive(Num, 1, [&](int32, const int32 StartIndex, const int32 EndIndex)
+		{
+			for (int32 Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Lambda(GetTile(FIntVector(
+					Index % NumTiles.X,
+					(Index / NumTiles.X) % NumTiles.Y,
+					Index / (NumTiles.X * NumTiles.Y))));
+			}
+		});
+		return;
+	}
+
+	check(Order == EVoxelParallelForTileOrder::Morton);
+
+	// NumTiles isn't always a power of two: sort the tile positions instead of iterating Morton codes
+	TVoxelArray<uint64> MortonCodes;
+	FVoxelUtilities::SetNumFast(MortonCodes, Num);
+	{
+		int32 Index = 0;
+		for (int32 Z = 0; Z < NumTiles.Z; Z++)
+		{
+			for (int32 Y = 0; Y < NumTiles.Y; Y++)
+			{
+				for (int32 X = 0; X < NumTiles.X; X++)
+				{
+					MortonCodes[Index++] = FVoxelUtilities::MortonEncode3D(FIntVector(X, Y, Z));
+				}
+			}
+		}
+	}
+	MortonCodes.Sort();
+
+	ParallelFor_Adaptive(Num, 1, [&](int32, const int32 StartIndex, const int32 EndIndex)
+	{
+		for (int32 Index = StartIndex; Index < EndIndex; Index++)
+		{
+			Lambda(GetTile(FVoxelUtilities::MortonDecode3D(MortonCodes[Index])));
+		}
+	});
+}
+
+void ParallelFor_Tiles(
+	const FVoxelIntBox2D& Bounds,
+	const FIntPoint& TileSize,
+	const EVoxelParallelForTileOrder Order,
+	const TFunctionRef<void(const FVoxelIntBox2D& Tile)> Lambda)
+{
+	if (!Bounds.IsValid() ||
+		!ensure(TileSize.X > 0) ||
+		!ensure(TileSize.Y > 0))
+	{
+		return;
+	}
+
+	const FIntPoint NumTiles(
+		FVoxelUtilities::DivideCeil_Positive(Bounds.Size().X, TileSize.X),
+		FVoxelUtilities::DivideCeil_Positive(Bounds.Size().Y, TileSize.Y));
+
+	const int64 Num64 = int64(NumTiles.X) * int64(NumTiles.Y);
+	if (!ensure(Num64 <= MAX_int32))
+	{
+		return;
+	}
+	const int32 Num = int32(Num64);
+
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 1);
+
+	const auto GetTile = [&](const FIntPoint& TilePosition)
+	{
+		const FIntPoint Min = Bounds.Min + FIntPoint(TilePosition.X * TileSize.X, TilePosition.Y * TileSize.Y);
+		return FVoxelIntBox2D(Min, FVoxelUtilities::ComponentMin(Min + TileSize, Bounds.Max));
+	};
+
+	if (Order == EVoxelParallelForTileOrder::Linear)
+	{
+		ParallelFor_Adaptive(Num, 1, [&](int32, const int32 StartIndex, const int32 EndIndex)
+		{
+			for (int32 Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Lambda(GetTile(FIntPoint(
+					Index % NumTiles.X,
+					Index / NumTiles.X)));
+			}
+		});
+		return;
+	}
+
+	check(Order == EVoxelParallelForTileOrder::Morton);
+
+	TVoxelArray<uint64> MortonCodes;
+	FVoxelUtilities::SetNumFast(MortonCodes, Num);
+	{
+		int32 Index = 0;
+		for (int32 Y = 0; Y < NumTiles.Y; Y++)
+		{
+			for (int32 X = 0; X < NumTiles.X; X++)
+			{
+				MortonCodes[Index++] = FVoxelUtilities::MortonEncode2D(FIntPoint(X, Y));
+			}
+		}
+	}
+	MortonCodes.Sort();
+
+	ParallelFor_Adaptive(Num, 1, [&](int32, const int32 StartIndex, const int32 EndIndex)
+	{
+		for (int32 Index = StartIndex; Index < EndIndex; Index++)
+		{
+			Lambda(GetTile(FVoxelUtilities::MortonDecode2D(MortonCodes[Index])));
+		}
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 thread_local bool GVoxelAllowParallelTasks = false;
 thread_local TVoxelChunkedArray<TVoxelUniqueFunction<void()>> GVoxelTasks;
 
@@ -0,0 +1,257 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+DEFINE_VOXEL_MEMORY_STAT(STAT_VoxelArenaMemory);
+
+DECLARE_MEMORY_STAT(TEXT("Voxel Arena High Water Mark"), STAT_VoxelArenaHighWaterMark, STATGROUP_Voxel);
+
+namespace Voxel::Arena
+{
+	// Blocks bigger than this are freed on Reset instead of being kept for the next use
+	constexpr int64 MaxRetainedBlockSize = 4 * 1024 * 1024;
+	constexpr int64 MaxBlockSize = 64 * 1024 * 1024;
+
+	FVoxelCounter64 GlobalHighWaterMark;
+
+	struct FThreadState
+	{
+		TVoxelArray<FVoxelArena*> ArenaStack;
+		TVoxelArray<TUniquePtr<FVoxelArena>> PooledArenas;
+	};
+	thread_local FThreadState GThreadState;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelArena::FVoxelArena(const int64 InMinBlockSize)
+	: MinBlockSize(InMinBlockSize)
+{
+	check(MinBlockSize > 0);
+}
+
+FVoxelArena::~FVoxelArena()
+{
+	ensureMsgf(NumLiveAllocations == 0, TEXT("%d arena allocations outlived their arena"), NumLiveAllocations);
+
+	UpdateHighWaterMark();
+
+	while (Blocks)
+	{
+		FBlock* Next = Blocks->Next;
+		FMemory::Free(Blocks);
+		Blocks = Next;
+	}
+
+	DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaMemory, AllocatedSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelArena::Reallocate(
+	void* Pointer,
+	const int64 OldSize,
+	const int64 NewSize,
+	const int32 Alignment)
+{
+	if (!Pointer)
+	{
+		return Allocate(NewSize, Alignment);
+	}
+
+	// Last allocation: grow or shrink in place
+	if (Pointer == LastAllocation &&
+		UPTRINT(Pointer) + NewSize <= UPTRINT(End))
+	{
+		Cursor = LastAllocation + NewSize;
+		return Pointer;
+	}
+
+	void* NewPointer = Allocate(NewSize, Alignment);
+	FMemory::Memcpy(NewPointer, Pointer, FMath::Min(OldSize, NewSize));
+	Free(Pointer);
+	return NewPointer;
+}
+
+void FVoxelArena::Reset()
+{
+	ensureMsgf(NumLiveAllocations == 0, TEXT("%d arena allocations outlived their scope"), NumLiveAllocations);
+
+	UpdateHighWaterMark();
+
+	FBlock* BlockToKeep = nullptr;
+	while (Blocks)
+	{
+		FBlock* Block = Blocks;
+		Blocks = Block->Next;
+
+		if (Block->Size <= Voxel::Arena::MaxRetainedBlockSize &&
+			(!BlockToKeep || Block->Size > BlockToKeep->Size))
+		{
+			Swap(Block, BlockToKeep);
+		}
+
+		if (!Block)
+		{
+			continue;
+		}
+
+		AllocatedSize -= Block->Size;
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaMemory, Block->Size);
+		FMemory::Free(Block);
+	}
+
+	Blocks = BlockToKeep;
+	UsedSizeInPreviousBlocks = 0;
+	LastAllocation = nullptr;
+	NumLiveAllocations = 0;
+
+	if (BlockToKeep)
+	{
+		BlockToKeep->Next = nullptr;
+		Cursor = BlockToKeep->GetData();
+		End = Cursor + BlockToKeep->Size;
+	}
+	else
+	{
+		Cursor = nullptr;
+		End = nullptr;
+	}
+
+	checkVoxelSlow(AllocatedSize == (BlockToKeep ? BlockToKeep->Size : 0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+int64 FVoxelArena::GetUsedSize() const
+{
+	if (!Blocks)
+	{
+		return 0;
+	}
+
+	return UsedSizeInPreviousBlocks + (Cursor - Blocks->GetData());
+}
+
+int64 FVoxelArena::GetHighWaterMark() const
+{
+	UpdateHighWaterMark();
+	return HighWaterMark;
+}
+
+int64 FVoxelArena::GetGlobalHighWaterMark()
+{
+	return Voxel::Arena::GlobalHighWaterMark.Get();
+}
+
+FVoxelArena* FVoxelArena::GetThreadArena()
+{
+	const TVoxelArray<FVoxelArena*>& ArenaStack = Voxel::Arena::GThreadState.ArenaStack;
+	if (ArenaStack.Num() == 0)
+	{
+		return nullptr;
+	}
+	return ArenaStack.Last();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void* FVoxelArena::AllocateSlow(const int64 Size, const int32 Alignment)
+{
+	UpdateHighWaterMark();
+
+	if (Blocks)
+	{
+		UsedSizeInPreviousBlocks += Cursor - Blocks->GetData();
+	}
+
+	// Grow geometrically so that the number of blocks stays small
+	int64 BlockSize = FMath::Max(MinBlockSize, Blocks ? FMath::Min(2 * Blocks->Size, Voxel::Arena::MaxBlockSize) : 0);
+	// Blocks data is 16-aligned, only bigger alignments need padding
+	BlockSize = FMath::Max(BlockSize, Size + FMath::Max(Alignment - 16, 0));
+
+	FBlock* Block = static_cast<FBlock*>(FMemory::Malloc(sizeof(FBlock) + BlockSize, 16));
+	Block->Next = Blocks;
+	Block->Size = BlockSize;
+	Blocks = Block;
+
+	AllocatedSize += BlockSize;
+	INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelArenaMemory, BlockSize);
+
+	Cursor = Block->GetData();
+	End = Cursor + BlockSize;
+
+	void* Result = Allocate(Size, Alignment);
+	checkVoxelSlow(Result);
+	return Result;
+}
+
+void FVoxelArena::UpdateHighWaterMark() const
+{
+	const int64 UsedSize = GetUsedSize();
+	if (UsedSize <= HighWaterMark)
+	{
+		return;
+	}
+	HighWaterMark = UsedSize;
+
+	const int64 OldGlobalHighWaterMark = Voxel::Arena::GlobalHighWaterMark.Apply_ReturnOld([&](const int64 Value)
+	{
+		return FMath::Max(Value, UsedSize);
+	});
+
+	if (UsedSize > OldGlobalHighWaterMark)
+	{
+		SET_MEMORY_STAT(STAT_VoxelArenaHighWaterMark, UsedSize);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelArenaScope::FVoxelArenaScope()
+	: Arena([]
+	{
+		TVoxelArray<TUniquePtr<FVoxelArena>>& PooledArenas = Voxel::Arena::GThreadState.PooledArenas;
+		if (PooledArenas.Num() == 0)
+		{
+			return new FVoxelArena();
+		}
+		return PooledArenas.Pop().Release();
+	}())
+	, bOwnsArena(true)
+{
+	Voxel::Arena::GThreadState.ArenaStack.Add(Arena);
+}
+
+FVoxelArenaScope::FVoxelArenaScope(FVoxelArena& InArena)
+	: Arena(&InArena)
+	, bOwnsArena(false)
+{
+	Voxel::Arena::GThreadState.ArenaStack.Add(Arena);
+}
+
+FVoxelArenaScope::~FVoxelArenaScope()
+{
+	Voxel::Arena::FThreadState& ThreadState = Voxel::Arena::GThreadState;
+
+	check(ThreadState.ArenaStack.Last() == Arena);
+	ThreadState.ArenaStack.Pop();
+
+	if (!bOwnsArena)
+	{
+		return;
+	}
+
+	Arena->Reset();
+	ThreadState.PooledArenas.Add(TUniquePtr<FVoxelArena>(Arena));
+}
\ No newline at end of file
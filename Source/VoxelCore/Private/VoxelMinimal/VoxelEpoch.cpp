@@ -0,0 +1,211 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+namespace Voxel::Epoch
+{
+	// One per thread that ever entered an epoch, never freed, reused once its thread exits
+	struct FThreadSlot
+	{
+		// Global epoch when the thread entered, 0 if the thread isn't in an epoch
+		TVoxelAtomic_WithPadding<uint64> Epoch;
+		TVoxelAtomic<bool> bIsUsed;
+		FThreadSlot* Next = nullptr;
+	};
+
+	struct FRetired
+	{
+		void* Pointer = nullptr;
+		FVoxelEpoch::FDeleter Deleter = nullptr;
+		uint64 Epoch = 0;
+	};
+
+	// Start at 1, 0 means not in an epoch
+	TVoxelAtomic_WithPadding<uint64> GlobalEpoch = 1;
+	TVoxelAtomic<FThreadSlot*> SlotsHead;
+
+	FVoxelCriticalSection RetiredCriticalSection;
+	TVoxelArray<FRetired> Retired_RequiresLock;
+	FVoxelCounter64 NumRetired;
+
+	FThreadSlot& AcquireSlot()
+	{
+		for (FThreadSlot* Slot = SlotsHead.Get(); Slot; Slot = Slot->Next)
+		{
+			bool bExpected = false;
+			if (!Slot->bIsUsed.Get(std::memory_order_relaxed) &&
+				Slot->bIsUsed.CompareExchangeStrong(bExpected, true))
+			{
+				return *Slot;
+			}
+		}
+
+		FThreadSlot* Slot = new FThreadSlot();
+		Slot->bIsUsed.Set(true);
+
+		FThreadSlot* OldHead = SlotsHead.Get();
+		do
+		{
+			Slot->Next = OldHead;
+		}
+		while (!SlotsHead.CompareExchangeWeak(OldHead, Slot));
+
+		return *Slot;
+	}
+
+	struct FThreadState
+	{
+		FThreadSlot* Slot = nullptr;
+		int32 Depth = 0;
+
+		~FThreadState()
+		{
+			if (!Slot)
+			{
+				return;
+			}
+
+			ensure(Depth == 0);
+			Slot->Epoch.Set(0);
+			Slot->bIsUsed.Set(false);
+		}
+	};
+	thread_local FThreadState GThreadState;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelEpoch::Enter()
+{
+	using namespace Voxel::Epoch;
+
+	FThreadState& State = GThreadState;
+	if (State.Depth++ > 0)
+	{
+		return;
+	}
+
+	if (!State.Slot)
+	{
+		State.Slot = &AcquireSlot();
+	}
+
+	checkVoxelSlow(State.Slot->Epoch.Get() == 0);
+	State.Slot->Epoch.Set(GlobalEpoch.Get());
+
+	// The epoch must be visible to Reclaim before we read any shared pointer
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void FVoxelEpoch::Exit()
+{
+	using namespace Voxel::Epoch;
+
+	FThreadState& State = GThreadState;
+	checkVoxelSlow(State.Depth > 0);
+
+	if (--State.Depth > 0)
+	{
+		return;
+	}
+
+	State.Slot->Epoch.Set(0, std::memory_order_release);
+}
+
+bool FVoxelEpoch::IsInEpoch()
+{
+	return Voxel::Epoch::GThreadState.Depth > 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelEpoch::Retire(void* Pointer, const FDeleter Deleter)
+{
+	using namespace Voxel::Epoch;
+
+	checkVoxelSlow(Pointer);
+	checkVoxelSlow(Deleter);
+
+	VOXEL_SCOPE_LOCK(RetiredCriticalSection);
+
+	Retired_RequiresLock.Add(FRetired
+	{
+		Pointer,
+		Deleter,
+		// Readers that entered at this epoch or before might still see Pointer
+		GlobalEpoch.Get()
+	});
+
+	NumRetired.Increment();
+}
+
+void FVoxelEpoch::Reclaim()
+{
+	VOXEL_FUNCTION_COUNTER();
+	using namespace Voxel::Epoch;
+
+	if (NumRetired.Get() == 0)
+	{
+		return;
+	}
+
+	// Readers entering from now on can't see any of the objects retired so far
+	// Objects retired after this point will be tagged with NewEpoch or later and won't be deleted by this pass
+	const uint64 NewEpoch = GlobalEpoch.Increment_ReturnNew();
+
+	uint64 MinActiveEpoch = NewEpoch;
+	for (const FThreadSlot* Slot = SlotsHead.Get(); Slot; Slot = Slot->Next)
+	{
+		const uint64 Epoch = Slot->Epoch.Get();
+		if (Epoch != 0)
+		{
+			MinActiveEpoch = FMath::Min(MinActiveEpoch, Epoch);
+		}
+	}
+
+	TVoxelArray<FRetired> ObjectsToDelete;
+	{
+		VOXEL_SCOPE_LOCK(RetiredCriticalSection);
+
+		for (int32 Index = 0; Index < Retired_RequiresLock.Num(); Index++)
+		{
+			// Readers that entered after the object was retired can't see it
+			if (Retired_RequiresLock[Index].Epoch >= MinActiveEpoch)
+			{
+				continue;
+			}
+
+			ObjectsToDelete.Add(Retired_RequiresLock[Index]);
+			Retired_RequiresLock.RemoveAtSwap(Index);
+			Index--;
+		}
+
+		NumRetired.Subtract(ObjectsToDelete.Num());
+	}
+
+	VOXEL_SCOPE_COUNTER_NUM("Delete", ObjectsToDelete.Num(), 1);
+
+	for (const FRetired& Retired : ObjectsToDelete)
+	{
+		(*Retired.Deleter)(Retired.Pointer);
+	}
+}
+
+void FVoxelEpoch::ReclaimIfNeeded()
+{
+	if (Voxel::Epoch::NumRetired.Get(std::memory_order_relaxed) < 256)
+	{
+		return;
+	}
+
+	Reclaim();
+}
+
+int64 FVoxelEpoch::GetNumRetired()
+{
+	return Voxel::Epoch::NumRetired.Get();
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+FVoxelFrustum::FVoxelFrustum()
+	: FVoxelFrustum({}, FVector::ZeroVector)
+{
+}
+
+FVoxelFrustum::FVoxelFrustum(
+	const TConstVoxelArrayView<FVector4f> Planes,
+	const FVector& ViewOrigin,
+	const double MaxDistance)
+	: ViewOrigin(FVector3f(ViewOrigin))
+	, MaxDistanceSquared(MaxDistance > 0 ? float(FMath::Square(MaxDistance)) : MAX_flt)
+{
+	check(Planes.Num() <= 8);
+
+	TVoxelStaticArray<FVector4f, 8> PaddedPlanes(FVector4f(0.f, 0.f, 0.f, 1.f));
+	for (int32 Index = 0; Index < Planes.Num(); Index++)
+	{
+		PaddedPlanes[Index] = Planes[Index];
+	}
+
+	for (int32 Index = 0; Index < 2; Index++)
+	{
+		const FVector4f& Plane0 = PaddedPlanes[4 * Index + 0];
+		const FVector4f& Plane1 = PaddedPlanes[4 * Index + 1];
+		const FVector4f& Plane2 = PaddedPlanes[4 * Index + 2];
+		const FVector4f& Plane3 = PaddedPlanes[4 * Index + 3];
+
+		PlanesX[Index] = MakeVectorRegisterFloat(Plane0.X, Plane1.X, Plane2.X, Plane3.X);
+		PlanesY[Index] = MakeVectorRegisterFloat(Plane0.Y, Plane1.Y, Plane2.Y, Plane3.Y);
+		PlanesZ[Index] = MakeVectorRegisterFloat(Plane0.Z, Plane1.Z, Plane2.Z, Plane3.Z);
+		PlanesW[Index] = MakeVectorRegisterFloat(Plane0.W, Plane1.W, Plane2.W, Plane3.W);
+	}
+}
+
+FVoxelFrustum FVoxelFrustum::FromViewProjection(
+	const FMatrix& ViewProjectionMatrix,
+	const FVector& ViewOrigin,
+	const double MaxDistance)
+{
+	// Gribb-Hartmann plane extraction. UE matrices transform row vectors, so planes are made from columns
+	const auto GetColumn = [&](const int32 Index)
+	{
+		return FVector4(
+			ViewProjectionMatrix.M[0][Index],
+			ViewProjectionMatrix.M[1][Index],
+			ViewProjectionMatrix.M[2][Index],
+			ViewProjectionMatrix.M[3][Index]);
+	};
+
+	const FVector4 ColumnX = GetColumn(0);
+	const FVector4 ColumnY = GetColumn(1);
+	const FVector4 ColumnZ = GetColumn(2);
+	const FVector4 ColumnW = GetColumn(3);
+
+	// UE uses reversed Z: 0 <= Z <= W
+	const FVector4 Planes[] =
+	{
+		ColumnW + ColumnX,
+		ColumnW - ColumnX,
+		ColumnW + ColumnY,
+		ColumnW - ColumnY,
+		ColumnW - ColumnZ,
+		// Degenerate with infinite far planes, will always be inside
+		ColumnZ,
+	};
+
+	TVoxelStaticArray<FVector4f, 6> NormalizedPlanes{ NoInit };
+	for (int32 Index = 0; Index < 6; Index++)
+	{
+		const FVector4& Plane = Planes[Index];
+
+		const double Length = FVector(Plane).Size();
+		if (Length < SMALL_NUMBER)
+		{
+			NormalizedPlanes[Index] = FVector4f(0.f, 0.f, 0.f, 1.f);
+			continue;
+		}
+
+		NormalizedPlanes[Index] = FVector4f(Plane / Length);
+	}
+
+	return FVoxelFrustum(NormalizedPlanes, ViewOrigin, MaxDistance);
+}
\ No newline at end of file
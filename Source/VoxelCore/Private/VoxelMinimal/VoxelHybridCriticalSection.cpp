@@ -0,0 +1,135 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "HAL/ParkingLot.h"
+
+FVoxelHybridCriticalSection::FVoxelHybridCriticalSection(const FName StatName)
+{
+	if (StatName.IsNone())
+	{
+		return;
+	}
+
+	Stats = MakeUnique<FStats>();
+	Stats->ContendedStatName = FName(StatName.ToString() + " Contended");
+	Stats->WaitTimeStatName = FName(StatName.ToString() + " Wait Time (us)");
+}
+
+FVoxelHybridCriticalSection::~FVoxelHybridCriticalSection()
+{
+	ensureVoxelSlow(!IsLocked());
+}
+
+FVoxelHybridCriticalSection::FVoxelHybridCriticalSection(const FVoxelHybridCriticalSection& Other)
+{
+	if (Other.Stats)
+	{
+		Stats = MakeUnique<FStats>();
+		Stats->ContendedStatName = Other.Stats->ContendedStatName;
+		Stats->WaitTimeStatName = Other.Stats->WaitTimeStatName;
+	}
+}
+
+FVoxelHybridCriticalSection& FVoxelHybridCriticalSection::operator=(const FVoxelHybridCriticalSection&)
+{
+	return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelLockStats FVoxelHybridCriticalSection::GetStats() const
+{
+	if (!Stats)
+	{
+		return {};
+	}
+
+	FVoxelLockStats Result;
+	Result.NumAcquisitions = Stats->NumAcquisitions.Get();
+	Result.NumContendedAcquisitions = Stats->NumContendedAcquisitions.Get();
+	Result.WaitTime = FPlatformTime::ToSeconds64(Stats->WaitTimeCycles.Get());
+	return Result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelHybridCriticalSection::LockSlow()
+{
+	const uint64 StartCycles = Stats ? FPlatformTime::Cycles64() : 0;
+
+	// Spin for roughly a context switch before parking
+	constexpr int32 MaxSpinCycles = 1 << 12;
+	int32 SpinCycles = 16;
+
+	while (true)
+	{
+		uint8 CurrentState = State.Get(std::memory_order_relaxed);
+
+		if (!(CurrentState & LockedFlag))
+		{
+			// Keep the parked flag: other threads might still be parked
+			if (State.CompareExchangeWeak(CurrentState, CurrentState | LockedFlag, std::memory_order_acquire))
+			{
+				break;
+			}
+			continue;
+		}
+
+		// Don't spin if threads are already parked, we would only delay them
+		if (SpinCycles <= MaxSpinCycles &&
+			!(CurrentState & ParkedFlag))
+		{
+			FPlatformProcess::YieldCycles(SpinCycles);
+			SpinCycles *= 2;
+			continue;
+		}
+
+		if (!(CurrentState & ParkedFlag) &&
+			!State.CompareExchangeWeak(CurrentState, CurrentState | ParkedFlag, std::memory_order_relaxed))
+		{
+			continue;
+		}
+
+		UE::ParkingLot::Wait(
+			&State,
+			[&]
+			{
+				// Don't park if the lock got released in the meantime
+				return State.Get(std::memory_order_relaxed) == (LockedFlag | ParkedFlag);
+			},
+			[]
+			{
+			});
+	}
+
+	if (!Stats)
+	{
+		return;
+	}
+
+	const int64 WaitCycles = FPlatformTime::Cycles64() - StartCycles;
+
+	Stats->NumAcquisitions.Add(1, std::memory_order_relaxed);
+	Stats->NumContendedAcquisitions.Add(1, std::memory_order_relaxed);
+	Stats->WaitTimeCycles.Add(WaitCycles, std::memory_order_relaxed);
+
+#if STATS
+	Voxel_AddAmountToDynamicCounterStat(Stats->ContendedStatName, 1);
+	Voxel_AddAmountToDynamicCounterStat(Stats->WaitTimeStatName, int64(FPlatformTime::ToSeconds64(WaitCycles) * 1.e6));
+#endif
+}
+
+void FVoxelHybridCriticalSection::UnlockSlow()
+{
+	UE::ParkingLot::WakeOne(&State, [&](const UE::ParkingLot::FWakeState WakeState) -> uint64
+	{
+		// Release the lock while the parking lot is locked, so that no thread can park in between
+		// Woken threads will have to race for the lock with new threads
+		State.Set(WakeState.bHasWaitingThreads ? ParkedFlag : 0, std::memory_order_release);
+		return 0;
+	});
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+
+#if VOXEL_LOCK_PROFILER
+VOXEL_CONSOLE_VARIABLE(
+	VOXELCORE_API, bool, GVoxelLockProfilerEnabled, true,
+	"voxel.LockProfiler.Enable",
+	"If false, VOXEL_SCOPE_LOCK won't record anything. Only available with VOXEL_LOCK_PROFILER=1");
+
+FVoxelLockProfilerSite* FVoxelLockProfilerSite::Head = nullptr;
+
+namespace Voxel::LockProfiler
+{
+	// Not a FVoxelCriticalSection: VOXEL_SCOPE_LOCK would register a site while registering a site
+	// Never deleted: sites of VoxelCore itself are destroyed during static destruction
+	FCriticalSection& GetSitesCriticalSection()
+	{
+		static FCriticalSection& CriticalSection = *new FCriticalSection();
+		return CriticalSection;
+	}
+
+	FORCEINLINE int32 GetBucket(const uint64 Cycles)
+	{
+		const uint64 Nanoseconds = uint64(FPlatformTime::ToSeconds64(Cycles) * 1.e9);
+		return FMath::Min<int32>(FMath::FloorLog2_64(FMath::Max<uint64>(Nanoseconds, 1)), FVoxelLockProfilerSite::NumBuckets - 1);
+	}
+
+	// Upper bound of the bucket containing the Percentile-th duration, in seconds
+	double GetPercentile(
+		const FVoxelCounter64 (&Histogram)[FVoxelLockProfilerSite::NumBuckets],
+		const double Percentile)
+	{
+		int64 Total = 0;
+		for (const FVoxelCounter64& Count : Histogram)
+		{
+			Total += Count.Get();
+		}
+
+		if (Total == 0)
+		{
+			return 0.;
+		}
+
+		const int64 Target = FMath::Max<int64>(1, FMath::CeilToInt64(Total * Percentile));
+
+		int64 Sum = 0;
+		for (int32 Bucket = 0; Bucket < FVoxelLockProfilerSite::NumBuckets; Bucket++)
+		{
+			Sum += Histogram[Bucket].Get();
+
+			if (Sum >= Target)
+			{
+				return double(uint64(1) << (Bucket + 1)) / 1.e9;
+			}
+		}
+
+		return double(uint64(1) << FVoxelLockProfilerSite::NumBuckets) / 1.e9;
+	}
+}
+
+FVoxelLockProfilerSite::FVoxelLockProfilerSite(
+	const TCHAR* Name,
+	const ANSICHAR* File,
+	const int32 Line,
+	const EVoxelLockProfilerType Type)
+	: Name(Name)
+	, File(File)
+	, Line(Line)
+	, Type(Type)
+{
+	FScopeLock Lock(&Voxel::LockProfiler::GetSitesCriticalSection());
+
+	Next = Head;
+	Head = this;
+}
+
+FVoxelLockProfilerSite::~FVoxelLockProfilerSite()
+{
+	// Name and File point to the module data, the site must not be reachable once it's unloaded
+	FScopeLock Lock(&Voxel::LockProfiler::GetSitesCriticalSection());
+
+	for (FVoxelLockProfilerSite** SitePtr = &Head; *SitePtr; SitePtr = &(*SitePtr)->Next)
+	{
+		if (*SitePtr == this)
+		{
+			*SitePtr = Next;
+			return;
+		}
+	}
+
+	ensure(false);
+}
+
+void FVoxelLockProfilerSite::ForeachSite(const TFunctionRef<void(FVoxelLockProfilerSite&)> Lambda)
+{
+	FScopeLock Lock(&Voxel::LockProfiler::GetSitesCriticalSection());
+
+	for (FVoxelLockProfilerSite* Site = Head; Site; Site = Site->Next)
+	{
+		Lambda(*Site);
+	}
+}
+
+void FVoxelLockProfilerSite::AddWait(const uint64 Cycles)
+{
+	NumAcquisitions.Add(1, std::memory_order_relaxed);
+	TotalWaitCycles.Add(Cycles, std::memory_order_relaxed);
+	WaitHistogram[Voxel::LockProfiler::GetBucket(Cycles)].Add(1, std::memory_order_relaxed);
+}
+
+void FVoxelLockProfilerSite::AddHold(const uint64 Cycles)
+{
+	TotalHoldCycles.Add(Cycles, std::memory_order_relaxed);
+	HoldHistogram[Voxel::LockProfiler::GetBucket(Cycles)].Add(1, std::memory_order_relaxed);
+}
+
+void FVoxelLockProfilerSite::Reset()
+{
+	NumAcquisitions.Set(0);
+	TotalWaitCycles.Set(0);
+	TotalHoldCycles.Set(0);
+
+	for (int32 Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		WaitHistogram[Bucket].Set(0);
+		HoldHistogram[Bucket].Set(0);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.LockProfiler.Print",
+	"Print the call sites with the highest total lock wait time. Optional argument: number of call sites to print, defaults to 20")
+{
+	int32 NumToPrint = 20;
+	if (Args.Num() > 0)
+	{
+		LexFromString(NumToPrint, *Args[0]);
+	}
+
+	struct FSiteStats
+	{
+		FString Description;
+		int64 NumAcquisitions = 0;
+		double TotalWait = 0.;
+		double TotalHold = 0.;
+		double WaitP50 = 0.;
+		double WaitP99 = 0.;
+		double HoldP99 = 0.;
+	};
+
+	// Copy the stats: sites can be unregistered as soon as ForeachSite returns
+	TVoxelArray<FSiteStats> Sites;
+	FVoxelLockProfilerSite::ForeachSite([&](const FVoxelLockProfilerSite& Site)
+	{
+		using namespace Voxel::LockProfiler;
+
+		if (Site.NumAcquisitions.Get() == 0)
+		{
+			return;
+		}
+
+		const TCHAR* TypeName =
+			Site.Type == EVoxelLockProfilerType::Lock
+			? TEXT("Lock")
+			: Site.Type == EVoxelLockProfilerType::ReadLock
+			? TEXT("ReadLock")
+			: TEXT("WriteLock");
+
+		Sites.Add(FSiteStats
+		{
+			FString::Printf(TEXT("%s %s (%s:%d)"), TypeName, Site.Name, ANSI_TO_TCHAR(Site.File), Site.Line),
+			Site.NumAcquisitions.Get(),
+			FPlatformTime::ToSeconds64(Site.TotalWaitCycles.Get()),
+			FPlatformTime::ToSeconds64(Site.TotalHoldCycles.Get()),
+			GetPercentile(Site.WaitHistogram, 0.5),
+			GetPercentile(Site.WaitHistogram, 0.99),
+			GetPercentile(Site.HoldHistogram, 0.99)
+		});
+	});
+
+	Sites.Sort([](const FSiteStats& A, const FSiteStats& B)
+	{
+		return A.TotalWait > B.TotalWait;
+	});
+
+	LOG_VOXEL(Log, "%d lock call sites recorded, printing the %d with the highest total wait time", Sites.Num(), FMath::Min(NumToPrint, Sites.Num()));
+
+	for (int32 Index = 0; Index < FMath::Min(NumToPrint, Sites.Num()); Index++)
+	{
+		const FSiteStats& Site = Sites[Index];
+
+		LOG_VOXEL(Log, "%s", *Site.Description);
+
+		LOG_VOXEL(Log, "\t%lld acquisitions, wait: total %.3fms avg %.3fus p50 <%.3fus p99 <%.3fus, hold: total %.3fms avg %.3fus p99 <%.3fus",
+			Site.NumAcquisitions,
+			Site.TotalWait * 1.e3,
+			Site.TotalWait / Site.NumAcquisitions * 1.e6,
+			Site.WaitP50 * 1.e6,
+			Site.WaitP99 * 1.e6,
+			Site.TotalHold * 1.e3,
+			Site.TotalHold / Site.NumAcquisitions * 1.e6,
+			Site.HoldP99 * 1.e6);
+	}
+}
+
+VOXEL_CONSOLE_COMMAND(
+	"voxel.LockProfiler.Reset",
+	"Reset the lock profiler stats")
+{
+	FVoxelLockProfilerSite::ForeachSite([&](FVoxelLockProfilerSite& Site)
+	{
+		Site.Reset();
+	});
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#include "VoxelMinimal.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+
+TSharedPtr<FVoxelMappedFile> FVoxelMappedFile::Create(const FString& Path, const bool bPreload)
+{
+	VOXEL_SCOPE_COUNTER_FORMAT("FVoxelMappedFile::Create %s", *Path);
+
+	const TSharedRef<FVoxelMappedFile> Result = MakeShareable(new FVoxelMappedFile(Path));
+
+	IPlatformFile::FOpenMappedResult OpenResult = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Path);
+	if (OpenResult.HasValue())
+	{
+		Result->MappedHandle = OpenResult.StealValue();
+	}
+
+	if (Result->MappedHandle)
+	{
+		const int64 FileSize = Result->MappedHandle->GetFileSize();
+		if (FileSize == 0)
+		{
+			return Result;
+		}
+
+		Result->MappedRegion = TUniquePtr<IMappedFileRegion>(Result->MappedHandle->MapRegion(
+			0,
+			FileSize,
+			bPreload ? EMappedFileFlags::EPreloadHint : EMappedFileFlags::ENone));
+
+		if (Result->MappedRegion)
+		{
+			Result->Data = TConstVoxelArrayView64<uint8>(
+				Result->MappedRegion->GetMappedPtr(),
+				Result->MappedRegion->GetMappedSize());
+
+			return Result;
+		}
+	}
+
+	// Mapping isn't supported for this file, load it instead
+	if (!FFileHelper::LoadFileToArray(Result->LoadedData, *Path))
+	{
+		return nullptr;
+	}
+
+	Result->MappedRegion.Reset();
+	Result->MappedHandle.Reset();
+	Result->Data = Result->LoadedData;
+
+	return Result;
+}
+
+FVoxelMappedFile::~FVoxelMappedFile()
+{
+	// Regions must be released before their handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+void FVoxelMappedFile::Prefetch(const int64 Offset, const int64 Count) const
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Count, 1024 * 1024);
+	check(Data.IsValidSlice(Offset, Count));
+
+	if (!MappedRegion ||
+		Count == 0)
+	{
+		return;
+	}
+
+	MappedRegion->PreloadHint(Offset, Count);
+}
+
+TVoxelArrayView64<uint8> FVoxelMappedFile::GetMutableView()
+{
+	if (!bHasMutableCopy)
+	{
+		VOXEL_SCOPE_COUNTER_FORMAT("FVoxelMappedFile::GetMutableView Copy %lldB", Data.Num());
+
+		// Keep the mapping or the loaded data alive: views returned before must stay valid and unchanged
+		MutableData = TVoxelArray64<uint8>(Data);
+		Data = MutableData;
+		bHasMutableCopy = true;
+	}
+
+	return MutableData;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+FVoxelMappedFile::FVoxelMappedFile(const FString& InPath)
+	: Path(InPath)
+{
+}
\ No newline at end of file
@@ -22,7 +22,9 @@ DEFINE_VOXEL_INSTANCE_COUNTER(FVoxelTaskContext);
 
 struct FVoxelTaskContextArray
 {
-	FVoxelSharedCriticalSection CriticalSection;
+	// Read-locked by every Pin, write-locked only when creating or destroying a context
+	// Readers only copy pointers and bump NumStrongRefs under the lock, so read locks never nest
+	FVoxelShardedSharedCriticalSection CriticalSection;
 	TVoxelSparseArray<FVoxelTaskContext*> Contexts_RequiresLock;
 	FVoxelCounter32 SerialCounter;
 };
@@ -47,6 +49,8 @@ public:
 
 		bool bAnyTaskProcessed;
 		ProcessGameTasks(bAnyTaskProcessed);
+
+		FVoxelEpoch::Reclaim();
 	}
 	//~ End FVoxelSingleton Interface
 
@@ -386,6 +390,9 @@ void FVoxelTaskContext::LaunchTask(TVoxelUniqueFunction<void()> Task)
 			LaunchTasks();
 		}
 
+		// Workers are outside of any epoch between tasks, a good time to free retired objects
+		FVoxelEpoch::ReclaimIfNeeded();
+
 		// Decrement allows us to be deleted, make sure to do it last
 		NumPendingTasks.Decrement();
 	};
@@ -93,6 +93,24 @@ TSharedPtr<FVoxelZipReader> FVoxelZipReader::Create(const TConstVoxelArrayView64
 	});
 }
 
+TSharedPtr<FVoxelZipReader> FVoxelZipReader::Create(const TSharedRef<const FVoxelMappedFile>& MappedFile)
+{
+	const TConstVoxelArrayView64<uint8> BulkData = MappedFile->GetView();
+
+	return Create(BulkData.Num(), [BulkData, MappedFile](const int64 Offset, const TVoxelArrayView64<uint8> OutData)
+	{
+		if (!ensure(BulkData.IsValidSlice(Offset, OutData.Num())))
+		{
+			return false;
+		}
+
+		FVoxelUtilities::Memcpy(
+			OutData,
+			BulkData.Slice(Offset, OutData.Num()));
+		return true;
+	});
+}
+
 bool FVoxelZipReader::TryLoad(
 	const FString& Path,
 	TVoxelArray64<uint8>& OutData,
@@ -7,84 +7,37 @@
 class VOXELCORE_API FVoxelFastAABBTree
 {
 public:
-	struct FElementArray
+	// Columns of FElementArray
+	struct EElement
 	{
-		TVoxelArray<int32> Payload;
-		TVoxelArray<float> MinX;
-		TVoxelArray<float> MinY;
-		TVoxelArray<float> MinZ;
-		TVoxelArray<float> MaxX;
-		TVoxelArray<float> MaxY;
-		TVoxelArray<float> MaxZ;
-
-		FORCEINLINE int32 Num() const
-		{
-			checkVoxelSlow(Payload.Num() == MinX.Num());
-			checkVoxelSlow(Payload.Num() == MinY.Num());
-			checkVoxelSlow(Payload.Num() == MinZ.Num());
-			checkVoxelSlow(Payload.Num() == MaxX.Num());
-			checkVoxelSlow(Payload.Num() == MaxY.Num());
-			checkVoxelSlow(Payload.Num() == MaxZ.Num());
-			return Payload.Num();
-		}
-		FORCEINLINE void SetNum(const int32 Number)
+		enum Type : int32
 		{
-			FVoxelUtilities::SetNumFast(Payload, Number);
-			FVoxelUtilities::SetNumFast(MinX, Number);
-			FVoxelUtilities::SetNumFast(MinY, Number);
-			FVoxelUtilities::SetNumFast(MinZ, Number);
-			FVoxelUtilities::SetNumFast(MaxX, Number);
-			FVoxelUtilities::SetNumFast(MaxY, Number);
-			FVoxelUtilities::SetNumFast(MaxZ, Number);
-		}
+			Payload,
+			MinX,
+			MinY,
+			MinZ,
+			MaxX,
+			MaxY,
+			MaxZ
+		};
 	};
+	using FElementArray = TVoxelSoAArray<int32, float, float, float, float, float, float>;
+	using FElementArrayView = FElementArray::FView;
 
-	struct FElementArrayView
+	FORCEINLINE static FVector3f GetElementMin(const FElementArrayView& Elements, const int32 Index)
 	{
-		TVoxelArrayView<int32> Payload;
-		TVoxelArrayView<float> MinX;
-		TVoxelArrayView<float> MinY;
-		TVoxelArrayView<float> MinZ;
-		TVoxelArrayView<float> MaxX;
-		TVoxelArrayView<float> MaxY;
-		TVoxelArrayView<float> MaxZ;
-
-		FORCEINLINE int32 Num() const
-		{
-			checkVoxelSlow(Payload.Num() == MinX.Num());
-			checkVoxelSlow(Payload.Num() == MinY.Num());
-			checkVoxelSlow(Payload.Num() == MinZ.Num());
-			checkVoxelSlow(Payload.Num() == MaxX.Num());
-			checkVoxelSlow(Payload.Num() == MaxY.Num());
-			checkVoxelSlow(Payload.Num() == MaxZ.Num());
-			return Payload.Num();
-		}
-		FORCEINLINE void Swap(const int32 IndexA, const int32 IndexB)
-		{
-			checkVoxelSlow(IndexA != IndexB);
-
-			::Swap(Payload[IndexA], Payload[IndexB]);
-			::Swap(MinX[IndexA], MinX[IndexB]);
-			::Swap(MinY[IndexA], MinY[IndexB]);
-			::Swap(MinZ[IndexA], MinZ[IndexB]);
-			::Swap(MaxX[IndexA], MaxX[IndexB]);
-			::Swap(MaxY[IndexA], MaxY[IndexB]);
-			::Swap(MaxZ[IndexA], MaxZ[IndexB]);
-		}
-
-		FElementArray Array() const
-		{
-			FElementArray Result;
-			Result.Payload = TVoxelArray<int32>(Payload);
-			Result.MinX = TVoxelArray<float>(MinX);
-			Result.MinY = TVoxelArray<float>(MinY);
-			Result.MinZ = TVoxelArray<float>(MinZ);
-			Result.MaxX = TVoxelArray<float>(MaxX);
-			Result.MaxY = TVoxelArray<float>(MaxY);
-			Result.MaxZ = TVoxelArray<float>(MaxZ);
-			return Result;
-		}
-	};
+		return FVector3f(
+			Elements.Get<EElement::MinX>(Index),
+			Elements.Get<EElement::MinY>(Index),
+			Elements.Get<EElement::MinZ>(Index));
+	}
+	FORCEINLINE static FVector3f GetElementMax(const FElementArrayView& Elements, const int32 Index)
+	{
+		return FVector3f(
+			Elements.Get<EElement::MaxX>(Index),
+			Elements.Get<EElement::MaxY>(Index),
+			Elements.Get<EElement::MaxZ>(Index));
+	}
 
 	struct FNode
 	{
@@ -177,19 +130,13 @@ public:
 					if (!Intersects(
 						BoundsMin,
 						BoundsMax,
-						FVector3f(
-							Leaf.Elements.MinX[Index],
-							Leaf.Elements.MinY[Index],
-							Leaf.Elements.MinZ[Index]),
-						FVector3f(
-							Leaf.Elements.MaxX[Index],
-							Leaf.Elements.MaxY[Index],
-							Leaf.Elements.MaxZ[Index])))
+						GetElementMin(Leaf.Elements, Index),
+						GetElementMax(Leaf.Elements, Index)))
 					{
 						continue;
 					}
 
-					if (CustomCheck(Leaf.Elements.Payload[Index]))
+					if (CustomCheck(Leaf.Elements.Get<EElement::Payload>(Index)))
 					{
 						return true;
 					}
@@ -220,6 +167,57 @@ public:
 		return false;
 	}
 
+public:
+	struct FQueryArrayView
+	{
+		TConstVoxelArrayView<float> MinX;
+		TConstVoxelArrayView<float> MinY;
+		TConstVoxelArrayView<float> MinZ;
+		TConstVoxelArrayView<float> MaxX;
+		TConstVoxelArrayView<float> MaxY;
+		TConstVoxelArrayView<float> MaxZ;
+
+		FORCEINLINE int32 Num() const
+		{
+			checkVoxelSlow(MinX.Num() == MinY.Num());
+			checkVoxelSlow(MinX.Num() == MinZ.Num());
+			checkVoxelSlow(MinX.Num() == MaxX.Num());
+			checkVoxelSlow(MinX.Num() == MaxY.Num());
+			checkVoxelSlow(MinX.Num() == MaxZ.Num());
+			return MinX.Num();
+		}
+	};
+	struct FQueryHit
+	{
+		int32 QueryIndex = -1;
+		int32 Payload = -1;
+	};
+
+	// Queries are traversed as a packet: every node is tested against all the queries overlapping its parent in a single ISPC call
+	// Batches larger than QueriesPerChunk are split into chunks processed in parallel
+	// Hits are sorted by QueryIndex, but payloads are in no particular order
+	TVoxelArray<FQueryHit> BulkIntersects(
+		const FQueryArrayView& Queries,
+		int32 QueriesPerChunk = 1024) const;
+
+	// Result[QueryIndex] is true if any element intersects the query
+	FVoxelBitArray BulkIntersectsAny(
+		const FQueryArrayView& Queries,
+		int32 QueriesPerChunk = 1024) const;
+
+private:
+	void BulkIntersectsChunk(
+		const FQueryArrayView& Queries,
+		int32 StartIndex,
+		int32 Num,
+		bool bStopAtFirstHit,
+		TVoxelArray<FQueryHit>& OutHits) const;
+
+	TVoxelArray<FQueryHit> BulkIntersectsImpl(
+		const FQueryArrayView& Queries,
+		int32 QueriesPerChunk,
+		bool bStopAtFirstHit) const;
+
 public:
 	template<typename ShouldVisitType, typename VisitType>
 	void Traverse(ShouldVisitType&& ShouldVisit, VisitType&& Visit) const
@@ -244,19 +242,13 @@ public:
 				for (int32 Index = 0; Index < Leaf.Elements.Num(); Index++)
 				{
 					if (!ShouldVisit(
-						FVector3f(
-							Leaf.Elements.MinX[Index],
-							Leaf.Elements.MinY[Index],
-							Leaf.Elements.MinZ[Index]),
-						FVector3f(
-							Leaf.Elements.MaxX[Index],
-							Leaf.Elements.MaxY[Index],
-							Leaf.Elements.MaxZ[Index])))
+						GetElementMin(Leaf.Elements, Index),
+						GetElementMax(Leaf.Elements, Index)))
 					{
 						continue;
 					}
 
-					Visit(Leaf.Elements.Payload[Index]);
+					Visit(Leaf.Elements.Get<EElement::Payload>(Index));
 				}
 			}
 			else
@@ -292,6 +284,143 @@ public:
 			MoveTemp(Visit));
 	}
 
+public:
+	// Visit is called with the payload and the mask of the frustums the element is visible in
+	// Nearest child & nearest leaf elements are visited first, relative to the first frustum view origin
+	// Subtrees fully inside a frustum are not tested against it again
+	template<
+		typename VisitType,
+		typename ReturnType = LambdaReturnType_T<VisitType>,
+		typename = std::enable_if_t<std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterate>>>
+	void TraverseFrustums(
+		const TConstVoxelArrayView<FVoxelFrustum> Frustums,
+		VisitType&& Visit) const
+	{
+		if (Nodes.Num() == 0 ||
+			!ensure(Frustums.Num() > 0) ||
+			!ensure(Frustums.Num() <= FVoxelFrustum::MaxViews))
+		{
+			return;
+		}
+
+		const FVoxelFrustum& MainFrustum = Frustums[0];
+
+		struct FQueuedNode
+		{
+			int32 NodeIndex;
+			uint32 VisibleMask;
+			uint32 InsideMask;
+		};
+		TVoxelInlineArray<FQueuedNode, 64> QueuedNodes;
+		QueuedNodes.Add_EnsureNoGrow(FQueuedNode{ 0, FVoxelFrustum::GetAllViewsMask(Frustums), 0 });
+
+		struct FVisibleElement
+		{
+			int32 Payload;
+			uint32 VisibleMask;
+			float DistanceSquared;
+		};
+		TVoxelInlineArray<FVisibleElement, 16> VisibleElements;
+
+		while (QueuedNodes.Num() > 0)
+		{
+			const FQueuedNode QueuedNode = QueuedNodes.Pop();
+
+			const FNode& Node = Nodes[QueuedNode.NodeIndex];
+			if (Node.bLeaf)
+			{
+				const FLeaf& Leaf = Leaves[Node.LeafIndex];
+
+				VisibleElements.Reset();
+
+				for (int32 Index = 0; Index < Leaf.Elements.Num(); Index++)
+				{
+					const FVector3f Min = GetElementMin(Leaf.Elements, Index);
+					const FVector3f Max = GetElementMax(Leaf.Elements, Index);
+
+					uint32 VisibleMask = QueuedNode.VisibleMask;
+					uint32 InsideMask = QueuedNode.InsideMask;
+					FVoxelFrustum::TestViews(Frustums, Min, Max, VisibleMask, InsideMask);
+
+					if (VisibleMask == 0)
+					{
+						continue;
+					}
+
+					VisibleElements.Add(FVisibleElement
+					{
+						Leaf.Elements.Get<EElement::Payload>(Index),
+						VisibleMask,
+						MainFrustum.GetDistanceSquared(Min, Max)
+					});
+				}
+
+				VisibleElements.Sort([](const FVisibleElement& A, const FVisibleElement& B)
+				{
+					return A.DistanceSquared < B.DistanceSquared;
+				});
+
+				for (const FVisibleElement& Element : VisibleElements)
+				{
+					if constexpr (std::is_void_v<ReturnType>)
+					{
+						Visit(Element.Payload, Element.VisibleMask);
+					}
+					else
+					{
+						if (Visit(Element.Payload, Element.VisibleMask) == EVoxelIterate::Stop)
+						{
+							return;
+						}
+					}
+				}
+				continue;
+			}
+
+			uint32 VisibleMask0 = QueuedNode.VisibleMask;
+			uint32 InsideMask0 = QueuedNode.InsideMask;
+			FVoxelFrustum::TestViews(Frustums, Node.ChildBounds0_Min, Node.ChildBounds0_Max, VisibleMask0, InsideMask0);
+
+			uint32 VisibleMask1 = QueuedNode.VisibleMask;
+			uint32 InsideMask1 = QueuedNode.InsideMask;
+			FVoxelFrustum::TestViews(Frustums, Node.ChildBounds1_Min, Node.ChildBounds1_Max, VisibleMask1, InsideMask1);
+
+			const FQueuedNode Child0{ Node.ChildIndex0, VisibleMask0, InsideMask0 };
+			const FQueuedNode Child1{ Node.ChildIndex1, VisibleMask1, InsideMask1 };
+
+			// Stack: push the farthest first
+			const bool bChild0First =
+				MainFrustum.GetDistanceSquared(Node.ChildBounds0_Min, Node.ChildBounds0_Max) <=
+				MainFrustum.GetDistanceSquared(Node.ChildBounds1_Min, Node.ChildBounds1_Max);
+
+			const FQueuedNode& First = bChild0First ? Child0 : Child1;
+			const FQueuedNode& Second = bChild0First ? Child1 : Child0;
+
+			if (Second.VisibleMask)
+			{
+				QueuedNodes.Add_EnsureNoGrow(Second);
+			}
+			if (First.VisibleMask)
+			{
+				QueuedNodes.Add_EnsureNoGrow(First);
+			}
+		}
+	}
+
+	template<
+		typename VisitType,
+		typename ReturnType = LambdaReturnType_T<VisitType>,
+		typename = std::enable_if_t<std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterate>>>
+	FORCEINLINE void TraverseFrustum(
+		const FVoxelFrustum& Frustum,
+		VisitType&& Visit) const
+	{
+		this->TraverseFrustums(TConstVoxelArrayView<FVoxelFrustum>(&Frustum, 1), [&](const int32 Payload, uint32) -> ReturnType
+		{
+			return Visit(Payload);
+		});
+	}
+
 private:
 	TVoxelArray<FNode> Nodes;
 	TVoxelArray<FLeaf> Leaves;
@@ -388,6 +388,114 @@ public:
 		}
 	}
 
+	// Lambda is called with the mask of the frustums the node is visible in
+	// Nodes are visited front to back relative to the first frustum view origin
+	// Subtrees fully inside a frustum are not tested against it again
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+		LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&, uint32)>
+	)
+	FORCENOINLINE void TraverseFrustums(const TConstVoxelArrayView<FVoxelFrustum> Frustums, LambdaType Lambda) const
+	{
+		if (!ensure(Frustums.Num() > 0) ||
+			!ensure(Frustums.Num() <= FVoxelFrustum::MaxViews))
+		{
+			return;
+		}
+
+		struct FQueuedNode
+		{
+			FNodeRef NodeRef;
+			uint32 VisibleMask;
+			uint32 InsideMask;
+		};
+		TVoxelStaticArray<FQueuedNode, 8 * MaxDepth> NodesToTraverse{ NoInit };
+
+		int32 NumNodesToTraverse = 1;
+		NodesToTraverse[0] = FQueuedNode{ Root(), FVoxelFrustum::GetAllViewsMask(Frustums), 0 };
+
+		const FVector3f ViewOrigin = Frustums[0].GetViewOrigin();
+
+		while (NumNodesToTraverse > 0)
+		{
+			const FQueuedNode QueuedNode = NodesToTraverse[--NumNodesToTraverse];
+			const FNodeRef NodeRef = QueuedNode.NodeRef;
+
+			uint32 VisibleMask = QueuedNode.VisibleMask;
+			uint32 InsideMask = QueuedNode.InsideMask;
+			{
+				const FVoxelIntBox Bounds = NodeRef.GetBounds();
+				FVoxelFrustum::TestViews(Frustums, FVector3f(Bounds.Min), FVector3f(Bounds.Max), VisibleMask, InsideMask);
+			}
+
+			if (VisibleMask == 0)
+			{
+				continue;
+			}
+
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(NodeRef, VisibleMask);
+			}
+			else
+			{
+				switch (Lambda(NodeRef, VisibleMask))
+				{
+				default: VOXEL_ASSUME(false);
+				case EVoxelIterateTree::Continue: break;
+				case EVoxelIterateTree::SkipChildren: continue;
+				case EVoxelIterateTree::Stop: return;
+				}
+			}
+
+			if (NodeRef.Height == 0)
+			{
+				continue;
+			}
+
+			const FChildren& Children = IndexToChildren[NodeRef.Index];
+
+			// Child bit is set if the child is on the positive side of the center
+			// Visiting children in the order Octant ^ 0, Octant ^ 1... Octant ^ 7 is front to back
+			const FVector3f Center = FVector3f(NodeRef.Center);
+			const int32 Octant =
+				(ViewOrigin.X >= Center.X ? 0x1 : 0) |
+				(ViewOrigin.Y >= Center.Y ? 0x2 : 0) |
+				(ViewOrigin.Z >= Center.Z ? 0x4 : 0);
+
+			// Stack: push the farthest first
+			for (int32 Index = 7; Index >= 0; Index--)
+			{
+				const int32 Child = Octant ^ Index;
+				if (Children[Child] != -1)
+				{
+					NodesToTraverse[NumNodesToTraverse++] = FQueuedNode
+					{
+						FNodeRef(Children[Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child)),
+						VisibleMask,
+						InsideMask
+					};
+				}
+			}
+		}
+	}
+
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+		LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+	)
+	FORCEINLINE void TraverseFrustum(const FVoxelFrustum& Frustum, LambdaType Lambda) const
+	{
+		this->TraverseFrustums(TConstVoxelArrayView<FVoxelFrustum>(&Frustum, 1), [&](const FNodeRef& NodeRef, uint32) -> ReturnType
+		{
+			return Lambda(NodeRef);
+		});
+	}
+
 public:
 	template<typename PredicateType, typename AddNodeType, typename RemoveNodeType>
 	void Update(
@@ -395,6 +503,199 @@ public:
 		const PredicateType& Predicate,
 		const AddNodeType& AddNode,
 		const RemoveNodeType& RemoveNode)
+	{
+		this->UpdateImpl(
+			NodeRef,
+			Predicate,
+			[](const FNodeRef&) { return true; },
+			AddNode,
+			RemoveNode);
+	}
+	template<typename PredicateType, typename AddNodeType, typename RemoveNodeType>
+	void Update(
+		const PredicateType& Predicate,
+		const AddNodeType& AddNode,
+		const RemoveNodeType& RemoveNode)
+	{
+		this->Update(Root(), Predicate, AddNode, RemoveNode);
+	}
+
+public:
+	struct FUpdateResult
+	{
+		// Valid until the next update
+		TVoxelArray<FNodeRef> AddedNodes;
+		// These nodes are destroyed: only their height, center & bounds can be used
+		TVoxelArray<FNodeRef> RemovedNodes;
+	};
+
+	// Only re-evaluate the subtrees for which ShouldUpdate returns true
+	// ShouldUpdate must return false only if Predicate is known to not have changed for the node and all its descendants
+	// ShouldUpdate is also called on nodes that don't exist yet
+	template<typename PredicateType, typename ShouldUpdateType>
+	FUpdateResult UpdateIncremental(
+		const PredicateType& Predicate,
+		const ShouldUpdateType& ShouldUpdate)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(NumNodes(), 1024);
+
+		FUpdateResult Result;
+		this->UpdateImpl(
+			Root(),
+			Predicate,
+			ShouldUpdate,
+			[&](const FNodeRef& NodeRef)
+			{
+				Result.AddedNodes.Add(NodeRef);
+			},
+			[&](const FNodeRef& NodeRef)
+			{
+				Result.RemovedNodes.Add(FNodeRef(FNodeRef::InvalidIndex, NodeRef.Height, NodeRef.Center));
+			});
+		return Result;
+	}
+
+	// Conservative ShouldUpdate for predicates of the form Distance(Invoker, NodeBounds) < GetThreshold(NodeHeight)
+	// GetThreshold must be increasing with height
+	// A subtree is skipped if the invoker move can't make any of its nodes cross the threshold of their height
+	template<typename GetThresholdType>
+	static auto MakeDistanceBandFilter(
+		const FVector& OldInvoker,
+		const FVector& NewInvoker,
+		GetThresholdType GetThreshold)
+	{
+		return [=, Delta = FVector::Distance(OldInvoker, NewInvoker)](const FNodeRef& NodeRef)
+		{
+			const FVoxelBox Bounds = NodeRef.GetBounds().ToVoxelBox();
+
+			const FVector FarthestCorner(
+				OldInvoker.X < Bounds.GetCenter().X ? Bounds.Max.X : Bounds.Min.X,
+				OldInvoker.Y < Bounds.GetCenter().Y ? Bounds.Max.Y : Bounds.Min.Y,
+				OldInvoker.Z < Bounds.GetCenter().Z ? Bounds.Max.Z : Bounds.Min.Z);
+
+			// Distances can't change by more than Delta
+			// The node distance is MinDistance, descendant distances are between MinDistance and MaxDistance
+			const double MinDistance = Bounds.DistanceToPoint(OldInvoker);
+			const double MaxDistance = FVector::Distance(OldInvoker, FarthestCorner);
+
+			const double Threshold = GetThreshold(NodeRef.GetHeight());
+			if (MinDistance - Delta <= Threshold &&
+				Threshold <= MinDistance + Delta)
+			{
+				return true;
+			}
+
+			for (int32 Height = 0; Height < NodeRef.GetHeight(); Height++)
+			{
+				const double DescendantThreshold = GetThreshold(Height);
+				if (DescendantThreshold > MaxDistance + Delta)
+				{
+					// Thresholds are increasing
+					return false;
+				}
+				if (DescendantThreshold >= MinDistance - Delta)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		};
+	}
+
+	// Re-evaluate the whole tree, evaluating Predicate in parallel on the subtrees NumSerialLevels below the root
+	// Useful for large jumps such as teleports, where an incremental update would visit most of the tree anyway
+	// Predicate is called from multiple threads, and always on nodes with an invalid index: it cannot access node data
+	template<typename PredicateType>
+	FUpdateResult UpdateParallel(
+		const PredicateType& Predicate,
+		const int32 NumSerialLevels = 2)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(NumNodes(), 1024);
+
+		struct FSegment
+		{
+			FNodeRef NodeRef;
+			bool bDeferred = false;
+			uint8 ChildMask = 0;
+			TVoxelArray<uint8> ChildMasks;
+		};
+		TVoxelArray<FSegment> Segments;
+
+		// Evaluate the top levels serially, deferring the subtrees below
+		{
+			VOXEL_SCOPE_COUNTER("Top levels");
+
+			const auto Build = [&](const FNodeRef& NodeRef, const int32 Level, auto& Self) -> void
+			{
+				if (NodeRef.Height == 0)
+				{
+					return;
+				}
+
+				if (Level >= NumSerialLevels)
+				{
+					Segments.Add(FSegment{ NodeRef, true });
+					return;
+				}
+
+				const uint8 ChildMask = this->GetDesiredChildMask(NodeRef, Predicate);
+				Segments.Add(FSegment{ NodeRef, false, ChildMask });
+
+				for (int32 Child = 0; Child < 8; Child++)
+				{
+					if (ChildMask & (1 << Child))
+					{
+						Self(FNodeRef(FNodeRef::InvalidIndex, NodeRef.Height - 1, NodeRef.GetChildCenter(Child)), Level + 1, Self);
+					}
+				}
+			};
+			Build(Root(), 0, Build);
+		}
+
+		{
+			VOXEL_SCOPE_COUNTER("Subtrees");
+
+			ParallelFor(Segments, [&](FSegment& Segment)
+			{
+				if (Segment.bDeferred)
+				{
+					this->BuildDesiredChildMasks(Segment.NodeRef, Predicate, Segment.ChildMasks);
+				}
+			});
+		}
+
+		// Child masks of all the nodes with a height > 0, in depth-first order
+		TVoxelArray<uint8> ChildMasks;
+		for (const FSegment& Segment : Segments)
+		{
+			if (Segment.bDeferred)
+			{
+				ChildMasks.Append(Segment.ChildMasks);
+			}
+			else
+			{
+				ChildMasks.Add(Segment.ChildMask);
+			}
+		}
+
+		VOXEL_SCOPE_COUNTER("Apply");
+
+		FUpdateResult Result;
+		int32 ChildMaskIndex = 0;
+		this->ApplyChildMasks(Root(), ChildMasks, ChildMaskIndex, Result);
+		check(ChildMaskIndex == ChildMasks.Num());
+		return Result;
+	}
+
+private:
+	template<typename PredicateType, typename ShouldUpdateType, typename AddNodeType, typename RemoveNodeType>
+	void UpdateImpl(
+		const FNodeRef NodeRef,
+		const PredicateType& Predicate,
+		const ShouldUpdateType& ShouldUpdate,
+		const AddNodeType& AddNode,
+		const RemoveNodeType& RemoveNode)
 	{
 		if (NodeRef.Height == 0)
 		{
@@ -406,7 +707,8 @@ public:
 			if (IndexToChildren[NodeRef.Index][Child] == -1)
 			{
 				const FNodeRef DummyChildNodeRef(FNodeRef::InvalidIndex, NodeRef.Height - 1, NodeRef.GetChildCenter(Child));
-				if (!Predicate(DummyChildNodeRef))
+				if (!ShouldUpdate(DummyChildNodeRef) ||
+					!Predicate(DummyChildNodeRef))
 				{
 					continue;
 				}
@@ -415,12 +717,17 @@ public:
 
 				const FNodeRef ChildNodeRef(IndexToChildren[NodeRef.Index][Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child));
 				AddNode(ChildNodeRef);
-				this->Update(ChildNodeRef, Predicate, AddNode, RemoveNode);
+				this->UpdateImpl(ChildNodeRef, Predicate, ShouldUpdate, AddNode, RemoveNode);
 			}
 			else
 			{
 				const FNodeRef ChildNodeRef(IndexToChildren[NodeRef.Index][Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child));
-				this->Update(ChildNodeRef, Predicate, AddNode, RemoveNode);
+				if (!ShouldUpdate(ChildNodeRef))
+				{
+					continue;
+				}
+
+				this->UpdateImpl(ChildNodeRef, Predicate, ShouldUpdate, AddNode, RemoveNode);
 
 				if (Predicate(ChildNodeRef))
 				{
@@ -433,13 +740,101 @@ public:
 			}
 		}
 	}
-	template<typename PredicateType, typename AddNodeType, typename RemoveNodeType>
-	void Update(
+
+	template<typename PredicateType>
+	static uint8 GetDesiredChildMask(const FNodeRef& NodeRef, const PredicateType& Predicate)
+	{
+		checkVoxelSlow(NodeRef.Height > 0);
+
+		uint8 ChildMask = 0;
+		for (int32 Child = 0; Child < 8; Child++)
+		{
+			if (Predicate(FNodeRef(FNodeRef::InvalidIndex, NodeRef.Height - 1, NodeRef.GetChildCenter(Child))))
+			{
+				ChildMask |= 1 << Child;
+			}
+		}
+		return ChildMask;
+	}
+	template<typename PredicateType>
+	static void BuildDesiredChildMasks(
+		const FNodeRef& NodeRef,
 		const PredicateType& Predicate,
-		const AddNodeType& AddNode,
-		const RemoveNodeType& RemoveNode)
+		TVoxelArray<uint8>& OutChildMasks)
 	{
-		this->Update(Root(), Predicate, AddNode, RemoveNode);
+		if (NodeRef.Height == 0)
+		{
+			return;
+		}
+
+		const uint8 ChildMask = GetDesiredChildMask(NodeRef, Predicate);
+		OutChildMasks.Add(ChildMask);
+
+		for (int32 Child = 0; Child < 8; Child++)
+		{
+			if (ChildMask & (1 << Child))
+			{
+				BuildDesiredChildMasks(
+					FNodeRef(FNodeRef::InvalidIndex, NodeRef.Height - 1, NodeRef.GetChildCenter(Child)),
+					Predicate,
+					OutChildMasks);
+			}
+		}
+	}
+	void ApplyChildMasks(
+		const FNodeRef NodeRef,
+		const TConstVoxelArrayView<uint8> ChildMasks,
+		int32& ChildMaskIndex,
+		FUpdateResult& Result)
+	{
+		if (NodeRef.Height == 0)
+		{
+			return;
+		}
+
+		const uint8 ChildMask = ChildMasks[ChildMaskIndex++];
+
+		for (int32 Child = 0; Child < 8; Child++)
+		{
+			const bool bExists = IndexToChildren[NodeRef.Index][Child] != -1;
+
+			if (ChildMask & (1 << Child))
+			{
+				if (!bExists)
+				{
+					this->CreateChild(NodeRef, Child);
+					Result.AddedNodes.Add(FNodeRef(IndexToChildren[NodeRef.Index][Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child)));
+				}
+
+				const FNodeRef ChildNodeRef(IndexToChildren[NodeRef.Index][Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child));
+				this->ApplyChildMasks(ChildNodeRef, ChildMasks, ChildMaskIndex, Result);
+			}
+			else if (bExists)
+			{
+				this->RemoveSubtree(NodeRef, Child, Result);
+			}
+		}
+	}
+	void RemoveSubtree(
+		const FNodeRef NodeRef,
+		const int32 Child,
+		FUpdateResult& Result)
+	{
+		const FNodeRef ChildNodeRef(IndexToChildren[NodeRef.Index][Child], NodeRef.Height - 1, NodeRef.GetChildCenter(Child));
+
+		if (ChildNodeRef.Height > 0)
+		{
+			for (int32 ChildChild = 0; ChildChild < 8; ChildChild++)
+			{
+				if (IndexToChildren[ChildNodeRef.Index][ChildChild] != -1)
+				{
+					this->RemoveSubtree(ChildNodeRef, ChildChild, Result);
+				}
+			}
+		}
+
+		Result.RemovedNodes.Add(FNodeRef(FNodeRef::InvalidIndex, ChildNodeRef.Height, ChildNodeRef.Center));
+		this->DestroyChild(NodeRef, Child);
 	}
 
 private:
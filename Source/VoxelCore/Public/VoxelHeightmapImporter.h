@@ -23,6 +23,9 @@ public:
 
 	static TSharedPtr<FVoxelHeightmapImporter> MakeImporter(const FString& Path);
 	static bool Import(const FString& Path, FString& OutError, FIntPoint& OutSize, int32& OutBitDepth, TArray64<uint8>& OutData);
+
+	// Heights normalized to 0-1, eg to build a FVoxelHeightmapPyramid
+	TVoxelArray<float> GetNormalizedHeights() const;
 };
 
 class VOXELCORE_API FVoxelHeightmapImporter_PNG : public FVoxelHeightmapImporter
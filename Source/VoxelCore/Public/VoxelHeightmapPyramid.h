@@ -0,0 +1,119 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+enum class EVoxelHeightmapClassification : uint8
+{
+	// Box is fully above the terrain, ie empty
+	Above,
+	// Box is fully below the terrain, ie solid
+	Below,
+	Intersecting
+};
+
+// Min/max mip pyramid over a 2D height array
+// Heights are in heightmap space: sample X Y is at position X Y, Z is the height
+// The surface is made of two triangles per cell, and is clamped at the heightmap edges
+class VOXELCORE_API FVoxelHeightmapPyramid
+{
+public:
+	struct FLevel
+	{
+		// Number of cells in this level
+		FIntPoint Size = FIntPoint::ZeroValue;
+		TVoxelArray<float> MinHeights;
+		TVoxelArray<float> MaxHeights;
+
+		FORCEINLINE int32 GetIndex(const int32 X, const int32 Y) const
+		{
+			checkVoxelSlow(0 <= X && X < Size.X);
+			checkVoxelSlow(0 <= Y && Y < Size.Y);
+			return X + Y * Size.X;
+		}
+	};
+
+	FVoxelHeightmapPyramid() = default;
+
+	void Initialize(
+		const FIntPoint& NewSize,
+		TConstVoxelArrayView<float> NewHeights);
+
+	FORCEINLINE bool IsEmpty() const
+	{
+		return Levels.Num() == 0;
+	}
+	FORCEINLINE const FIntPoint& GetSize() const
+	{
+		return Size;
+	}
+	FORCEINLINE int32 NumLevels() const
+	{
+		return Levels.Num();
+	}
+	FORCEINLINE const FLevel& GetLevel(const int32 Index) const
+	{
+		return Levels[Index];
+	}
+	FORCEINLINE float GetHeight(const int32 X, const int32 Y) const
+	{
+		checkVoxelSlow(0 <= X && X < Size.X);
+		checkVoxelSlow(0 <= Y && Y < Size.Y);
+		return Heights[X + Y * Size.X];
+	}
+
+	int64 GetAllocatedSize() const;
+
+public:
+	// Conservative range of the surface heights over Bounds
+	// Exact for cells fully inside Bounds, cells partially inside Bounds contribute their full range
+	FFloatInterval GetHeightRange(const FVoxelBox2D& Bounds) const;
+
+	EVoxelHeightmapClassification Classify(const FVoxelBox& Box) const;
+
+	FORCEINLINE bool Intersects(const FVoxelBox& Box) const
+	{
+		return Classify(Box) == EVoxelHeightmapClassification::Intersecting;
+	}
+
+	// Rays outside of the heightmap footprint hit the surface extruded from the edges
+	bool RayIntersection(
+		const FVector& RayOrigin,
+		const FVector& RayDirection,
+		double MaxTime,
+		double& OutTime) const;
+
+private:
+	FIntPoint Size = FIntPoint::ZeroValue;
+	TVoxelArray<float> Heights;
+	// Levels[0] has one cell per 2x2 samples, last level has a single cell
+	TVoxelArray<FLevel> Levels;
+
+	// Height of the surface at Position clamped to the closest edge
+	double GetEdgeHeight(const FVector2D& Position) const;
+
+	// First hit in [StartTime, EndTime], assuming the ray is outside of the footprint during that interval
+	bool RayIntersectionOutside(
+		const FVector& RayOrigin,
+		const FVector& RayDirection,
+		double StartTime,
+		double EndTime,
+		double& OutTime) const;
+
+	FORCEINLINE FVoxelBox2D GetCellBounds(
+		const int32 LevelIndex,
+		const int32 X,
+		const int32 Y) const
+	{
+		const FIntPoint CellsSize = Levels[0].Size;
+
+		return FVoxelBox2D(
+			FVector2D(
+				X << LevelIndex,
+				Y << LevelIndex),
+			FVector2D(
+				FMath::Min((X + 1) << LevelIndex, CellsSize.X),
+				FMath::Min((Y + 1) << LevelIndex, CellsSize.Y)));
+	}
+};
\ No newline at end of file
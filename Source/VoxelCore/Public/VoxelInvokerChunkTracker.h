@@ -0,0 +1,104 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+// Stateful version of FVoxelUtilities::ComputeInvokerChunks
+// Instead of rebuilding the full chunk set every update, only the shell between the old and the new sphere of each moved invoker is rasterized,
+// and the caller gets the chunks that were added & removed since the last update
+class VOXELCORE_API FVoxelInvokerChunkTracker
+{
+public:
+	struct FDelta
+	{
+		TVoxelArray<FIntVector> AddedChunks;
+		TVoxelArray<FIntVector> RemovedChunks;
+
+		FORCEINLINE bool IsEmpty() const
+		{
+			return
+				AddedChunks.Num() == 0 &&
+				RemovedChunks.Num() == 0;
+		}
+	};
+
+	FVoxelInvokerChunkTracker(
+		const FTransform& LocalToWorld,
+		double ChunkSize,
+		int32 MaxNumChunks);
+
+	// Returns false if the new invokers would cover more than MaxNumChunks
+	// In that case the tracker is left untouched and OutDelta is empty
+	bool Update(
+		TConstVoxelArrayView<FSphere> Invokers,
+		FDelta& OutDelta);
+
+	// Clears all invokers, all tracked chunks will be in OutDelta.RemovedChunks
+	void Reset(FDelta& OutDelta);
+
+	FORCEINLINE int32 NumChunks() const
+	{
+		return ChunkToRefCount.Num();
+	}
+	FORCEINLINE bool ContainsChunk(const FIntVector& Chunk) const
+	{
+		return ChunkToRefCount.Contains(Chunk);
+	}
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return
+			ChunkToRefCount.GetAllocatedSize() +
+			ChunkedInvokers.GetAllocatedSize();
+	}
+
+	TVoxelSet<FIntVector> GetChunks() const;
+
+public:
+	struct FChunkedInvoker
+	{
+		FVector Center = FVector::ZeroVector;
+		double RadiusInChunks = 0;
+
+		FORCEINLINE bool operator==(const FChunkedInvoker& Other) const
+		{
+			return
+				Center == Other.Center &&
+				RadiusInChunks == Other.RadiusInChunks;
+		}
+
+		// Z range of the chunks touched by this invoker in the column X Y
+		// Returns false if the column is empty
+		bool GetColumn(
+			int32 X,
+			int32 Y,
+			int32& OutMinZ,
+			int32& OutMaxZ) const;
+
+		FIntVector GetMin() const;
+		FIntVector GetMax() const;
+	};
+
+	// Removes invokers fully contained in another one. Invokers are swept along X so only
+	// invokers that can geometrically contain each other are tested against each other
+	static void RemoveContainedInvokers(TVoxelArray<FChunkedInvoker>& Invokers);
+
+private:
+	const FTransform LocalToWorld;
+	const double ChunkSize;
+	const int32 MaxNumChunks;
+
+	TVoxelArray<FChunkedInvoker> ChunkedInvokers;
+	// Number of invokers touching each chunk
+	TVoxelMap<FIntVector, int32> ChunkToRefCount;
+
+	TVoxelArray<FChunkedInvoker> MakeChunkedInvokers(TConstVoxelArrayView<FSphere> Invokers) const;
+
+	// Chunks in New but not in Old go in OutAdded, chunks in Old but not in New go in OutRemoved
+	// Either can be null for a pure add/remove
+	static void RasterizeShell(
+		const FChunkedInvoker* OldInvoker,
+		const FChunkedInvoker* NewInvoker,
+		TVoxelArray<FIntVector>& OutAdded,
+		TVoxelArray<FIntVector>& OutRemoved);
+};
\ No newline at end of file
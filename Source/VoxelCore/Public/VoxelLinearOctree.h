@@ -0,0 +1,649 @@
+﻿// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+#include "VoxelFastOctree.h"
+
+// Pointerless octree: nodes are stored in a single array sorted by key, in depth-first pre-order
+// Key = (Morton code of the node min corner at height 0) << 5 | Level, root being level 0
+// The subtree of a node is the contiguous key interval [Key, GetSubtreeEnd(Key))
+// Same semantics as TVoxelFastOctree: root is centered on 0, nodes of height 0 are single voxels
+template<typename NodeType = FVoxelFastOctreeNodeDummy>
+class TVoxelLinearOctree
+{
+public:
+	class FNodeRef
+	{
+	public:
+		FORCEINLINE int32 GetHeight() const
+		{
+			return Height;
+		}
+		FORCEINLINE int32 GetSize() const
+		{
+			return 1 << Height;
+		}
+		FORCEINLINE FVoxelIntBox GetBounds() const
+		{
+			const int32 Size = 1 << Height;
+			return FVoxelIntBox(
+				Center - FVoxelUtilities::DivideFloor_Positive(Size, 2),
+				Center + FVoxelUtilities::DivideCeil_Positive(Size, 2));
+		}
+		FORCEINLINE FIntVector GetCenter() const
+		{
+			return Center;
+		}
+
+		FORCEINLINE FIntVector GetMin() const
+		{
+			return GetBounds().Min;
+		}
+		FORCEINLINE FIntVector GetMax() const
+		{
+			return GetBounds().Max;
+		}
+
+		FORCEINLINE bool IsRoot() const
+		{
+			return Height > 0 && Center == FIntVector(ForceInit);
+		}
+		FORCEINLINE uint64 GetKey() const
+		{
+			return Key;
+		}
+
+		static constexpr int32 InvalidIndex = (1 << 24) - 1;
+
+	private:
+		uint64 Key = 0;
+		uint32 Index : 24;
+		uint32 Height : 8;
+		// If Height = 0 this is the bottom corner of the node
+		FIntVector Center;
+
+		FORCEINLINE FNodeRef(
+			const uint64 Key,
+			const int32 Index,
+			const int32 Height,
+			const FIntVector& Center)
+			: Key(Key)
+			, Index(Index)
+			, Height(Height)
+			, Center(Center)
+		{
+			checkVoxelSlow(0 <= Index && Index < (1 << 24));
+			checkVoxelSlow(0 <= Height && Height < 256);
+		}
+
+		friend TVoxelLinearOctree;
+	};
+	checkStatic(sizeof(FNodeRef) == 24);
+
+	static constexpr bool bHasNodes = !std::is_same_v<NodeType, FVoxelFastOctreeNodeDummy>;
+
+	static constexpr int32 LevelBits = 5;
+	static constexpr uint64 LevelMask = (1 << LevelBits) - 1;
+
+	// If Depth == 1 we only have a single root node, which breaks IsRoot
+	static constexpr int32 MinDepth = 2;
+	// 3 * 19 Morton bits + 5 level bits
+	static constexpr int32 MaxDepth = 20;
+
+public:
+	const int32 Depth;
+
+	explicit TVoxelLinearOctree(const int32 Depth)
+		: Depth(FMath::Clamp(Depth, MinDepth, MaxDepth))
+	{
+		ensure(MinDepth <= Depth && Depth <= MaxDepth);
+
+		Keys.Add(0);
+
+		if (bHasNodes)
+		{
+			Nodes.Add({});
+		}
+	}
+
+public:
+	void MoveFrom(TVoxelLinearOctree& Other)
+	{
+		ensure(Depth == Other.Depth);
+		Keys = MoveTemp(Other.Keys);
+		Nodes = MoveTemp(Other.Nodes);
+	}
+	void CopyFrom(const TVoxelLinearOctree& Other)
+	{
+		ensure(Depth == Other.Depth);
+		Keys = Other.Keys;
+		Nodes = Other.Nodes;
+	}
+
+	// Build the tree from keys sorted in ascending order
+	// Missing ancestors are created, duplicates are ignored
+	void Initialize(const TConstVoxelArrayView<uint64> SortedKeys)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(SortedKeys.Num(), 1024);
+		checkVoxelSlow(Algo::IsSorted(SortedKeys));
+
+		Keys.Reset();
+		Keys.Reserve(SortedKeys.Num() + Depth);
+		Keys.Add(0);
+
+		// Ancestors of the last key added, root first
+		TVoxelStaticArray<uint64, MaxDepth> Stack{ NoInit };
+		int32 StackNum = 1;
+		Stack[0] = 0;
+
+		for (const uint64 Key : SortedKeys)
+		{
+			if (!ensureVoxelSlow(GetLevel(Key) < Depth) ||
+				Key == Keys.Last())
+			{
+				continue;
+			}
+
+			while (!IsAncestorOrSelf(Stack[StackNum - 1], Key))
+			{
+				StackNum--;
+				checkVoxelSlow(StackNum > 0);
+			}
+
+			// Add the missing ancestors: their keys are between the last key added and Key
+			for (int32 Level = GetLevel(Stack[StackNum - 1]) + 1; Level <= GetLevel(Key); Level++)
+			{
+				const uint64 AncestorKey = MakeKey(GetMorton(Key) & ~GetMortonMask(GetHeight(Level)), Level);
+				checkVoxelSlow(Keys.Last() < AncestorKey);
+
+				Keys.Add(AncestorKey);
+				Stack[StackNum++] = AncestorKey;
+			}
+		}
+
+		if (bHasNodes)
+		{
+			Nodes.Reset();
+			Nodes.SetNum(Keys.Num());
+		}
+	}
+
+public:
+	FORCEINLINE int32 NumNodes() const
+	{
+		return Keys.Num();
+	}
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return Keys.GetAllocatedSize() + Nodes.GetAllocatedSize();
+	}
+	FORCEINLINE FNodeRef Root() const
+	{
+		return MakeNodeRef(0, 0);
+	}
+	FORCEINLINE TConstVoxelArrayView<uint64> GetKeys() const
+	{
+		return Keys;
+	}
+
+public:
+	FORCEINLINE NodeType& GetNode(const FNodeRef NodeRef)
+	{
+		checkStatic(bHasNodes);
+		return Nodes[NodeRef.Index];
+	}
+	FORCEINLINE const NodeType& GetNode(const FNodeRef NodeRef) const
+	{
+		checkStatic(bHasNodes);
+		return Nodes[NodeRef.Index];
+	}
+
+public:
+	FORCEINLINE static int32 GetLevel(const uint64 Key)
+	{
+		return Key & LevelMask;
+	}
+	// Level counts from the root (root is level 0), height counts from the voxels (voxels are height 0)
+	// Depth - 1 - X converts both ways
+	FORCEINLINE int32 GetHeight(const int32 Level) const
+	{
+		return Depth - 1 - Level;
+	}
+	FORCEINLINE static uint64 GetMorton(const uint64 Key)
+	{
+		return Key >> LevelBits;
+	}
+	FORCEINLINE static uint64 GetMortonMask(const int32 Height)
+	{
+		return (uint64(1) << (3 * Height)) - 1;
+	}
+	FORCEINLINE static uint64 MakeKey(const uint64 Morton, const int32 Level)
+	{
+		checkVoxelSlow(0 <= Level && Level <= int32(LevelMask));
+		return (Morton << LevelBits) | uint64(Level);
+	}
+
+	// Key of the node containing Position whose height is Height, counted from the voxels: 0 returns the voxel node, Depth - 1 the root
+	// Not a level: see GetHeight
+	FORCEINLINE uint64 GetNodeKey(const int32 Height, const FIntVector& Position) const
+	{
+		checkVoxelSlow(0 <= Height && Height < Depth);
+
+		const FIntVector LocalPosition = Position + GetRootOffset();
+		checkVoxelSlow(0 <= LocalPosition.GetMin() && LocalPosition.GetMax() < (1 << (Depth - 1)));
+
+		const uint64 Morton = FVoxelUtilities::MortonEncode3D(LocalPosition);
+		const int32 Level = Depth - 1 - Height;
+		return MakeKey(Morton & ~GetMortonMask(Height), Level);
+	}
+	// Exclusive end of the key interval of the subtree of Key
+	FORCEINLINE uint64 GetSubtreeEnd(const uint64 Key) const
+	{
+		const int32 Height = GetHeight(GetLevel(Key));
+		return (GetMorton(Key) + (uint64(1) << (3 * Height))) << LevelBits;
+	}
+	FORCEINLINE bool IsAncestorOrSelf(const uint64 Ancestor, const uint64 Key) const
+	{
+		return
+			Ancestor <= Key &&
+			Key < GetSubtreeEnd(Ancestor);
+	}
+
+public:
+	FORCEINLINE bool IsValid(const FNodeRef NodeRef) const
+	{
+		return
+			NodeRef.Index != FNodeRef::InvalidIndex &&
+			Keys.IsValidIndex(NodeRef.Index) &&
+			Keys[NodeRef.Index] == NodeRef.Key;
+	}
+	FORCEINLINE bool HasAnyChildren(const FNodeRef NodeRef) const
+	{
+		checkVoxelSlow(IsValid(NodeRef));
+
+		return
+			Keys.IsValidIndex(NodeRef.Index + 1) &&
+			Keys[NodeRef.Index + 1] < GetSubtreeEnd(NodeRef.Key);
+	}
+	FORCEINLINE int32 GetSubtreeNum(const FNodeRef NodeRef) const
+	{
+		checkVoxelSlow(IsValid(NodeRef));
+		return LowerBound(GetSubtreeEnd(NodeRef.Key), NodeRef.Index + 1) - NodeRef.Index;
+	}
+
+	bool FindNode(const uint64 Key, FNodeRef& OutNodeRef) const
+	{
+		const int32 Index = LowerBound(Key, 0);
+		if (!Keys.IsValidIndex(Index) ||
+			Keys[Index] != Key)
+		{
+			return false;
+		}
+
+		OutNodeRef = MakeNodeRef(Key, Index);
+		return true;
+	}
+	// Find the deepest node containing Position
+	FNodeRef FindLeaf(const FIntVector& Position) const
+	{
+		FNodeRef NodeRef = Root();
+		while (
+			NodeRef.Height > 0 &&
+			TryGetChild(NodeRef, Position, NodeRef))
+		{
+		}
+		return NodeRef;
+	}
+
+	template<typename VectorType>
+	FORCEINLINE bool TryGetChild(const FNodeRef NodeRef, const VectorType Position, FNodeRef& OutChildNodeRef) const
+	{
+		checkVoxelSlow(NodeRef.Height > 0);
+
+		const int32 Child =
+			1 * (Position.X >= NodeRef.Center.X) +
+			2 * (Position.Y >= NodeRef.Center.Y) +
+			4 * (Position.Z >= NodeRef.Center.Z);
+
+		const uint64 ChildKey = GetChildKey(NodeRef.Key, Child);
+
+		// Children are right after their parent, no need to search the whole array
+		const int32 Index = LowerBound(ChildKey, NodeRef.Index + 1);
+		if (!Keys.IsValidIndex(Index) ||
+			Keys[Index] != ChildKey)
+		{
+			return false;
+		}
+
+		OutChildNodeRef = MakeNodeRef(ChildKey, Index);
+		return true;
+	}
+
+	// Same height neighbor, computed by adding Direction * Size to the key with dilated integer arithmetic
+	// Returns false if the neighbor is outside the root or isn't in the tree
+	bool TryGetNeighbor(const FNodeRef NodeRef, const FIntVector& Direction, FNodeRef& OutNeighborNodeRef) const
+	{
+		uint64 NeighborKey;
+		if (!TryGetNeighborKey(NodeRef.Key, Direction, NeighborKey))
+		{
+			return false;
+		}
+
+		return FindNode(NeighborKey, OutNeighborNodeRef);
+	}
+	bool TryGetNeighborKey(const uint64 Key, const FIntVector& Direction, uint64& OutNeighborKey) const
+	{
+		constexpr uint64 MaskX = 0x1249249249249249;
+		constexpr uint64 MaskY = MaskX << 1;
+		constexpr uint64 MaskZ = MaskX << 2;
+
+		const int32 Height = GetHeight(GetLevel(Key));
+		const uint64 TreeMask = GetMortonMask(Depth - 1);
+
+		const uint64 Morton = GetMorton(Key);
+		uint64 NewMorton = 0;
+
+		const auto AddAxis = [&](const uint64 AxisMask, const int32 AxisShift, const int32 Delta)
+		{
+			const uint64 Mask = AxisMask & TreeMask;
+			const uint64 Value = Morton & Mask;
+
+			if (Delta == 0)
+			{
+				NewMorton |= Value;
+				return true;
+			}
+
+			// The tree is 2^(Depth - 1) voxels wide: anything further is outside the root
+			// This also keeps the offset below the 21 bits MortonDilate3D encodes
+			const int64 Offset = FMath::Abs(int64(Delta)) << Height;
+			if (Offset >= (int64(1) << (Depth - 1)))
+			{
+				return false;
+			}
+			checkVoxelSlow(Offset < (1 << 21));
+
+			const uint64 Dilated = FVoxelUtilities::MortonDilate3D(uint32(Offset)) << AxisShift;
+
+			uint64 NewValue;
+			if (Delta > 0)
+			{
+				// Fill the holes with 1 so that carries propagate
+				NewValue = ((Value | ~Mask) + Dilated) & Mask;
+
+				if (NewValue <= Value)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				NewValue = (Value - Dilated) & Mask;
+
+				if (NewValue >= Value)
+				{
+					return false;
+				}
+			}
+
+			NewMorton |= NewValue;
+			return true;
+		};
+
+		if (!AddAxis(MaskX, 0, Direction.X) ||
+			!AddAxis(MaskY, 1, Direction.Y) ||
+			!AddAxis(MaskZ, 2, Direction.Z))
+		{
+			return false;
+		}
+
+		OutNeighborKey = MakeKey(NewMorton, GetLevel(Key));
+		return true;
+	}
+
+public:
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+		LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+	)
+	FORCENOINLINE void Traverse(const FNodeRef InNodeRef, LambdaType Lambda) const
+	{
+		checkVoxelSlow(IsValid(InNodeRef));
+
+		// Subtree is contiguous, iterate it linearly
+		const uint64 EndKey = GetSubtreeEnd(InNodeRef.Key);
+
+		int32 Index = InNodeRef.Index;
+		while (Index < Keys.Num() && Keys[Index] < EndKey)
+		{
+			const FNodeRef NodeRef = MakeNodeRef(Keys[Index], Index);
+
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(NodeRef);
+			}
+			else
+			{
+				switch (Lambda(NodeRef))
+				{
+				default: VOXEL_ASSUME(false);
+				case EVoxelIterateTree::Continue: break;
+				case EVoxelIterateTree::SkipChildren:
+				{
+					Index = LowerBound(GetSubtreeEnd(NodeRef.Key), Index + 1);
+					continue;
+				}
+				case EVoxelIterateTree::Stop: return;
+				}
+			}
+
+			Index++;
+		}
+	}
+
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+		LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+	)
+	FORCEINLINE void Traverse(LambdaType Lambda) const
+	{
+		this->Traverse(Root(), Lambda);
+	}
+
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		(std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterateTree>) &&
+		LambdaHasSignature_V<LambdaType, ReturnType(const FNodeRef&)>
+	)
+	FORCENOINLINE void TraverseBounds(const FVoxelIntBox& Bounds, LambdaType Lambda) const
+	{
+		int32 Index = 0;
+		while (Index < Keys.Num())
+		{
+			const FNodeRef NodeRef = MakeNodeRef(Keys[Index], Index);
+			if (!NodeRef.GetBounds().Intersects(Bounds))
+			{
+				// Skip the whole key interval of the subtree
+				Index = LowerBound(GetSubtreeEnd(NodeRef.Key), Index + 1);
+				continue;
+			}
+
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(NodeRef);
+			}
+			else
+			{
+				switch (Lambda(NodeRef))
+				{
+				default: VOXEL_ASSUME(false);
+				case EVoxelIterateTree::Continue: break;
+				case EVoxelIterateTree::SkipChildren:
+				{
+					Index = LowerBound(GetSubtreeEnd(NodeRef.Key), Index + 1);
+					continue;
+				}
+				case EVoxelIterateTree::Stop: return;
+				}
+			}
+
+			Index++;
+		}
+	}
+
+public:
+	// Same semantics as TVoxelFastOctree::Update
+	// The key array is rebuilt in a single linear pass: node indices are not stable across updates
+	template<typename PredicateType, typename AddNodeType, typename RemoveNodeType>
+	void Update(
+		const PredicateType& Predicate,
+		const AddNodeType& AddNode,
+		const RemoveNodeType& RemoveNode)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Keys.Num(), 1024);
+
+		TVoxelArray<uint64> OldKeys = MoveTemp(Keys);
+		TVoxelArray<NodeType> OldNodes = MoveTemp(Nodes);
+
+		Keys.Reserve(OldKeys.Num());
+		if (bHasNodes)
+		{
+			Nodes.Reserve(OldNodes.Num());
+		}
+
+		Keys.Add(OldKeys[0]);
+		if (bHasNodes)
+		{
+			Nodes.Add(MoveTemp(OldNodes[0]));
+		}
+
+		int32 OldIndex = 1;
+		this->UpdateImpl(0, OldKeys, OldNodes, OldIndex, Predicate, AddNode, RemoveNode);
+		check(OldIndex == OldKeys.Num());
+	}
+
+private:
+	TVoxelArray<uint64> Keys;
+	TVoxelArray<NodeType> Nodes;
+
+	FORCEINLINE FIntVector GetRootOffset() const
+	{
+		return FIntVector(1 << (Depth - 2));
+	}
+	FORCEINLINE FNodeRef MakeNodeRef(const uint64 Key, const int32 Index) const
+	{
+		const int32 Height = GetHeight(GetLevel(Key));
+		const FIntVector Min = FVoxelUtilities::MortonDecode3D(GetMorton(Key)) - GetRootOffset();
+		return FNodeRef(Key, Index, Height, Min + FIntVector(FVoxelUtilities::DivideFloor_Positive(1 << Height, 2)));
+	}
+	FORCEINLINE uint64 GetChildKey(const uint64 Key, const int32 Child) const
+	{
+		const int32 Level = GetLevel(Key);
+		const int32 ChildHeight = GetHeight(Level) - 1;
+		checkVoxelSlow(ChildHeight >= 0);
+
+		return MakeKey(GetMorton(Key) + (uint64(Child) << (3 * ChildHeight)), Level + 1);
+	}
+	FORCEINLINE int32 LowerBound(const uint64 Key, const int32 StartIndex) const
+	{
+		checkVoxelSlow(0 <= StartIndex && StartIndex <= Keys.Num());
+
+		int32 First = StartIndex;
+		int32 Count = Keys.Num() - StartIndex;
+		while (Count > 0)
+		{
+			const int32 Step = Count / 2;
+			if (Keys[First + Step] < Key)
+			{
+				First += Step + 1;
+				Count -= Step + 1;
+			}
+			else
+			{
+				Count = Step;
+			}
+		}
+		return First;
+	}
+
+	template<typename PredicateType, typename AddNodeType, typename RemoveNodeType>
+	void UpdateImpl(
+		const int32 NewIndex,
+		TVoxelArray<uint64>& OldKeys,
+		TVoxelArray<NodeType>& OldNodes,
+		int32& OldIndex,
+		const PredicateType& Predicate,
+		const AddNodeType& AddNode,
+		const RemoveNodeType& RemoveNode)
+	{
+		const uint64 Key = Keys[NewIndex];
+		if (GetHeight(GetLevel(Key)) == 0)
+		{
+			return;
+		}
+
+		for (int32 Child = 0; Child < 8; Child++)
+		{
+			const uint64 ChildKey = GetChildKey(Key, Child);
+
+			const bool bExists =
+				OldKeys.IsValidIndex(OldIndex) &&
+				OldKeys[OldIndex] == ChildKey;
+
+			if (!bExists)
+			{
+				const FNodeRef DummyChildNodeRef = INLINE_LAMBDA
+				{
+					FNodeRef Result = MakeNodeRef(ChildKey, 0);
+					Result.Index = FNodeRef::InvalidIndex;
+					return Result;
+				};
+
+				if (!Predicate(DummyChildNodeRef))
+				{
+					continue;
+				}
+
+				const int32 ChildIndex = Keys.Add(ChildKey);
+				if (bHasNodes)
+				{
+					Nodes.Emplace();
+				}
+
+				AddNode(MakeNodeRef(ChildKey, ChildIndex));
+				this->UpdateImpl(ChildIndex, OldKeys, OldNodes, OldIndex, Predicate, AddNode, RemoveNode);
+				continue;
+			}
+
+			const int32 ChildIndex = Keys.Add(ChildKey);
+			if (bHasNodes)
+			{
+				Nodes.Add(MoveTemp(OldNodes[OldIndex]));
+			}
+			OldIndex++;
+
+			this->UpdateImpl(ChildIndex, OldKeys, OldNodes, OldIndex, Predicate, AddNode, RemoveNode);
+
+			const FNodeRef ChildNodeRef = MakeNodeRef(ChildKey, ChildIndex);
+			if (Predicate(ChildNodeRef))
+			{
+				continue;
+			}
+
+			ensureVoxelSlowNoSideEffects(ChildIndex == Keys.Num() - 1);
+			RemoveNode(ChildNodeRef);
+
+			Keys.SetNum(ChildIndex, EAllowShrinking::No);
+			if (bHasNodes)
+			{
+				Nodes.SetNum(ChildIndex, EAllowShrinking::No);
+			}
+		}
+	}
+};
@@ -36,6 +36,7 @@
 #include "VoxelCoreMinimal.h"
 
 #include "VoxelMinimal/VoxelArchive.h"
+#include "VoxelMinimal/VoxelArena.h"
 #include "VoxelMinimal/VoxelAtomic.h"
 #include "VoxelMinimal/VoxelAutoFactoryInterface.h"
 #include "VoxelMinimal/VoxelAxis.h"
@@ -46,23 +47,30 @@
 #include "VoxelMinimal/VoxelColor3.h"
 #include "VoxelMinimal/VoxelCriticalSection.h"
 #include "VoxelMinimal/VoxelSharedCriticalSection.h"
+#include "VoxelMinimal/VoxelShardedSharedCriticalSection.h"
 #include "VoxelMinimal/VoxelDebugDrawer.h"
 #include "VoxelMinimal/VoxelDelegateHelpers.h"
 #include "VoxelMinimal/VoxelDereferencingIterator.h"
 #include "VoxelMinimal/VoxelDuplicateTransient.h"
+#include "VoxelMinimal/VoxelEpoch.h"
+#include "VoxelMinimal/VoxelFrustum.h"
 #include "VoxelMinimal/VoxelFuture.h"
 #include "VoxelMinimal/VoxelGlobalShader.h"
 #include "VoxelMinimal/VoxelGuid.h"
 #include "VoxelMinimal/VoxelHash.h"
+#include "VoxelMinimal/VoxelHybridCriticalSection.h"
 #include "VoxelMinimal/VoxelInstancedStruct.h"
 #include "VoxelMinimal/VoxelIntBox.h"
 #include "VoxelMinimal/VoxelIntBox2D.h"
 #include "VoxelMinimal/VoxelISPC.h"
 #include "VoxelMinimal/VoxelIterate.h"
+#include "VoxelMinimal/VoxelLockProfiler.h"
+#include "VoxelMinimal/VoxelMappedFile.h"
 #include "VoxelMinimal/VoxelMaterialRef.h"
 #include "VoxelMinimal/VoxelMessageFactory.h"
 #include "VoxelMinimal/VoxelMessageManager.h"
 #include "VoxelMinimal/VoxelObjectHelpers.h"
+#include "VoxelMinimal/VoxelObjectPool.h"
 #include "VoxelMinimal/VoxelObjectPtr.h"
 #include "VoxelMinimal/VoxelOctahedron.h"
 #include "VoxelMinimal/VoxelOptional.h"
@@ -84,11 +92,18 @@
 #include "VoxelMinimal/Containers/VoxelBitArray.h"
 #include "VoxelMinimal/Containers/VoxelChunkedArray.h"
 #include "VoxelMinimal/Containers/VoxelChunkedSparseArray.h"
+#include "VoxelMinimal/Containers/VoxelConcurrentChunkedArray.h"
+#include "VoxelMinimal/Containers/VoxelConcurrentMap.h"
+#include "VoxelMinimal/Containers/VoxelHierarchicalBitArray.h"
 #include "VoxelMinimal/Containers/VoxelMap.h"
+#include "VoxelMinimal/Containers/VoxelPaletteArray.h"
+#include "VoxelMinimal/Containers/VoxelPersistentMap.h"
 #include "VoxelMinimal/Containers/VoxelSet.h"
+#include "VoxelMinimal/Containers/VoxelSoAArray.h"
 #include "VoxelMinimal/Containers/VoxelSparseArray.h"
 #include "VoxelMinimal/Containers/VoxelStaticArray.h"
 #include "VoxelMinimal/Containers/VoxelStaticBitArray.h"
+#include "VoxelMinimal/Containers/VoxelSwissTable.h"
 
 #include "VoxelMinimal/Utilities/VoxelArrayUtilities.h"
 #include "VoxelMinimal/Utilities/VoxelDistanceFieldUtilities.h"
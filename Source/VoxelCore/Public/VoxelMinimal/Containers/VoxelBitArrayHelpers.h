@@ -452,7 +452,6 @@ public:
 
 	static void SetRange(uint32* RESTRICT Data, int32 Index, int32 Num, bool bValue);
 
-private:
 	template<typename WordType, typename LambdaType>
 	FORCEINLINE static EVoxelIterate ForAllSetBitsInWord(WordType Word, const int32 WordIndex, const int32 Num, LambdaType Lambda)
 	{
@@ -522,7 +521,6 @@ private:
 		return EVoxelIterate::Continue;
 	}
 
-public:
 	template<
 		typename LambdaType,
 		typename ReturnType = LambdaReturnType_T<LambdaType>,
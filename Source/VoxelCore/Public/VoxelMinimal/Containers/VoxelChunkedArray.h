@@ -781,6 +781,9 @@ private:
 	int32 NumChunks = 0;
 	FChunkArray ChunkArray;
 
+	template<typename, int32>
+	friend class TVoxelConcurrentChunkedArray;
+
 	FORCEINLINE int32 AddUninitializedImpl()
 	{
 		if (ArrayNum % NumPerChunk == 0)
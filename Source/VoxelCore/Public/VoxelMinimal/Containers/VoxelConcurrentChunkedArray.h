@@ -0,0 +1,362 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/Containers/VoxelChunkedArray.h"
+
+// Chunked array that many threads can append to at once without locking
+// Indices are reserved with a single atomic add, chunks are allocated by whichever thread needs them first
+// Elements never move: a range returned by AddUninitialized can be written while other threads keep appending
+// Reading elements added by other threads (Num, operator[], ForeachView(Lambda), MoveToChunkedArray) is only valid
+// once all producers are done and synchronized with the reader, eg after the ParallelFor adding them returned
+template<typename Type, int32 MaxBytesPerChunk = 1 << 14>
+class TVoxelConcurrentChunkedArray
+{
+public:
+	using FChunkedArray = TVoxelChunkedArray<Type, MaxBytesPerChunk>;
+	using FChunk = typename FChunkedArray::FChunk;
+
+	static constexpr int32 NumPerChunkLog2 = FChunkedArray::NumPerChunkLog2;
+	static constexpr int32 NumPerChunk = FChunkedArray::NumPerChunk;
+
+	TVoxelConcurrentChunkedArray() = default;
+	UE_NONCOPYABLE(TVoxelConcurrentChunkedArray);
+
+	FORCEINLINE ~TVoxelConcurrentChunkedArray()
+	{
+		Empty();
+	}
+
+public:
+	// Not thread-safe
+	void Empty()
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Num(), 4 * NumPerChunk);
+
+		if constexpr (!std::is_trivially_destructible_v<Type>)
+		{
+			this->ForeachView([&](const int32 ViewIndex, const TVoxelArrayView<Type> View)
+			{
+				for (Type& Value : View)
+				{
+					Value.~Type();
+				}
+			});
+		}
+
+		ArrayNum.Set(0);
+
+		for (int32 BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+		{
+			FChunkPtr* Block = Blocks[BlockIndex].Set_ReturnOld(nullptr);
+			if (!Block)
+			{
+				continue;
+			}
+
+			for (int32 Index = 0; Index < GetBlockSize(BlockIndex); Index++)
+			{
+				delete Block[Index].Get();
+			}
+			delete[] Block;
+		}
+	}
+
+	// Not thread-safe: all producers must be done
+	// Hands the chunks over to a regular chunked array, no element is copied
+	FChunkedArray MoveToChunkedArray()
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Num(), 4 * NumPerChunk);
+
+		const int32 NewNum = Num();
+		const int32 NewNumChunks = FVoxelUtilities::DivideCeil_Positive(NewNum, NumPerChunk);
+
+		FChunkedArray Result;
+		Result.ChunkArray.Reserve(NewNumChunks);
+
+		for (int32 ChunkIndex = 0; ChunkIndex < NewNumChunks; ChunkIndex++)
+		{
+			FChunk* Chunk = GetChunkPtr(ChunkIndex).Set_ReturnOld(nullptr);
+			checkVoxelSlow(Chunk);
+			Result.ChunkArray.Add(TUniquePtr<FChunk>(Chunk));
+		}
+
+		Result.ArrayNum = NewNum;
+		Result.NumChunks = NewNumChunks;
+
+		// Elements are now owned by Result, only free the chunk tables
+		ArrayNum.Set(0);
+		Empty();
+
+		return Result;
+	}
+
+	FORCEINLINE int32 Num() const
+	{
+		return ArrayNum.Get();
+	}
+	FORCEINLINE bool IsValidIndex(const int32 Index) const
+	{
+		return 0 <= Index && Index < Num();
+	}
+	int64 GetAllocatedSize() const
+	{
+		int64 AllocatedSize = 0;
+		for (int32 BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+		{
+			const FChunkPtr* Block = Blocks[BlockIndex].Get();
+			if (!Block)
+			{
+				continue;
+			}
+
+			AllocatedSize += GetBlockSize(BlockIndex) * sizeof(FChunkPtr);
+
+			for (int32 Index = 0; Index < GetBlockSize(BlockIndex); Index++)
+			{
+				if (Block[Index].Get(std::memory_order_relaxed))
+				{
+					AllocatedSize += sizeof(FChunk);
+				}
+			}
+		}
+		return AllocatedSize;
+	}
+
+public:
+	// Thread-safe
+	// The returned range is owned by the caller until producers are synchronized with readers
+	// Fill it with ForeachView(Index, Count, ...): ranges fitting in a chunk are a single contiguous view
+	FORCEINLINE int32 AddUninitialized(const int32 Count)
+	{
+		checkStatic(std::is_trivially_destructible_v<Type>);
+		return AddUninitializedImpl(Count);
+	}
+	FORCEINLINE int32 AddZeroed(const int32 Count)
+	{
+		checkStatic(std::is_trivially_destructible_v<Type>);
+
+		const int32 Index = AddUninitializedImpl(Count);
+
+		this->ForeachView(
+			Index,
+			Count,
+			[&](const int32 ViewIndex, const TVoxelArrayView<Type> View)
+			{
+				FVoxelUtilities::Memzero(View);
+			});
+
+		return Index;
+	}
+	int32 Append(const TConstVoxelArrayView<Type> Other)
+	{
+		const int32 StartIndex = AddUninitializedImpl(Other.Num());
+
+		this->ForeachView(
+			StartIndex,
+			Other.Num(),
+			[&](const int32 ViewIndex, const TVoxelArrayView<Type> View)
+			{
+				if constexpr (std::is_trivially_destructible_v<Type>)
+				{
+					FVoxelUtilities::Memcpy(
+						View,
+						Other.Slice(ViewIndex - StartIndex, View.Num()));
+				}
+				else
+				{
+					for (int32 Index = 0; Index < View.Num(); Index++)
+					{
+						new (&View[Index]) Type(Other[ViewIndex - StartIndex + Index]);
+					}
+				}
+			});
+
+		return StartIndex;
+	}
+
+	FORCEINLINE int32 Add(const Type& Value)
+	{
+		const int32 Index = AddUninitializedImpl(1);
+		new (&GetElement(Index)) Type(Value);
+		return Index;
+	}
+	FORCEINLINE int32 Add(Type&& Value)
+	{
+		const int32 Index = AddUninitializedImpl(1);
+		new (&GetElement(Index)) Type(MoveTemp(Value));
+		return Index;
+	}
+	template<typename... ArgsType>
+	FORCEINLINE int32 Emplace(ArgsType&&... Args)
+	{
+		const int32 Index = AddUninitializedImpl(1);
+		new (&GetElement(Index)) Type(Forward<ArgsType>(Args)...);
+		return Index;
+	}
+
+public:
+	// Thread-safe as long as [StartIndex, StartIndex + Count) was returned by an add on this thread,
+	// or producers are synchronized with this thread
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(int32, TVoxelArrayView<Type>)>
+	FORCEINLINE void ForeachView(
+		const int32 StartIndex,
+		const int32 Count,
+		LambdaType Lambda)
+	{
+		const int32 EndIndex = StartIndex + Count;
+		int32 Index = StartIndex;
+		while (Index < EndIndex)
+		{
+			const int32 ChunkIndex = FVoxelUtilities::GetChunkIndex<NumPerChunk>(Index);
+			const int32 ChunkOffset = FVoxelUtilities::GetChunkOffset<NumPerChunk>(Index);
+			const int32 NumInChunk = FMath::Min(NumPerChunk - ChunkOffset, EndIndex - Index);
+
+			Lambda(Index, GetChunkView(ChunkIndex).Slice(ChunkOffset, NumInChunk));
+
+			Index += NumInChunk;
+		}
+		checkVoxelSlow(Index == EndIndex);
+	}
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(int32, TConstVoxelArrayView<Type>)>
+	FORCEINLINE void ForeachView(
+		const int32 StartIndex,
+		const int32 Count,
+		LambdaType Lambda) const
+	{
+		ConstCast(this)->ForeachView(
+			StartIndex,
+			Count,
+			[&](const int32 ViewIndex, const TVoxelArrayView<Type> View)
+			{
+				Lambda(ViewIndex, TConstVoxelArrayView<Type>(View));
+			});
+	}
+
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(int32, TVoxelArrayView<Type>)>
+	FORCEINLINE void ForeachView(LambdaType Lambda)
+	{
+		this->ForeachView(0, Num(), MoveTemp(Lambda));
+	}
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(int32, TConstVoxelArrayView<Type>)>
+	FORCEINLINE void ForeachView(LambdaType Lambda) const
+	{
+		this->ForeachView(0, Num(), MoveTemp(Lambda));
+	}
+
+public:
+	FORCEINLINE Type& operator[](const int32 Index)
+	{
+		checkVoxelSlow(IsValidIndex(Index));
+		return GetElement(Index);
+	}
+	FORCEINLINE const Type& operator[](const int32 Index) const
+	{
+		return ConstCast(this)->operator[](Index);
+	}
+
+private:
+	using FChunkPtr = TVoxelAtomic<FChunk*>;
+
+	// Chunk pointers live in blocks of growing size so that the table never needs to be reallocated:
+	// block N holds FirstBlockSize << N chunks, enough blocks to address MAX_int32 elements
+	static constexpr int32 FirstBlockSizeLog2 = 4;
+	static constexpr int32 FirstBlockSize = 1 << FirstBlockSizeLog2;
+	static constexpr int32 NumBlocks = 32 - NumPerChunkLog2 - FirstBlockSizeLog2;
+	checkStatic(NumBlocks > 0);
+
+	TVoxelAtomic_WithPadding<int32> ArrayNum;
+	TVoxelAtomic<FChunkPtr*> Blocks[NumBlocks];
+
+	static constexpr int32 GetBlockSize(const int32 BlockIndex)
+	{
+		return FirstBlockSize << BlockIndex;
+	}
+
+	FORCEINLINE int32 AddUninitializedImpl(const int32 Count)
+	{
+		checkVoxelSlow(Count >= 0);
+
+		const int32 Index = ArrayNum.Add_ReturnOld(Count);
+		check(Index <= MAX_int32 - Count);
+
+		if (Count == 0)
+		{
+			return Index;
+		}
+
+		const int32 FirstChunkIndex = FVoxelUtilities::GetChunkIndex<NumPerChunk>(Index);
+		const int32 LastChunkIndex = FVoxelUtilities::GetChunkIndex<NumPerChunk>(Index + Count - 1);
+
+		for (int32 ChunkIndex = FirstChunkIndex; ChunkIndex <= LastChunkIndex; ChunkIndex++)
+		{
+			FChunkPtr& ChunkPtr = GetChunkPtr(ChunkIndex);
+			if (!ChunkPtr.Get(std::memory_order_acquire))
+			{
+				AllocateChunk(ChunkPtr);
+			}
+		}
+
+		return Index;
+	}
+
+	FORCEINLINE FChunkPtr& GetChunkPtr(const int32 ChunkIndex)
+	{
+		checkVoxelSlow(ChunkIndex >= 0);
+
+		const int32 BiasedIndex = ChunkIndex + FirstBlockSize;
+		const int32 BlockIndex = FMath::FloorLog2(BiasedIndex) - FirstBlockSizeLog2;
+		checkVoxelSlow(0 <= BlockIndex && BlockIndex < NumBlocks);
+
+		FChunkPtr* Block = Blocks[BlockIndex].Get(std::memory_order_acquire);
+		if (!Block)
+		{
+			Block = AllocateBlock(BlockIndex);
+		}
+
+		return Block[BiasedIndex - GetBlockSize(BlockIndex)];
+	}
+
+	FORCENOINLINE FChunkPtr* AllocateBlock(const int32 BlockIndex)
+	{
+		FChunkPtr* NewBlock = new FChunkPtr[GetBlockSize(BlockIndex)];
+
+		FChunkPtr* ExistingBlock = nullptr;
+		if (Blocks[BlockIndex].CompareExchangeStrong(ExistingBlock, NewBlock))
+		{
+			return NewBlock;
+		}
+
+		// Another thread allocated it first
+		delete[] NewBlock;
+		return ExistingBlock;
+	}
+	FORCENOINLINE void AllocateChunk(FChunkPtr& ChunkPtr)
+	{
+		FChunk* NewChunk = new FChunk(NoInit);
+
+		FChunk* ExistingChunk = nullptr;
+		if (!ChunkPtr.CompareExchangeStrong(ExistingChunk, NewChunk))
+		{
+			// Another thread allocated it first
+			delete NewChunk;
+		}
+	}
+
+	FORCEINLINE TVoxelArrayView<Type> GetChunkView(const int32 ChunkIndex)
+	{
+		FChunk* Chunk = GetChunkPtr(ChunkIndex).Get(std::memory_order_acquire);
+		checkVoxelSlow(Chunk);
+		return MakeVoxelArrayView(*Chunk).template ReinterpretAs<Type>();
+	}
+	FORCEINLINE Type& GetElement(const int32 Index)
+	{
+		return GetChunkView(FVoxelUtilities::GetChunkIndex<NumPerChunk>(Index))[FVoxelUtilities::GetChunkOffset<NumPerChunk>(Index)];
+	}
+};
\ No newline at end of file
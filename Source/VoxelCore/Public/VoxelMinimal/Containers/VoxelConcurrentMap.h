@@ -0,0 +1,231 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelSharedCriticalSection.h"
+#include "VoxelMinimal/Containers/VoxelMap.h"
+#include "VoxelMinimal/Utilities/VoxelLambdaUtilities.h"
+
+struct FVoxelConcurrentMapShardStats
+{
+	int32 Num = 0;
+	int64 AllocatedSize = 0;
+};
+
+// Thread-safe map for caches shared by many threads
+// Keys are spread over NumShards TVoxelMaps, each with its own lock on its own cache line,
+// so threads only contend when they hit the same shard
+// Values are returned by copy: use shared pointers for anything big
+template<typename KeyType, typename ValueType, int32 NumShards = 64>
+class TVoxelConcurrentMap
+{
+	checkStatic(FMath::IsPowerOfTwo(NumShards));
+
+public:
+	TVoxelConcurrentMap() = default;
+	UE_NONCOPYABLE(TVoxelConcurrentMap);
+
+public:
+	// Not atomic across shards
+	int32 Num() const
+	{
+		int32 Result = 0;
+		for (const FShard& Shard : Shards)
+		{
+			VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+			Result += Shard.Map_RequiresLock.Num();
+		}
+		return Result;
+	}
+	int64 GetAllocatedSize() const
+	{
+		int64 Result = sizeof(*this);
+		for (const FShard& Shard : Shards)
+		{
+			VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+			Result += Shard.Map_RequiresLock.GetAllocatedSize();
+		}
+		return Result;
+	}
+	// Use this to check keys are well distributed
+	TVoxelArray<FVoxelConcurrentMapShardStats> GetShardStats() const
+	{
+		TVoxelArray<FVoxelConcurrentMapShardStats> Result;
+		Result.Reserve(NumShards);
+
+		for (const FShard& Shard : Shards)
+		{
+			VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+
+			FVoxelConcurrentMapShardStats& Stats = Result.Emplace_GetRef();
+			Stats.Num = Shard.Map_RequiresLock.Num();
+			Stats.AllocatedSize = Shard.Map_RequiresLock.GetAllocatedSize();
+		}
+
+		return Result;
+	}
+
+	void Empty()
+	{
+		for (FShard& Shard : Shards)
+		{
+			VOXEL_SCOPE_WRITE_LOCK(Shard.CriticalSection);
+			Shard.Map_RequiresLock.Empty();
+		}
+	}
+
+public:
+	bool Contains(const KeyType& Key) const
+	{
+		const uint32 Hash = TVoxelMap<KeyType, ValueType>::HashValue(Key);
+		FShard& Shard = ConstCast(this)->GetShard(Hash);
+
+		VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+		return Shard.Map_RequiresLock.FindHashed(Hash, Key) != nullptr;
+	}
+	TOptional<ValueType> Find(const KeyType& Key) const
+	{
+		const uint32 Hash = TVoxelMap<KeyType, ValueType>::HashValue(Key);
+		FShard& Shard = ConstCast(this)->GetShard(Hash);
+
+		VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+
+		const ValueType* Value = Shard.Map_RequiresLock.FindHashed(Hash, Key);
+		if (!Value)
+		{
+			return {};
+		}
+		return *Value;
+	}
+	ValueType FindRef(const KeyType& Key) const
+	{
+		TOptional<ValueType> Value = this->Find(Key);
+		if (!Value)
+		{
+			return ValueType();
+		}
+		return MoveTemp(Value.GetValue());
+	}
+
+	// Construct is called at most once per key, with the shard write-locked: keep it cheap,
+	// eg by returning a shared pointer or a future to the actual data
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, ValueType()>
+	ValueType FindOrAdd(const KeyType& Key, LambdaType&& Construct)
+	{
+		const uint32 Hash = TVoxelMap<KeyType, ValueType>::HashValue(Key);
+		FShard& Shard = GetShard(Hash);
+
+		{
+			VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+
+			if (const ValueType* Value = Shard.Map_RequiresLock.FindHashed(Hash, Key))
+			{
+				return *Value;
+			}
+		}
+
+		VOXEL_SCOPE_WRITE_LOCK(Shard.CriticalSection);
+
+		// Another thread might have added it in between
+		if (const ValueType* Value = Shard.Map_RequiresLock.FindHashed(Hash, Key))
+		{
+			return *Value;
+		}
+
+		return Shard.Map_RequiresLock.AddHashed_CheckNew(Hash, Key, Construct());
+	}
+
+	// Returns false if Key was already in the map, in which case its value is overwritten
+	template<typename InValueType>
+	requires std::is_constructible_v<ValueType, InValueType&&>
+	bool Add(const KeyType& Key, InValueType&& Value)
+	{
+		const uint32 Hash = TVoxelMap<KeyType, ValueType>::HashValue(Key);
+		FShard& Shard = GetShard(Hash);
+
+		VOXEL_SCOPE_WRITE_LOCK(Shard.CriticalSection);
+
+		if (ValueType* ExistingValue = Shard.Map_RequiresLock.FindHashed(Hash, Key))
+		{
+			*ExistingValue = Forward<InValueType>(Value);
+			return false;
+		}
+
+		Shard.Map_RequiresLock.AddHashed_CheckNew(Hash, Key, Forward<InValueType>(Value));
+		return true;
+	}
+	bool Remove(const KeyType& Key)
+	{
+		const uint32 Hash = TVoxelMap<KeyType, ValueType>::HashValue(Key);
+		FShard& Shard = GetShard(Hash);
+
+		VOXEL_SCOPE_WRITE_LOCK(Shard.CriticalSection);
+
+		if (!Shard.Map_RequiresLock.FindHashed(Hash, Key))
+		{
+			return false;
+		}
+
+		Shard.Map_RequiresLock.RemoveHashedChecked(Hash, Key);
+		return true;
+	}
+
+public:
+	// Copies each shard under its lock, then calls Lambda without holding any lock
+	// Each shard is a consistent snapshot, the map as a whole isn't
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(const KeyType&, const ValueType&)>
+	void ForEach(LambdaType&& Lambda) const
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TVoxelMap<KeyType, ValueType> ShardCopy;
+		for (const FShard& Shard : Shards)
+		{
+			{
+				VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+				ShardCopy = Shard.Map_RequiresLock;
+			}
+
+			for (const auto& It : ShardCopy)
+			{
+				Lambda(It.Key, It.Value);
+			}
+		}
+	}
+
+	TVoxelMap<KeyType, ValueType> GetSnapshot() const
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		TVoxelMap<KeyType, ValueType> Result;
+		for (const FShard& Shard : Shards)
+		{
+			VOXEL_SCOPE_READ_LOCK(Shard.CriticalSection);
+
+			Result.ReserveGrow(Shard.Map_RequiresLock.Num());
+
+			for (const auto& It : Shard.Map_RequiresLock)
+			{
+				Result.Add_CheckNew(It.Key, It.Value);
+			}
+		}
+		return Result;
+	}
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+	{
+		mutable FVoxelSharedCriticalSection_NoPadding CriticalSection;
+		TVoxelMap<KeyType, ValueType> Map_RequiresLock;
+	};
+	FShard Shards[NumShards];
+
+	FORCEINLINE FShard& GetShard(const uint32 Hash)
+	{
+		// TVoxelMap buckets use the low bits of Hash, mix it so that each shard fills all its buckets
+		return Shards[FVoxelUtilities::MurmurHash32(Hash) % NumShards];
+	}
+};
\ No newline at end of file
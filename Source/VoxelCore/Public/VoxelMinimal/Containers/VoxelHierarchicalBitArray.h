@@ -0,0 +1,333 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelIterate.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+#include "VoxelMinimal/Containers/VoxelBitArray.h"
+#include "VoxelMinimal/Utilities/VoxelMathUtilities.h"
+
+// Bit array with a summary bit per word telling whether the word has any bit set
+// Iteration, population counts and any/none range tests skip 64 empty words per summary word,
+// use it for sparse masks such as surface cells over a big volume
+// Bits can only be written through Set/SetRange so that the summary stays up to date
+class FVoxelHierarchicalBitArray
+{
+public:
+	static constexpr int32 NumBitsPerWord = 32;
+	static constexpr int32 NumWordsPerSummaryWord = 64;
+
+	FVoxelHierarchicalBitArray() = default;
+	explicit FVoxelHierarchicalBitArray(FVoxelBitArray&& InBits)
+		: Bits(MoveTemp(InBits))
+	{
+		BuildSummary();
+	}
+	explicit FVoxelHierarchicalBitArray(const FVoxelBitArray& InBits)
+		: Bits(InBits)
+	{
+		BuildSummary();
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return Bits.Num();
+	}
+	FORCEINLINE int32 NumWords() const
+	{
+		return Bits.NumWords();
+	}
+	FORCEINLINE bool IsValidIndex(const int32 Index) const
+	{
+		return Bits.IsValidIndex(Index);
+	}
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return Bits.GetAllocatedSize() + Summary.GetAllocatedSize();
+	}
+	FORCEINLINE const FVoxelBitArray& GetBits() const
+	{
+		return Bits;
+	}
+
+	void SetNum(const int32 NewNumBits, const bool bValue)
+	{
+		Bits.Reset();
+		Bits.SetNum(NewNumBits, bValue);
+		BuildSummary();
+	}
+	void SetNumZeroed(const int32 NewNumBits)
+	{
+		this->SetNum(NewNumBits, false);
+	}
+	void Empty()
+	{
+		Bits.Empty();
+		Summary.Empty();
+	}
+
+public:
+	FORCEINLINE bool Get(const int32 Index) const
+	{
+		return Bits[Index];
+	}
+	FORCEINLINE bool operator[](const int32 Index) const
+	{
+		return Bits[Index];
+	}
+	FORCEINLINE void Set(const int32 Index, const bool bValue)
+	{
+		checkVoxelSlow(IsValidIndex(Index));
+
+		const int32 WordIndex = Index / NumBitsPerWord;
+		const uint32 Mask = 1u << (Index % NumBitsPerWord);
+		uint32& Word = Bits.GetWord(WordIndex);
+
+		if (bValue)
+		{
+			Word |= Mask;
+			Summary[WordIndex / NumWordsPerSummaryWord] |= GetSummaryMask(WordIndex);
+		}
+		else
+		{
+			Word &= ~Mask;
+
+			if (!Word)
+			{
+				Summary[WordIndex / NumWordsPerSummaryWord] &= ~GetSummaryMask(WordIndex);
+			}
+		}
+	}
+	void SetRange(const int32 Index, const int32 Num, const bool bValue)
+	{
+		checkVoxelSlow(0 <= Index && Index + Num <= this->Num());
+
+		if (Num == 0)
+		{
+			return;
+		}
+
+		Bits.SetRange(Index, Num, bValue);
+
+		const int32 StartWord = Index / NumBitsPerWord;
+		const int32 EndWord = FVoxelUtilities::DivideCeil_Positive(Index + Num, NumBitsPerWord);
+
+		SetSummaryRange(StartWord, EndWord, bValue);
+
+		if (!bValue)
+		{
+			// The first and last words may only be partially cleared
+			UpdateSummary(StartWord);
+			UpdateSummary(EndWord - 1);
+		}
+	}
+
+public:
+	// True if all the bits in the range are set
+	FORCEINLINE bool TestRange(const int32 Index, const int32 Num) const
+	{
+		return Bits.TestRange(Index, Num);
+	}
+	// True if any bit in the range is set
+	bool TestRangeAny(const int32 Index, const int32 Num) const
+	{
+		checkVoxelSlow(0 <= Index && Index + Num <= this->Num());
+
+		if (Num == 0)
+		{
+			return false;
+		}
+
+		const int32 StartWord = Index / NumBitsPerWord;
+		const int32 LastWord = (Index + Num - 1) / NumBitsPerWord;
+
+		const uint32 StartMask = 0xFFFFFFFFu << (Index % NumBitsPerWord);
+		const uint32 EndMask = 0xFFFFFFFFu >> (NumBitsPerWord - 1 - (Index + Num - 1) % NumBitsPerWord);
+
+		if (StartWord == LastWord)
+		{
+			return (Bits.GetWord(StartWord) & StartMask & EndMask) != 0;
+		}
+
+		if ((Bits.GetWord(StartWord) & StartMask) ||
+			(Bits.GetWord(LastWord) & EndMask))
+		{
+			return true;
+		}
+
+		return ForAllNonZeroWords(StartWord + 1, LastWord, [](int32, uint32)
+		{
+			return EVoxelIterate::Stop;
+		}) == EVoxelIterate::Stop;
+	}
+	// True if no bit in the range is set
+	FORCEINLINE bool TestRangeNone(const int32 Index, const int32 Num) const
+	{
+		return !TestRangeAny(Index, Num);
+	}
+
+	int32 CountSetBits() const
+	{
+		int32 Count = 0;
+		ForAllNonZeroWords(0, NumWords(), [&](int32, const uint32 Word)
+		{
+			Count += FVoxelUtilities::CountBits(Word);
+			return EVoxelIterate::Continue;
+		});
+		return Count;
+	}
+	// Number of set bits in [0, Count)
+	int32 CountSetBits(const int32 Count) const
+	{
+		checkVoxelSlow(0 <= Count && Count <= Num());
+
+		const int32 NumFullWords = Count / NumBitsPerWord;
+
+		int32 Result = 0;
+		ForAllNonZeroWords(0, NumFullWords, [&](int32, const uint32 Word)
+		{
+			Result += FVoxelUtilities::CountBits(Word);
+			return EVoxelIterate::Continue;
+		});
+
+		const int32 NumBitsLeft = Count % NumBitsPerWord;
+		if (NumBitsLeft > 0)
+		{
+			Result += FVoxelUtilities::CountBits(Bits.GetWord(NumFullWords) & ((1u << NumBitsLeft) - 1));
+		}
+
+		return Result;
+	}
+
+	template<
+		typename LambdaType,
+		typename ReturnType = LambdaReturnType_T<LambdaType>,
+		typename = std::enable_if_t<std::is_void_v<ReturnType> || std::is_same_v<ReturnType, EVoxelIterate>>>
+	FORCEINLINE EVoxelIterate ForAllSetBits(LambdaType Lambda) const
+	{
+		const int32 NumBits = Num();
+
+		return ForAllNonZeroWords(0, NumWords(), [&](const int32 WordIndex, const uint32 Word)
+		{
+			return FVoxelBitArrayHelpers::ForAllSetBitsInWord(Word, WordIndex, NumBits, Lambda);
+		});
+	}
+
+private:
+	FVoxelBitArray Bits;
+	// Bit N of Summary[I] is set if word I * 64 + N of Bits is not zero
+	TVoxelArray<uint64> Summary;
+
+	FORCEINLINE static uint64 GetSummaryMask(const int32 WordIndex)
+	{
+		return uint64(1) << (WordIndex % NumWordsPerSummaryWord);
+	}
+
+	void BuildSummary()
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Num(), 1024);
+
+		Summary.Reset();
+		Summary.SetNumZeroed(FVoxelUtilities::DivideCeil_Positive(NumWords(), NumWordsPerSummaryWord));
+
+		const TConstVoxelArrayView<uint32> Words = Bits.GetWordView();
+		for (int32 WordIndex = 0; WordIndex < Words.Num(); WordIndex++)
+		{
+			if (Words[WordIndex])
+			{
+				Summary[WordIndex / NumWordsPerSummaryWord] |= GetSummaryMask(WordIndex);
+			}
+		}
+	}
+	FORCEINLINE void UpdateSummary(const int32 WordIndex)
+	{
+		uint64& SummaryWord = Summary[WordIndex / NumWordsPerSummaryWord];
+
+		if (Bits.GetWord(WordIndex))
+		{
+			SummaryWord |= GetSummaryMask(WordIndex);
+		}
+		else
+		{
+			SummaryWord &= ~GetSummaryMask(WordIndex);
+		}
+	}
+	void SetSummaryRange(const int32 StartWord, const int32 EndWord, const bool bValue)
+	{
+		checkVoxelSlow(StartWord < EndWord);
+
+		const int32 StartSummaryWord = StartWord / NumWordsPerSummaryWord;
+		const int32 LastSummaryWord = (EndWord - 1) / NumWordsPerSummaryWord;
+
+		for (int32 SummaryIndex = StartSummaryWord; SummaryIndex <= LastSummaryWord; SummaryIndex++)
+		{
+			const uint64 Mask = GetSummaryRangeMask(SummaryIndex, StartWord, EndWord);
+
+			if (bValue)
+			{
+				Summary[SummaryIndex] |= Mask;
+			}
+			else
+			{
+				Summary[SummaryIndex] &= ~Mask;
+			}
+		}
+	}
+	// Bits of Summary[SummaryIndex] covering words in [StartWord, EndWord)
+	FORCEINLINE static uint64 GetSummaryRangeMask(const int32 SummaryIndex, const int32 StartWord, const int32 EndWord)
+	{
+		const int32 FirstWordInSummary = SummaryIndex * NumWordsPerSummaryWord;
+
+		uint64 Mask = ~uint64(0);
+		if (StartWord > FirstWordInSummary)
+		{
+			Mask &= ~uint64(0) << (StartWord - FirstWordInSummary);
+		}
+		if (EndWord < FirstWordInSummary + NumWordsPerSummaryWord)
+		{
+			Mask &= (uint64(1) << (EndWord - FirstWordInSummary)) - 1;
+		}
+		return Mask;
+	}
+
+	// Call Lambda(WordIndex, Word) for all the non-zero words in [StartWord, EndWord)
+	template<typename LambdaType>
+	FORCEINLINE EVoxelIterate ForAllNonZeroWords(const int32 StartWord, const int32 EndWord, LambdaType&& Lambda) const
+	{
+		if (StartWord >= EndWord)
+		{
+			return EVoxelIterate::Continue;
+		}
+
+		const int32 StartSummaryWord = StartWord / NumWordsPerSummaryWord;
+		const int32 LastSummaryWord = (EndWord - 1) / NumWordsPerSummaryWord;
+
+		for (int32 SummaryIndex = StartSummaryWord; SummaryIndex <= LastSummaryWord; SummaryIndex++)
+		{
+			uint64 SummaryWord = Summary[SummaryIndex];
+			if (!SummaryWord)
+			{
+				continue;
+			}
+
+			SummaryWord &= GetSummaryRangeMask(SummaryIndex, StartWord, EndWord);
+
+			while (SummaryWord)
+			{
+				const int32 WordIndex = SummaryIndex * NumWordsPerSummaryWord + FVoxelUtilities::FirstBitLow(SummaryWord);
+				SummaryWord &= SummaryWord - 1;
+
+				checkVoxelSlow(Bits.GetWord(WordIndex) != 0);
+
+				if (Lambda(WordIndex, Bits.GetWord(WordIndex)) == EVoxelIterate::Stop)
+				{
+					return EVoxelIterate::Stop;
+				}
+			}
+		}
+
+		return EVoxelIterate::Continue;
+	}
+};
\ No newline at end of file
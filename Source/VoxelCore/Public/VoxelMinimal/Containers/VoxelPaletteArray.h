@@ -0,0 +1,422 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/Containers/VoxelMap.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+#include "VoxelMinimal/Containers/VoxelArrayView.h"
+#include "VoxelMinimal/Containers/VoxelBitArrayHelpers.h"
+#include "VoxelMinimal/Utilities/VoxelArrayUtilities.h"
+
+struct VOXELCORE_API FVoxelPaletteArrayHelpers
+{
+	// Words must have room for Indices.Num() * BitsPerIndex bits plus a padding word
+	static void PackIndices(
+		TConstVoxelArrayView<uint32> Indices,
+		int32 BitsPerIndex,
+		TVoxelArrayView<uint32> Words);
+
+	static void UnpackIndices(
+		TConstVoxelArrayView<uint32> Words,
+		int32 BitsPerIndex,
+		TVoxelArrayView<uint32> OutIndices);
+
+	static void Decode(
+		TConstVoxelArrayView<uint32> Words,
+		int32 BitsPerIndex,
+		TConstVoxelArrayView<uint8> Palette,
+		TVoxelArrayView<uint8> OutValues);
+
+	static void Decode(
+		TConstVoxelArrayView<uint32> Words,
+		int32 BitsPerIndex,
+		TConstVoxelArrayView<uint16> Palette,
+		TVoxelArrayView<uint16> OutValues);
+
+	static void Decode(
+		TConstVoxelArrayView<uint32> Words,
+		int32 BitsPerIndex,
+		TConstVoxelArrayView<uint32> Palette,
+		TVoxelArrayView<uint32> OutValues);
+
+	FORCEINLINE static int32 GetNumWords(const int32 Num, const int32 BitsPerIndex)
+	{
+		if (BitsPerIndex == 0)
+		{
+			return 0;
+		}
+
+		// Padding word so that bulk decoding can always read 64 bits at once
+		return FVoxelUtilities::DivideCeil_Positive<int64>(int64(Num) * BitsPerIndex, 32) + 1;
+	}
+};
+
+// Fixed number of values stored as a palette of distinct values plus bit-packed indices into it
+// Indices use as few bits as the palette needs: up to 16 distinct values take 4 bits per value
+// The bit width grows when new values are added and shrinks back once most of the palette is unused
+// If all values are equal, no index is stored at all
+// Meant for low-cardinality data such as materials or metadata: palette lookups on Set are linear
+template<typename T>
+class TVoxelPaletteArray
+{
+public:
+	checkStatic(std::is_trivially_copyable_v<T>);
+
+	TVoxelPaletteArray() = default;
+	TVoxelPaletteArray(const int32 Num, const T& Value)
+	{
+		this->SetNum(Num, Value);
+	}
+
+public:
+	void SetNum(const int32 NewNum, const T& Value)
+	{
+		check(NewNum >= 0);
+
+		ArrayNum = NewNum;
+		BitsPerIndex = 0;
+		Words.Empty();
+
+		Palette.Reset();
+		PaletteCounts.Reset();
+		NumUsedPaletteEntries = 0;
+
+		if (NewNum > 0)
+		{
+			Palette.Add(Value);
+			PaletteCounts.Add(NewNum);
+			NumUsedPaletteEntries = 1;
+		}
+	}
+	void Empty()
+	{
+		this->SetNum(0, T{});
+	}
+
+	FORCEINLINE int32 Num() const
+	{
+		return ArrayNum;
+	}
+	FORCEINLINE bool IsValidIndex(const int32 Index) const
+	{
+		return 0 <= Index && Index < ArrayNum;
+	}
+	FORCEINLINE int32 GetBitsPerIndex() const
+	{
+		return BitsPerIndex;
+	}
+	FORCEINLINE bool IsUniform() const
+	{
+		return BitsPerIndex == 0;
+	}
+	// Number of distinct values
+	FORCEINLINE int32 GetPaletteNum() const
+	{
+		return NumUsedPaletteEntries;
+	}
+	int64 GetAllocatedSize() const
+	{
+		return
+			Words.GetAllocatedSize() +
+			Palette.GetAllocatedSize() +
+			PaletteCounts.GetAllocatedSize();
+	}
+
+public:
+	FORCEINLINE const T& Get(const int32 Index) const
+	{
+		return Palette[GetPaletteIndex(Index)];
+	}
+	FORCEINLINE const T& operator[](const int32 Index) const
+	{
+		return this->Get(Index);
+	}
+
+	void Set(const int32 Index, const T& Value)
+	{
+		const int32 OldPaletteIndex = GetPaletteIndex(Index);
+		if (Palette[OldPaletteIndex] == Value)
+		{
+			return;
+		}
+
+		const int32 NewPaletteIndex = FindOrAddPaletteEntry(Value);
+		checkVoxelSlow(BitsPerIndex > 0);
+
+		FVoxelBitArrayHelpers::SetPacked(BitsPerIndex, Words.GetData(), Index, NewPaletteIndex);
+		PaletteCounts[NewPaletteIndex]++;
+
+		PaletteCounts[OldPaletteIndex]--;
+		checkVoxelSlow(PaletteCounts[OldPaletteIndex] >= 0);
+
+		if (PaletteCounts[OldPaletteIndex] == 0)
+		{
+			NumUsedPaletteEntries--;
+			ShrinkIfNeeded();
+		}
+	}
+
+	// Use the same value everywhere
+	void SetUniform(const T& Value)
+	{
+		this->SetNum(ArrayNum, Value);
+	}
+
+public:
+	// Bulk decode, ISPC-accelerated for 1, 2 and 4 byte types
+	void GetAll(const TVoxelArrayView<T> OutValues) const
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(ArrayNum, 1024);
+		check(OutValues.Num() == ArrayNum);
+
+		if (ArrayNum == 0)
+		{
+			return;
+		}
+
+		if (BitsPerIndex == 0)
+		{
+			FVoxelUtilities::SetAll(OutValues, Palette[0]);
+			return;
+		}
+
+		if constexpr (
+			sizeof(T) == sizeof(uint8) ||
+			sizeof(T) == sizeof(uint16) ||
+			sizeof(T) == sizeof(uint32))
+		{
+			using FUint = std::conditional_t<sizeof(T) == sizeof(uint8), uint8,
+				std::conditional_t<sizeof(T) == sizeof(uint16), uint16, uint32>>;
+
+			FVoxelPaletteArrayHelpers::Decode(
+				Words,
+				BitsPerIndex,
+				Palette.View().template ReinterpretAs<FUint>(),
+				OutValues.template ReinterpretAs<FUint>());
+		}
+		else
+		{
+			TVoxelArray<uint32> Indices;
+			FVoxelUtilities::SetNumFast(Indices, ArrayNum);
+			FVoxelPaletteArrayHelpers::UnpackIndices(Words, BitsPerIndex, Indices);
+
+			for (int32 Index = 0; Index < ArrayNum; Index++)
+			{
+				OutValues[Index] = Palette[Indices[Index]];
+			}
+		}
+	}
+	// Bulk encode, the palette is rebuilt from scratch. T must be hashable
+	void SetAll(const TConstVoxelArrayView<T> Values)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Values.Num(), 1024);
+
+		if (Values.Num() == 0)
+		{
+			this->SetNum(0, T{});
+			return;
+		}
+
+		ArrayNum = Values.Num();
+		Palette.Reset();
+		PaletteCounts.Reset();
+
+		TVoxelArray<uint32> Indices;
+		FVoxelUtilities::SetNumFast(Indices, ArrayNum);
+		{
+			TVoxelMap<T, int32> ValueToPaletteIndex;
+
+			// Consecutive values are often equal
+			T LastValue = Values[0];
+			int32 LastPaletteIndex = 0;
+			Palette.Add(LastValue);
+			PaletteCounts.Add(0);
+			ValueToPaletteIndex.Add_CheckNew(LastValue, 0);
+
+			for (int32 Index = 0; Index < ArrayNum; Index++)
+			{
+				const T& Value = Values[Index];
+				if (!(Value == LastValue))
+				{
+					if (const int32* PaletteIndex = ValueToPaletteIndex.Find(Value))
+					{
+						LastPaletteIndex = *PaletteIndex;
+					}
+					else
+					{
+						LastPaletteIndex = Palette.Add(Value);
+						PaletteCounts.Add(0);
+						ValueToPaletteIndex.Add_CheckNew(Value, LastPaletteIndex);
+					}
+
+					LastValue = Value;
+				}
+
+				Indices[Index] = LastPaletteIndex;
+				PaletteCounts[LastPaletteIndex]++;
+			}
+		}
+
+		NumUsedPaletteEntries = Palette.Num();
+		BitsPerIndex = GetBitsForPaletteNum(Palette.Num());
+
+		if (BitsPerIndex == 0)
+		{
+			Words.Empty();
+			return;
+		}
+
+		const int32 NumWords = FVoxelPaletteArrayHelpers::GetNumWords(ArrayNum, BitsPerIndex);
+		Words.Empty(NumWords);
+		FVoxelUtilities::SetNumFast(Words, NumWords);
+		FVoxelPaletteArrayHelpers::PackIndices(Indices, BitsPerIndex, Words);
+	}
+
+private:
+	int32 ArrayNum = 0;
+	int32 BitsPerIndex = 0;
+	int32 NumUsedPaletteEntries = 0;
+	// Entries whose count is 0 are unused and can be recycled
+	TVoxelArray<T> Palette;
+	TVoxelArray<int32> PaletteCounts;
+	TVoxelArray<uint32> Words;
+
+	FORCEINLINE static int32 GetBitsForPaletteNum(const int32 PaletteNum)
+	{
+		return FMath::CeilLogTwo(uint32(PaletteNum));
+	}
+
+	FORCEINLINE int32 GetPaletteIndex(const int32 Index) const
+	{
+		checkVoxelSlow(IsValidIndex(Index));
+
+		if (BitsPerIndex == 0)
+		{
+			return 0;
+		}
+
+		return FVoxelBitArrayHelpers::GetPacked(BitsPerIndex, Words.GetData(), Index);
+	}
+
+	int32 FindOrAddPaletteEntry(const T& Value)
+	{
+		int32 FreeIndex = -1;
+		for (int32 Index = 0; Index < Palette.Num(); Index++)
+		{
+			if (PaletteCounts[Index] == 0)
+			{
+				if (FreeIndex == -1)
+				{
+					FreeIndex = Index;
+				}
+				continue;
+			}
+
+			if (Palette[Index] == Value)
+			{
+				return Index;
+			}
+		}
+
+		NumUsedPaletteEntries++;
+
+		if (FreeIndex != -1)
+		{
+			Palette[FreeIndex] = Value;
+			return FreeIndex;
+		}
+
+		const int32 NewIndex = Palette.Add(Value);
+		PaletteCounts.Add(0);
+
+		if (Palette.Num() > (1 << BitsPerIndex))
+		{
+			Repack(BitsPerIndex + 1);
+		}
+
+		return NewIndex;
+	}
+	void ShrinkIfNeeded()
+	{
+		if (NumUsedPaletteEntries == 1)
+		{
+			Repack(0);
+			return;
+		}
+
+		// Only shrink once a quarter of the indices are used so that values
+		// added and removed around a power of two don't repack every time
+		if (BitsPerIndex >= 2 &&
+			NumUsedPaletteEntries <= (1 << (BitsPerIndex - 2)))
+		{
+			Repack(BitsPerIndex - 1);
+		}
+	}
+
+	// Re-encode all the indices with NewBitsPerIndex
+	// When shrinking, unused palette entries are removed
+	void Repack(const int32 NewBitsPerIndex)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(ArrayNum, 1024);
+
+		TVoxelArray<uint32> Indices;
+		FVoxelUtilities::SetNumFast(Indices, ArrayNum);
+
+		if (BitsPerIndex == 0)
+		{
+			FVoxelUtilities::SetAll(Indices, 0);
+		}
+		else
+		{
+			FVoxelPaletteArrayHelpers::UnpackIndices(Words, BitsPerIndex, Indices);
+		}
+
+		if (NewBitsPerIndex < BitsPerIndex)
+		{
+			TVoxelArray<int32> OldToNewIndex;
+			FVoxelUtilities::SetNumFast(OldToNewIndex, Palette.Num());
+
+			TVoxelArray<T> NewPalette;
+			TVoxelArray<int32> NewPaletteCounts;
+			NewPalette.Reserve(NumUsedPaletteEntries);
+			NewPaletteCounts.Reserve(NumUsedPaletteEntries);
+
+			for (int32 Index = 0; Index < Palette.Num(); Index++)
+			{
+				if (PaletteCounts[Index] == 0)
+				{
+					OldToNewIndex[Index] = -1;
+					continue;
+				}
+
+				OldToNewIndex[Index] = NewPalette.Add(Palette[Index]);
+				NewPaletteCounts.Add(PaletteCounts[Index]);
+			}
+
+			for (uint32& Index : Indices)
+			{
+				Index = OldToNewIndex[Index];
+				checkVoxelSlow(Index != uint32(-1));
+			}
+
+			Palette = MoveTemp(NewPalette);
+			PaletteCounts = MoveTemp(NewPaletteCounts);
+		}
+		checkVoxelSlow(Palette.Num() <= (1 << NewBitsPerIndex));
+
+		BitsPerIndex = NewBitsPerIndex;
+
+		if (BitsPerIndex == 0)
+		{
+			Words.Empty();
+			return;
+		}
+
+		// Empty with the exact size to give back memory when shrinking
+		const int32 NumWords = FVoxelPaletteArrayHelpers::GetNumWords(ArrayNum, BitsPerIndex);
+		Words.Empty(NumWords);
+		FVoxelUtilities::SetNumFast(Words, NumWords);
+		FVoxelPaletteArrayHelpers::PackIndices(Indices, BitsPerIndex, Words);
+	}
+};
\ No newline at end of file
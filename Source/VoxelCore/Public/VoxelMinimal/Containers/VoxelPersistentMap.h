@@ -0,0 +1,754 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/Utilities/VoxelMathUtilities.h"
+#include "VoxelMinimal/Utilities/VoxelHashUtilities.h"
+#include "VoxelMinimal/Utilities/VoxelLambdaUtilities.h"
+
+DECLARE_VOXEL_MEMORY_STAT(VOXELCORE_API, STAT_VoxelPersistentMapMemory, "Voxel Persistent Map Memory");
+
+// Hash map whose copies share their structure: a hash array mapped trie with 32-way nodes
+// Copying is O(1) and updates are O(log32 Num): they only copy the nodes on the path to the key,
+// so a copy is a cheap snapshot that can be handed to async readers while the original keeps changing
+// Nodes only referenced by one map are updated in place: building a map doesn't copy anything
+// Each node stores its children then its entries in a single allocation (CHAMP layout), which keeps iteration cache-friendly
+// Values can't be modified through Find, use Add
+// A map isn't thread-safe, but different copies can be used and destroyed on different threads
+template<typename KeyType, typename ValueType>
+class TVoxelPersistentMap
+{
+public:
+	struct FEntry
+	{
+		KeyType Key;
+		ValueType Value;
+		uint32 Hash = 0;
+	};
+
+	TVoxelPersistentMap() = default;
+	FORCEINLINE TVoxelPersistentMap(const TVoxelPersistentMap& Other)
+		: Root(Other.Root)
+		, NumEntries(Other.NumEntries)
+	{
+		AddRef(Root);
+	}
+	FORCEINLINE TVoxelPersistentMap(TVoxelPersistentMap&& Other)
+		: Root(Other.Root)
+		, NumEntries(Other.NumEntries)
+	{
+		Other.Root = nullptr;
+		Other.NumEntries = 0;
+	}
+	FORCEINLINE TVoxelPersistentMap& operator=(const TVoxelPersistentMap& Other)
+	{
+		AddRef(Other.Root);
+		Release(Root);
+
+		Root = Other.Root;
+		NumEntries = Other.NumEntries;
+		return *this;
+	}
+	FORCEINLINE TVoxelPersistentMap& operator=(TVoxelPersistentMap&& Other)
+	{
+		if (this != &Other)
+		{
+			Release(Root);
+
+			Root = Other.Root;
+			NumEntries = Other.NumEntries;
+
+			Other.Root = nullptr;
+			Other.NumEntries = 0;
+		}
+		return *this;
+	}
+	FORCEINLINE ~TVoxelPersistentMap()
+	{
+		Release(Root);
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return NumEntries;
+	}
+	void Empty()
+	{
+		Release(Root);
+		Root = nullptr;
+		NumEntries = 0;
+	}
+	// Counts nodes shared with other maps too: see STAT_VoxelPersistentMapMemory for the actual memory usage
+	int64 GetAllocatedSize() const
+	{
+		return GetAllocatedSize(Root);
+	}
+
+public:
+	FORCEINLINE const ValueType* Find(const KeyType& Key) const
+	{
+		const FEntry* Entry = FindEntry(HashValue(Key), Key);
+		if (!Entry)
+		{
+			return nullptr;
+		}
+		return &Entry->Value;
+	}
+	FORCEINLINE const ValueType& FindChecked(const KeyType& Key) const
+	{
+		const ValueType* Value = this->Find(Key);
+		check(Value);
+		return *Value;
+	}
+	FORCEINLINE ValueType FindRef(const KeyType& Key) const
+	{
+		if (const ValueType* Value = this->Find(Key))
+		{
+			return *Value;
+		}
+		return ValueType();
+	}
+	FORCEINLINE bool Contains(const KeyType& Key) const
+	{
+		return this->Find(Key) != nullptr;
+	}
+
+public:
+	// Returns false if Key was already in the map, in which case its value is overwritten
+	template<typename InValueType>
+	requires std::is_constructible_v<ValueType, InValueType&&>
+	bool Add(const KeyType& Key, InValueType&& Value)
+	{
+		const uint32 Hash = HashValue(Key);
+
+		if (!Root)
+		{
+			Root = AllocateNode(1, 0);
+			Root->DataMap = GetBit(Hash, 0);
+			new (&Root->GetEntries()[0]) FEntry{ Key, ValueType(Forward<InValueType>(Value)), Hash };
+
+			NumEntries = 1;
+			return true;
+		}
+
+		if (!Insert(Root, 0, Hash, Key, Forward<InValueType>(Value)))
+		{
+			return false;
+		}
+
+		NumEntries++;
+		return true;
+	}
+	template<typename InValueType>
+	requires std::is_constructible_v<ValueType, InValueType&&>
+	void Add_CheckNew(const KeyType& Key, InValueType&& Value)
+	{
+		const bool bAdded = this->Add(Key, Forward<InValueType>(Value));
+		checkVoxelSlow(bAdded);
+	}
+
+	bool Remove(const KeyType& Key)
+	{
+		const uint32 Hash = HashValue(Key);
+
+		// Check first to not copy the path if the key isn't there
+		if (!FindEntry(Hash, Key))
+		{
+			return false;
+		}
+
+		RemoveImpl(Root, 0, Hash, Key);
+		NumEntries--;
+
+		checkVoxelSlow((NumEntries == 0) == (Root == nullptr));
+		return true;
+	}
+
+public:
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(const KeyType&, const ValueType&)>
+	void ForEach(LambdaType&& Lambda) const
+	{
+		for (const FEntry& Entry : *this)
+		{
+			Lambda(Entry.Key, Entry.Value);
+		}
+	}
+
+	// True if both maps point to the same structure: a copy that wasn't modified since
+	FORCEINLINE bool IsSharedWith(const TVoxelPersistentMap& Other) const
+	{
+		return Root == Other.Root;
+	}
+
+private:
+	struct FNode;
+
+	// Enough for 6 full levels of 5 bits, 1 level of 2 bits and the collision level
+	static constexpr int32 MaxDepth = 8;
+
+public:
+	struct FIterator
+	{
+	public:
+		FORCEINLINE const FEntry& operator*() const
+		{
+			return Node->GetEntries()[EntryIndex];
+		}
+		FORCEINLINE const FEntry* operator->() const
+		{
+			return &Node->GetEntries()[EntryIndex];
+		}
+		FORCEINLINE void operator++()
+		{
+			EntryIndex++;
+			FindNext();
+		}
+		FORCEINLINE explicit operator bool() const
+		{
+			return Node != nullptr;
+		}
+		FORCEINLINE bool operator!=(decltype(nullptr)) const
+		{
+			return Node != nullptr;
+		}
+
+	private:
+		struct FFrame
+		{
+			const FNode* Node = nullptr;
+			int32 ChildIndex = 0;
+		};
+
+		const FNode* Node = nullptr;
+		int32 EntryIndex = 0;
+		int32 Depth = 0;
+		FFrame Stack[MaxDepth];
+
+		// Entries of a node are visited before its children
+		void FindNext()
+		{
+			while (true)
+			{
+				if (EntryIndex < Node->NumEntries)
+				{
+					return;
+				}
+
+				if (Node->NumChildren > 0)
+				{
+					checkVoxelSlow(Depth < MaxDepth);
+					Stack[Depth++] = FFrame{ Node, 0 };
+
+					Node = Node->GetChildren()[0];
+					EntryIndex = 0;
+					continue;
+				}
+
+				// Go up until a node has a next child
+				while (true)
+				{
+					if (Depth == 0)
+					{
+						Node = nullptr;
+						return;
+					}
+
+					FFrame& Frame = Stack[Depth - 1];
+					Frame.ChildIndex++;
+
+					if (Frame.ChildIndex < Frame.Node->NumChildren)
+					{
+						Node = Frame.Node->GetChildren()[Frame.ChildIndex];
+						EntryIndex = 0;
+						break;
+					}
+
+					Depth--;
+				}
+			}
+		}
+
+		friend TVoxelPersistentMap;
+	};
+
+	FORCEINLINE FIterator begin() const
+	{
+		FIterator Iterator;
+		if (Root)
+		{
+			Iterator.Node = Root;
+			Iterator.FindNext();
+		}
+		return Iterator;
+	}
+	FORCEINLINE decltype(nullptr) end() const
+	{
+		return nullptr;
+	}
+
+private:
+	static constexpr int32 BitsPerLevel = 5;
+	// Nodes at this shift hold entries whose hashes are fully equal
+	static constexpr int32 CollisionShift = 35;
+
+	// Layout: FNode, Children[NumChildren], Entries[NumEntries]
+	struct FNode
+	{
+		FVoxelCounter32 NumRefs;
+		// Positions holding an entry
+		uint32 DataMap = 0;
+		// Positions holding a child
+		uint32 NodeMap = 0;
+		int32 NumEntries = 0;
+		int32 NumChildren = 0;
+
+		static constexpr int64 ChildrenOffset = Align(sizeof(FNode), alignof(FNode*));
+
+		static constexpr int64 GetEntriesOffset(const int32 NumChildren)
+		{
+			return Align(ChildrenOffset + NumChildren * sizeof(FNode*), alignof(FEntry));
+		}
+		static constexpr int64 GetSize(const int32 NumEntries, const int32 NumChildren)
+		{
+			return GetEntriesOffset(NumChildren) + NumEntries * sizeof(FEntry);
+		}
+
+		FORCEINLINE FNode** GetChildren()
+		{
+			return reinterpret_cast<FNode**>(reinterpret_cast<uint8*>(this) + ChildrenOffset);
+		}
+		FORCEINLINE FNode* const* GetChildren() const
+		{
+			return ConstCast(this)->GetChildren();
+		}
+		FORCEINLINE FEntry* GetEntries()
+		{
+			return reinterpret_cast<FEntry*>(reinterpret_cast<uint8*>(this) + GetEntriesOffset(NumChildren));
+		}
+		FORCEINLINE const FEntry* GetEntries() const
+		{
+			return ConstCast(this)->GetEntries();
+		}
+	};
+
+	FNode* Root = nullptr;
+	int32 NumEntries = 0;
+
+	FORCEINLINE static uint32 HashValue(const KeyType& Key)
+	{
+		// Nodes use the hash from its low bits up, make sure they are well distributed
+		return FVoxelUtilities::MurmurHash32(FVoxelUtilities::HashValue(Key));
+	}
+	FORCEINLINE static uint32 GetBit(const uint32 Hash, const int32 Shift)
+	{
+		checkVoxelSlow(Shift < 32);
+		return 1u << ((Hash >> Shift) & 31);
+	}
+	FORCEINLINE static int32 GetIndex(const uint32 Map, const uint32 Bit)
+	{
+		return FVoxelUtilities::CountBits(Map & (Bit - 1));
+	}
+
+	const FEntry* FindEntry(const uint32 Hash, const KeyType& Key) const
+	{
+		const FNode* Node = Root;
+		int32 Shift = 0;
+
+		while (Node)
+		{
+			if (Shift == CollisionShift)
+			{
+				for (const FEntry& Entry : MakeVoxelArrayView(Node->GetEntries(), Node->NumEntries))
+				{
+					if (Entry.Hash == Hash &&
+						Entry.Key == Key)
+					{
+						return &Entry;
+					}
+				}
+				return nullptr;
+			}
+
+			const uint32 Bit = GetBit(Hash, Shift);
+
+			if (Node->DataMap & Bit)
+			{
+				const FEntry& Entry = Node->GetEntries()[GetIndex(Node->DataMap, Bit)];
+				if (Entry.Hash == Hash &&
+					Entry.Key == Key)
+				{
+					return &Entry;
+				}
+				return nullptr;
+			}
+
+			if (!(Node->NodeMap & Bit))
+			{
+				return nullptr;
+			}
+
+			Node = Node->GetChildren()[GetIndex(Node->NodeMap, Bit)];
+			Shift += BitsPerLevel;
+		}
+
+		return nullptr;
+	}
+
+private:
+	// Returns false if the key was already there
+	template<typename InValueType>
+	static bool Insert(
+		FNode*& Node,
+		const int32 Shift,
+		const uint32 Hash,
+		const KeyType& Key,
+		InValueType&& Value)
+	{
+		MakeUnique(Node);
+
+		if (Shift == CollisionShift)
+		{
+			for (FEntry& Entry : MakeVoxelArrayView(Node->GetEntries(), Node->NumEntries))
+			{
+				if (Entry.Key == Key)
+				{
+					Entry.Value = Forward<InValueType>(Value);
+					return false;
+				}
+			}
+
+			FEntry NewEntry{ Key, ValueType(Forward<InValueType>(Value)), Hash };
+			Node = RebuildCollision(Node, -1, &NewEntry);
+			return true;
+		}
+
+		const uint32 Bit = GetBit(Hash, Shift);
+
+		if (Node->DataMap & Bit)
+		{
+			FEntry& Entry = Node->GetEntries()[GetIndex(Node->DataMap, Bit)];
+			if (Entry.Hash == Hash &&
+				Entry.Key == Key)
+			{
+				Entry.Value = Forward<InValueType>(Value);
+				return false;
+			}
+
+			// Push both entries down a level
+			FEntry NewEntry{ Key, ValueType(Forward<InValueType>(Value)), Hash };
+			FNode* Child = MergeEntries(MoveTemp(Entry), MoveTemp(NewEntry), Shift + BitsPerLevel);
+
+			Node = Rebuild(Node, Node->DataMap & ~Bit, Node->NodeMap | Bit, nullptr, Child);
+			return true;
+		}
+
+		if (Node->NodeMap & Bit)
+		{
+			return Insert(
+				Node->GetChildren()[GetIndex(Node->NodeMap, Bit)],
+				Shift + BitsPerLevel,
+				Hash,
+				Key,
+				Forward<InValueType>(Value));
+		}
+
+		FEntry NewEntry{ Key, ValueType(Forward<InValueType>(Value)), Hash };
+		Node = Rebuild(Node, Node->DataMap | Bit, Node->NodeMap, &NewEntry, nullptr);
+		return true;
+	}
+
+	// Key must be in the map. Node is set to null if it ends up empty
+	static void RemoveImpl(
+		FNode*& Node,
+		const int32 Shift,
+		const uint32 Hash,
+		const KeyType& Key)
+	{
+		MakeUnique(Node);
+
+		if (Shift == CollisionShift)
+		{
+			int32 Index = 0;
+			while (!(Node->GetEntries()[Index].Key == Key))
+			{
+				Index++;
+				checkVoxelSlow(Index < Node->NumEntries);
+			}
+
+			if (Node->NumEntries == 1)
+			{
+				Release(Node);
+				Node = nullptr;
+				return;
+			}
+
+			Node = RebuildCollision(Node, Index, nullptr);
+			return;
+		}
+
+		const uint32 Bit = GetBit(Hash, Shift);
+
+		if (Node->DataMap & Bit)
+		{
+			checkVoxelSlow(Node->GetEntries()[GetIndex(Node->DataMap, Bit)].Key == Key);
+
+			if (Node->NumEntries == 1 &&
+				Node->NumChildren == 0)
+			{
+				Release(Node);
+				Node = nullptr;
+				return;
+			}
+
+			Node = Rebuild(Node, Node->DataMap & ~Bit, Node->NodeMap, nullptr, nullptr);
+			return;
+		}
+
+		checkVoxelSlow(Node->NodeMap & Bit);
+
+		FNode*& Child = Node->GetChildren()[GetIndex(Node->NodeMap, Bit)];
+		RemoveImpl(Child, Shift + BitsPerLevel, Hash, Key);
+
+		if (!Child)
+		{
+			if (Node->NumEntries == 0 &&
+				Node->NumChildren == 1)
+			{
+				Release(Node);
+				Node = nullptr;
+				return;
+			}
+
+			Node = Rebuild(Node, Node->DataMap, Node->NodeMap & ~Bit, nullptr, nullptr);
+			return;
+		}
+
+		// Keep nodes canonical: a child with a single entry is inlined into its parent
+		if (Child->NumEntries == 1 &&
+			Child->NumChildren == 0)
+		{
+			checkVoxelSlow(Child->NumRefs.Get() == 1);
+
+			FEntry Entry = MoveTemp(Child->GetEntries()[0]);
+			Node = Rebuild(Node, Node->DataMap | Bit, Node->NodeMap & ~Bit, &Entry, nullptr);
+		}
+	}
+
+	static FNode* MergeEntries(FEntry&& EntryA, FEntry&& EntryB, const int32 Shift)
+	{
+		if (Shift == CollisionShift)
+		{
+			FNode* Node = AllocateNode(2, 0);
+			new (&Node->GetEntries()[0]) FEntry(MoveTemp(EntryA));
+			new (&Node->GetEntries()[1]) FEntry(MoveTemp(EntryB));
+			return Node;
+		}
+
+		const uint32 BitA = GetBit(EntryA.Hash, Shift);
+		const uint32 BitB = GetBit(EntryB.Hash, Shift);
+
+		if (BitA == BitB)
+		{
+			FNode* Node = AllocateNode(0, 1);
+			Node->NodeMap = BitA;
+			Node->GetChildren()[0] = MergeEntries(MoveTemp(EntryA), MoveTemp(EntryB), Shift + BitsPerLevel);
+			return Node;
+		}
+
+		FNode* Node = AllocateNode(2, 0);
+		Node->DataMap = BitA | BitB;
+
+		const bool bSwap = BitB < BitA;
+		new (&Node->GetEntries()[bSwap ? 1 : 0]) FEntry(MoveTemp(EntryA));
+		new (&Node->GetEntries()[bSwap ? 0 : 1]) FEntry(MoveTemp(EntryB));
+		return Node;
+	}
+
+private:
+	static FNode* AllocateNode(const int32 NumNodeEntries, const int32 NumChildren)
+	{
+		const int64 Size = FNode::GetSize(NumNodeEntries, NumChildren);
+		INC_VOXEL_MEMORY_STAT_BY(STAT_VoxelPersistentMapMemory, Size);
+
+		void* Memory = FMemory::Malloc(Size, FMath::Max<int32>(alignof(FNode), alignof(FEntry)));
+
+		FNode* Node = new (Memory) FNode();
+		Node->NumRefs.Set(1, std::memory_order_relaxed);
+		Node->NumEntries = NumNodeEntries;
+		Node->NumChildren = NumChildren;
+		return Node;
+	}
+	// Entries must have been destroyed and children released
+	static void FreeNode(FNode* Node)
+	{
+		DEC_VOXEL_MEMORY_STAT_BY(STAT_VoxelPersistentMapMemory, FNode::GetSize(Node->NumEntries, Node->NumChildren));
+
+		Node->~FNode();
+		FMemory::Free(Node);
+	}
+	static void DestroyEntries(FNode* Node)
+	{
+		if constexpr (!std::is_trivially_destructible_v<FEntry>)
+		{
+			for (FEntry& Entry : MakeVoxelArrayView(Node->GetEntries(), Node->NumEntries))
+			{
+				Entry.~FEntry();
+			}
+		}
+	}
+
+	FORCEINLINE static void AddRef(FNode* Node)
+	{
+		if (Node)
+		{
+			Node->NumRefs.Increment(std::memory_order_relaxed);
+		}
+	}
+	static void Release(FNode* Node)
+	{
+		if (!Node ||
+			Node->NumRefs.Decrement_ReturnNew() > 0)
+		{
+			return;
+		}
+
+		for (FNode* Child : MakeVoxelArrayView(Node->GetChildren(), Node->NumChildren))
+		{
+			Release(Child);
+		}
+		DestroyEntries(Node);
+		FreeNode(Node);
+	}
+
+	// Copy Node if it is shared with other maps, so that it can be modified in place
+	// Only valid if the parent is unique too
+	FORCEINLINE static void MakeUnique(FNode*& Node)
+	{
+		if (Node->NumRefs.Get() == 1)
+		{
+			return;
+		}
+
+		FNode* NewNode = AllocateNode(Node->NumEntries, Node->NumChildren);
+		NewNode->DataMap = Node->DataMap;
+		NewNode->NodeMap = Node->NodeMap;
+
+		for (int32 Index = 0; Index < Node->NumChildren; Index++)
+		{
+			FNode* Child = Node->GetChildren()[Index];
+			AddRef(Child);
+			NewNode->GetChildren()[Index] = Child;
+		}
+		for (int32 Index = 0; Index < Node->NumEntries; Index++)
+		{
+			new (&NewNode->GetEntries()[Index]) FEntry(Node->GetEntries()[Index]);
+		}
+
+		Release(Node);
+		Node = NewNode;
+	}
+
+	// Node must be unique and is consumed
+	// Positions in NewDataMap but not in Node->DataMap take NewEntry, positions in NewNodeMap but not in Node->NodeMap take NewChild
+	// Entries and children not in the new maps are destroyed
+	static FNode* Rebuild(
+		FNode* Node,
+		const uint32 NewDataMap,
+		const uint32 NewNodeMap,
+		FEntry* NewEntry,
+		FNode* NewChild)
+	{
+		checkVoxelSlow(Node->NumRefs.Get() == 1);
+
+		FNode* NewNode = AllocateNode(FVoxelUtilities::CountBits(NewDataMap), FVoxelUtilities::CountBits(NewNodeMap));
+		NewNode->DataMap = NewDataMap;
+		NewNode->NodeMap = NewNodeMap;
+
+		{
+			int32 OldIndex = 0;
+			int32 NewIndex = 0;
+			for (uint32 Bits = Node->DataMap | NewDataMap; Bits; Bits &= Bits - 1)
+			{
+				const uint32 Bit = Bits & (~Bits + 1);
+
+				if (!(NewDataMap & Bit))
+				{
+					OldIndex++;
+					continue;
+				}
+
+				FEntry& Entry = (Node->DataMap & Bit) ? Node->GetEntries()[OldIndex++] : *NewEntry;
+				new (&NewNode->GetEntries()[NewIndex++]) FEntry(MoveTemp(Entry));
+			}
+		}
+
+		{
+			int32 OldIndex = 0;
+			int32 NewIndex = 0;
+			for (uint32 Bits = Node->NodeMap | NewNodeMap; Bits; Bits &= Bits - 1)
+			{
+				const uint32 Bit = Bits & (~Bits + 1);
+
+				if (!(NewNodeMap & Bit))
+				{
+					Release(Node->GetChildren()[OldIndex++]);
+					continue;
+				}
+
+				NewNode->GetChildren()[NewIndex++] = (Node->NodeMap & Bit) ? Node->GetChildren()[OldIndex++] : NewChild;
+			}
+		}
+
+		DestroyEntries(Node);
+		FreeNode(Node);
+		return NewNode;
+	}
+	// Node must be unique and is consumed
+	static FNode* RebuildCollision(
+		FNode* Node,
+		const int32 IndexToRemove,
+		FEntry* NewEntry)
+	{
+		checkVoxelSlow(Node->NumRefs.Get() == 1);
+		checkVoxelSlow(Node->NumChildren == 0);
+
+		FNode* NewNode = AllocateNode(Node->NumEntries + (IndexToRemove == -1 ? 0 : -1) + (NewEntry ? 1 : 0), 0);
+
+		int32 NewIndex = 0;
+		for (int32 Index = 0; Index < Node->NumEntries; Index++)
+		{
+			if (Index != IndexToRemove)
+			{
+				new (&NewNode->GetEntries()[NewIndex++]) FEntry(MoveTemp(Node->GetEntries()[Index]));
+			}
+		}
+		if (NewEntry)
+		{
+			new (&NewNode->GetEntries()[NewIndex++]) FEntry(MoveTemp(*NewEntry));
+		}
+		checkVoxelSlow(NewIndex == NewNode->NumEntries);
+
+		DestroyEntries(Node);
+		FreeNode(Node);
+		return NewNode;
+	}
+
+	static int64 GetAllocatedSize(const FNode* Node)
+	{
+		if (!Node)
+		{
+			return 0;
+		}
+
+		int64 AllocatedSize = FNode::GetSize(Node->NumEntries, Node->NumChildren);
+		for (const FNode* Child : MakeVoxelArrayView(Node->GetChildren(), Node->NumChildren))
+		{
+			AllocatedSize += GetAllocatedSize(Child);
+		}
+		return AllocatedSize;
+	}
+};
\ No newline at end of file
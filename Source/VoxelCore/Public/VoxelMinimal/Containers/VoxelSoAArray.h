@@ -0,0 +1,446 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+#include "VoxelMinimal/Containers/VoxelArrayView.h"
+
+template<typename... Ts>
+class TVoxelSoAArray;
+
+// View over the columns of a structure-of-arrays, all columns have the same length
+// Like TVoxelArrayView constness is shallow: use TVoxelSoAArrayView<const Ts...> for read-only access
+template<typename... Ts>
+class TVoxelSoAArrayView
+{
+public:
+	static constexpr int32 NumColumns = sizeof...(Ts);
+
+	template<int32 ColumnIndex>
+	using TColumnType = typename TTupleElement<ColumnIndex, TTuple<Ts...>>::Type;
+
+	TVoxelSoAArrayView() = default;
+	explicit TVoxelSoAArrayView(const TVoxelArrayView<Ts>&... Columns)
+		: ColumnData{ ConstCast(Columns.GetData())... }
+	{
+		const int32 Nums[] = { Columns.Num()... };
+		ArrayNum = Nums[0];
+		checkVoxelSlow(((Columns.Num() == ArrayNum) && ...));
+	}
+
+	// Mutable to const view
+	template<typename... OtherTypes>
+	requires
+	(
+		sizeof...(OtherTypes) == sizeof...(Ts) &&
+		(std::is_same_v<const OtherTypes, Ts> && ...) &&
+		!(std::is_same_v<OtherTypes, Ts> && ...)
+	)
+	TVoxelSoAArrayView(const TVoxelSoAArrayView<OtherTypes...>& Other)
+		: ArrayNum(Other.ArrayNum)
+	{
+		FMemory::Memcpy(ColumnData, Other.ColumnData, sizeof(ColumnData));
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return ArrayNum;
+	}
+	FORCEINLINE bool IsValidIndex(const int32 Index) const
+	{
+		return 0 <= Index && Index < ArrayNum;
+	}
+	FORCEINLINE bool IsValidSlice(const int32 Index, const int32 InNum) const
+	{
+		return
+			InNum == 0 ||
+			(InNum > 0 && IsValidIndex(Index) && IsValidIndex(Index + InNum - 1));
+	}
+
+	template<int32 ColumnIndex>
+	FORCEINLINE TVoxelArrayView<TColumnType<ColumnIndex>> GetColumn() const
+	{
+		checkStatic(0 <= ColumnIndex && ColumnIndex < NumColumns);
+		return TVoxelArrayView<TColumnType<ColumnIndex>>(static_cast<TColumnType<ColumnIndex>*>(ColumnData[ColumnIndex]), ArrayNum);
+	}
+	template<int32 ColumnIndex>
+	FORCEINLINE TColumnType<ColumnIndex>& Get(const int32 Index) const
+	{
+		checkStatic(0 <= ColumnIndex && ColumnIndex < NumColumns);
+		checkVoxelSlow(IsValidIndex(Index));
+		return static_cast<TColumnType<ColumnIndex>*>(ColumnData[ColumnIndex])[Index];
+	}
+
+public:
+	TVoxelSoAArrayView Slice(const int32 Index, const int32 InNum) const
+	{
+		checkVoxelSlow(IsValidSlice(Index, InNum));
+
+		TVoxelSoAArrayView Result;
+		for (int32 ColumnIndex = 0; ColumnIndex < NumColumns; ColumnIndex++)
+		{
+			Result.ColumnData[ColumnIndex] = static_cast<uint8*>(ColumnData[ColumnIndex]) + int64(Index) * ColumnTypeSizes[ColumnIndex];
+		}
+		Result.ArrayNum = InNum;
+		return Result;
+	}
+	FORCEINLINE TVoxelSoAArrayView LeftOf(const int32 Index) const
+	{
+		return Slice(0, Index);
+	}
+	FORCEINLINE TVoxelSoAArrayView RightOf(const int32 Index) const
+	{
+		return Slice(Index, ArrayNum - Index);
+	}
+
+	// Swap the elements in all columns
+	FORCEINLINE void Swap(const int32 IndexA, const int32 IndexB) const
+	{
+		checkVoxelSlow(IsValidIndex(IndexA));
+		checkVoxelSlow(IsValidIndex(IndexB));
+
+		this->ForEachColumn([&](auto* Column)
+		{
+			::Swap(Column[IndexA], Column[IndexB]);
+		});
+	}
+	// Result[Index] = this[Indices[Index]], in all columns
+	TVoxelSoAArray<std::remove_const_t<Ts>...> Gather(const TConstVoxelArrayView<int32> Indices) const
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Indices.Num(), 1024);
+
+		TVoxelSoAArray<std::remove_const_t<Ts>...> Result;
+		Result.SetNum(Indices.Num());
+
+		ForEachColumnPair(Result.View(), [&](auto* ResultColumn, const auto* Column)
+		{
+			for (int32 Index = 0; Index < Indices.Num(); Index++)
+			{
+				checkVoxelSlow(IsValidIndex(Indices[Index]));
+				ResultColumn[Index] = Column[Indices[Index]];
+			}
+		});
+
+		return Result;
+	}
+
+	// Calls Lambda(Column) with a pointer to the first element of each column
+	template<typename LambdaType>
+	FORCEINLINE void ForEachColumn(LambdaType&& Lambda) const
+	{
+		[&]<int32... ColumnIndices>(std::integer_sequence<int32, ColumnIndices...>)
+		{
+			(Lambda(static_cast<TColumnType<ColumnIndices>*>(ColumnData[ColumnIndices])), ...);
+		}(std::make_integer_sequence<int32, NumColumns>());
+	}
+	// Calls Lambda(OtherColumn, Column) for each column of this and Other
+	template<typename... OtherTypes, typename LambdaType>
+	FORCEINLINE void ForEachColumnPair(const TVoxelSoAArrayView<OtherTypes...>& Other, LambdaType&& Lambda) const
+	{
+		checkStatic(sizeof...(OtherTypes) == NumColumns);
+
+		[&]<int32... ColumnIndices>(std::integer_sequence<int32, ColumnIndices...>)
+		{
+			(Lambda(
+				static_cast<typename TVoxelSoAArrayView<OtherTypes...>::template TColumnType<ColumnIndices>*>(Other.ColumnData[ColumnIndices]),
+				static_cast<TColumnType<ColumnIndices>*>(ColumnData[ColumnIndices])), ...);
+		}(std::make_integer_sequence<int32, NumColumns>());
+	}
+
+private:
+	static constexpr int64 ColumnTypeSizes[] = { sizeof(Ts)... };
+
+	void* ColumnData[NumColumns] = {};
+	int32 ArrayNum = 0;
+
+	template<typename...>
+	friend class TVoxelSoAArrayView;
+	template<typename...>
+	friend class TVoxelSoAArray;
+};
+
+// Structure-of-arrays container: each Ts is stored in its own column, all columns have the same length
+// Columns share a single allocation and each of them starts on a cache line, so they can be passed as-is to ISPC
+// Elements must be trivially copyable and are left uninitialized by SetNum
+// Name columns with an enum to keep the call sites readable, eg Elements.Get<EElement::MinX>(Index)
+template<typename... Ts>
+class TVoxelSoAArray
+{
+public:
+	checkStatic(sizeof...(Ts) > 0);
+	checkStatic((std::is_trivially_copyable_v<Ts> && ...));
+	checkStatic(!(std::is_const_v<Ts> || ...));
+
+	using FView = TVoxelSoAArrayView<Ts...>;
+	using FConstView = TVoxelSoAArrayView<const Ts...>;
+
+	static constexpr int32 NumColumns = sizeof...(Ts);
+	static constexpr int32 ColumnAlignment = PLATFORM_CACHE_LINE_SIZE;
+
+	template<int32 ColumnIndex>
+	using TColumnType = typename FView::template TColumnType<ColumnIndex>;
+
+	TVoxelSoAArray() = default;
+	explicit TVoxelSoAArray(const FConstView& Other)
+	{
+		CopyFrom(Other);
+	}
+	TVoxelSoAArray(const TVoxelSoAArray& Other)
+	{
+		CopyFrom(Other.View());
+	}
+	TVoxelSoAArray(TVoxelSoAArray&& Other)
+	{
+		*this = MoveTemp(Other);
+	}
+	~TVoxelSoAArray()
+	{
+		FMemory::Free(Allocation);
+	}
+
+	TVoxelSoAArray& operator=(const TVoxelSoAArray& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			CopyFrom(Other.View());
+		}
+		return *this;
+	}
+	TVoxelSoAArray& operator=(TVoxelSoAArray&& Other)
+	{
+		if (this != &Other)
+		{
+			FMemory::Free(Allocation);
+
+			Allocation = Other.Allocation;
+			Columns = Other.Columns;
+			ArrayMax = Other.ArrayMax;
+
+			Other.Allocation = nullptr;
+			Other.Columns = {};
+			Other.ArrayMax = 0;
+		}
+		return *this;
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return Columns.ArrayNum;
+	}
+	FORCEINLINE int32 Max() const
+	{
+		return ArrayMax;
+	}
+	FORCEINLINE bool IsValidIndex(const int32 Index) const
+	{
+		return Columns.IsValidIndex(Index);
+	}
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return GetAllocationSize(ArrayMax);
+	}
+
+	FORCEINLINE FView View()
+	{
+		return Columns;
+	}
+	FORCEINLINE FConstView View() const
+	{
+		return Columns;
+	}
+	FORCEINLINE operator FView()
+	{
+		return Columns;
+	}
+	FORCEINLINE operator FConstView() const
+	{
+		return Columns;
+	}
+
+	template<int32 ColumnIndex>
+	FORCEINLINE TVoxelArrayView<TColumnType<ColumnIndex>> GetColumn()
+	{
+		return Columns.template GetColumn<ColumnIndex>();
+	}
+	template<int32 ColumnIndex>
+	FORCEINLINE TConstVoxelArrayView<TColumnType<ColumnIndex>> GetColumn() const
+	{
+		return Columns.template GetColumn<ColumnIndex>();
+	}
+	template<int32 ColumnIndex>
+	FORCEINLINE TColumnType<ColumnIndex>& Get(const int32 Index)
+	{
+		return Columns.template Get<ColumnIndex>(Index);
+	}
+	template<int32 ColumnIndex>
+	FORCEINLINE const TColumnType<ColumnIndex>& Get(const int32 Index) const
+	{
+		return Columns.template Get<ColumnIndex>(Index);
+	}
+
+public:
+	void Reserve(const int32 Number)
+	{
+		if (Number > ArrayMax)
+		{
+			Reallocate(Number);
+		}
+	}
+	// New elements are not initialized
+	// Grows geometrically, call Reserve first to allocate the exact size
+	void SetNum(const int32 Number)
+	{
+		checkVoxelSlow(Number >= 0);
+
+		if (Number > ArrayMax)
+		{
+			Reallocate(FMath::Max(Number, 2 * ArrayMax));
+		}
+		Columns.ArrayNum = Number;
+	}
+	void SetNumZeroed(const int32 Number)
+	{
+		const int32 OldNum = Num();
+		SetNum(Number);
+
+		if (Number > OldNum)
+		{
+			Columns.ForEachColumn([&](auto* Column)
+			{
+				FMemory::Memzero(Column + OldNum, (Number - OldNum) * sizeof(*Column));
+			});
+		}
+	}
+	FORCEINLINE void Reset()
+	{
+		Columns.ArrayNum = 0;
+	}
+	void Empty()
+	{
+		Reset();
+		Reallocate(0);
+	}
+	void Shrink()
+	{
+		if (ArrayMax != Num())
+		{
+			Reallocate(Num());
+		}
+	}
+
+	// Values are taken by copy as they might be elements of this array, freed when growing
+	FORCEINLINE int32 Add(const Ts... Values)
+	{
+		const int32 Index = Num();
+		if (Index == ArrayMax)
+		{
+			Reallocate(FMath::Max(16, 2 * ArrayMax));
+		}
+		Columns.ArrayNum++;
+
+		[&]<int32... ColumnIndices>(std::integer_sequence<int32, ColumnIndices...>)
+		{
+			((Columns.template Get<ColumnIndices>(Index) = Values), ...);
+		}(std::make_integer_sequence<int32, NumColumns>());
+
+		return Index;
+	}
+	FORCEINLINE void Swap(const int32 IndexA, const int32 IndexB)
+	{
+		Columns.Swap(IndexA, IndexB);
+	}
+	// Moves the last element into Index, does not preserve order
+	FORCEINLINE void RemoveAtSwap(const int32 Index)
+	{
+		checkVoxelSlow(IsValidIndex(Index));
+
+		const int32 LastIndex = Num() - 1;
+		if (Index != LastIndex)
+		{
+			Columns.ForEachColumn([&](auto* Column)
+			{
+				Column[Index] = Column[LastIndex];
+			});
+		}
+		Columns.ArrayNum--;
+	}
+	// Result[Index] = this[Indices[Index]], in all columns
+	FORCEINLINE TVoxelSoAArray Gather(const TConstVoxelArrayView<int32> Indices) const
+	{
+		return View().Gather(Indices);
+	}
+
+private:
+	void* Allocation = nullptr;
+	FView Columns;
+	int32 ArrayMax = 0;
+
+	FORCEINLINE static int64 GetColumnSize(const int64 ElementSize, const int32 Number)
+	{
+		return Align(ElementSize * Number, ColumnAlignment);
+	}
+	static int64 GetAllocationSize(const int32 Number)
+	{
+		int64 Size = 0;
+		for (const int64 ElementSize : FView::ColumnTypeSizes)
+		{
+			Size += GetColumnSize(ElementSize, Number);
+		}
+		return Size;
+	}
+
+	void CopyFrom(const FConstView& Other)
+	{
+		Reserve(Other.Num());
+		SetNum(Other.Num());
+
+		if (Other.Num() == 0)
+		{
+			return;
+		}
+
+		Columns.ForEachColumnPair(Other, [&](const auto* OtherColumn, auto* Column)
+		{
+			FMemory::Memcpy(Column, OtherColumn, Other.Num() * sizeof(*Column));
+		});
+	}
+	void Reallocate(const int32 NewMax)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(NewMax, 1024);
+		checkVoxelSlow(NewMax >= Num());
+
+		void* NewAllocation = nullptr;
+		FView NewColumns;
+		NewColumns.ArrayNum = Num();
+
+		if (NewMax > 0)
+		{
+			NewAllocation = FMemory::Malloc(GetAllocationSize(NewMax), ColumnAlignment);
+
+			uint8* ColumnStart = static_cast<uint8*>(NewAllocation);
+			for (int32 ColumnIndex = 0; ColumnIndex < NumColumns; ColumnIndex++)
+			{
+				NewColumns.ColumnData[ColumnIndex] = ColumnStart;
+				ColumnStart += GetColumnSize(FView::ColumnTypeSizes[ColumnIndex], NewMax);
+			}
+
+			for (int32 ColumnIndex = 0; ColumnIndex < NumColumns && Num() > 0; ColumnIndex++)
+			{
+				FMemory::Memcpy(
+					NewColumns.ColumnData[ColumnIndex],
+					Columns.ColumnData[ColumnIndex],
+					Num() * FView::ColumnTypeSizes[ColumnIndex]);
+			}
+		}
+
+		FMemory::Free(Allocation);
+
+		Allocation = NewAllocation;
+		Columns = NewColumns;
+		ArrayMax = NewMax;
+	}
+};
\ No newline at end of file
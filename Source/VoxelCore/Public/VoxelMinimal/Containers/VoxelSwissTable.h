@@ -0,0 +1,778 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/Containers/VoxelSet.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+#include "VoxelMinimal/Utilities/VoxelTypeUtilities.h"
+#include "VoxelMinimal/Utilities/VoxelHashUtilities.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS && !PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#define VOXEL_SWISS_TABLE_SSE 1
+#else
+#define VOXEL_SWISS_TABLE_SSE 0
+#endif
+
+namespace Voxel::SwissTable
+{
+	static constexpr int32 GroupSize = 16;
+
+	// Control bytes: Empty or 7 bits of the hash of the element in the slot
+	// There are no tombstones: removal shifts the following elements back instead
+	static constexpr uint8 Empty = 0x80;
+
+	// 16 control bytes, loaded unaligned starting at any slot
+	struct FGroup
+	{
+#if VOXEL_SWISS_TABLE_SSE
+		__m128i Controls;
+
+		FORCEINLINE explicit FGroup(const uint8* Ptr)
+			: Controls(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Ptr)))
+		{
+		}
+
+		// Bit N is set if slot N might hold an element with this hash
+		FORCEINLINE uint32 Match(const uint8 Hash7) const
+		{
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Hash7), Controls));
+		}
+		FORCEINLINE uint32 MatchEmpty() const
+		{
+			// Empty is the only control byte with the high bit set
+			return _mm_movemask_epi8(Controls);
+		}
+#else
+		// SWAR fallback, two bytes lanes of 8
+		uint64 Controls[2];
+
+		FORCEINLINE explicit FGroup(const uint8* Ptr)
+		{
+			FMemory::Memcpy(Controls, Ptr, sizeof(Controls));
+		}
+
+		FORCEINLINE static uint32 MoveMask(const uint64 HighBits)
+		{
+			// Gather the high bit of every byte into the low 8 bits
+			return uint32(((HighBits >> 7) * 0x0102040810204080ull) >> 56);
+		}
+		FORCEINLINE static uint32 MatchZeroBytes(const uint64 Value)
+		{
+			// Can have false positives above a true zero byte, fine as keys are always compared
+			return MoveMask((Value - 0x0101010101010101ull) & ~Value & 0x8080808080808080ull);
+		}
+
+		FORCEINLINE uint32 Match(const uint8 Hash7) const
+		{
+			const uint64 Pattern = 0x0101010101010101ull * Hash7;
+			return
+				MatchZeroBytes(Controls[0] ^ Pattern) |
+				(MatchZeroBytes(Controls[1] ^ Pattern) << 8);
+		}
+		FORCEINLINE uint32 MatchEmpty() const
+		{
+			return
+				MoveMask(Controls[0] & 0x8080808080808080ull) |
+				(MoveMask(Controls[1] & 0x8080808080808080ull) << 8);
+		}
+#endif
+	};
+}
+
+template<typename KeyType, typename ValueType>
+struct TVoxelSwissMapElement
+{
+	const KeyType Key;
+	ValueType Value;
+
+	template<typename InValueType>
+	FORCEINLINE TVoxelSwissMapElement(
+		const KeyType& Key,
+		InValueType&& Value)
+		: Key(Key)
+		, Value(Forward<InValueType>(Value))
+	{
+	}
+};
+
+template<typename KeyType>
+struct TVoxelSwissSetElement
+{
+	const KeyType Key;
+
+	FORCEINLINE explicit TVoxelSwissSetElement(const KeyType& Key)
+		: Key(Key)
+	{
+	}
+};
+
+// Open addressing hash table storing elements inline, Swiss-table style
+// Each slot has a control byte with 7 bits of the hash: lookups compare 16 control bytes at once and only touch
+// elements whose 7 bits match, misses usually stop at the first group
+// Probing is linear starting at the hashed slot, removal shifts the following elements back so there are no tombstones
+// Pointers to elements are invalidated by any add or remove
+template<typename KeyType, typename ElementType>
+class TVoxelSwissTable
+{
+public:
+	// Max load factor of 7/8
+	static constexpr int32 MaxLoadNumerator = 7;
+	static constexpr int32 MaxLoadDenominator = 8;
+
+	TVoxelSwissTable() = default;
+	TVoxelSwissTable(const TVoxelSwissTable& Other)
+	{
+		*this = Other;
+	}
+	TVoxelSwissTable(TVoxelSwissTable&& Other)
+	{
+		*this = MoveTemp(Other);
+	}
+	TVoxelSwissTable& operator=(const TVoxelSwissTable& Other)
+	{
+		if (this == &Other)
+		{
+			return *this;
+		}
+
+		Reset();
+		Reserve(Other.Num());
+
+		Other.ForeachIndex([&](const int32 Index)
+		{
+			const ElementType& Element = Other.GetElement(Index);
+			new (GetSlot(AddIndexHashed_CheckNew(HashValue(Element.Key)))) ElementType(Element);
+		});
+
+		return *this;
+	}
+	TVoxelSwissTable& operator=(TVoxelSwissTable&& Other)
+	{
+		Empty();
+
+		Controls = MoveTemp(Other.Controls);
+		Slots = MoveTemp(Other.Slots);
+		NumElements = Other.NumElements;
+		Other.NumElements = 0;
+
+		return *this;
+	}
+	~TVoxelSwissTable()
+	{
+		Empty();
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return NumElements;
+	}
+	FORCEINLINE int32 GetCapacity() const
+	{
+		return Slots.Num();
+	}
+	FORCEINLINE int64 GetAllocatedSize() const
+	{
+		return Controls.GetAllocatedSize() + Slots.GetAllocatedSize();
+	}
+
+	void Reset()
+	{
+		DestructElements();
+
+		if (Controls.Num() > 0)
+		{
+			FVoxelUtilities::Memset(Controls, Voxel::SwissTable::Empty);
+		}
+	}
+	void Empty()
+	{
+		DestructElements();
+
+		Controls.Empty();
+		Slots.Empty();
+	}
+	void Reserve(const int32 Number)
+	{
+		const int32 NewCapacity = GetCapacityForNum(Number);
+		if (NewCapacity <= GetCapacity())
+		{
+			return;
+		}
+
+		Rehash(NewCapacity);
+	}
+
+	FORCEINLINE static uint32 HashValue(const KeyType& Key)
+	{
+		return FVoxelUtilities::HashValue(Key);
+	}
+
+protected:
+	FORCEINLINE ElementType& GetElement(const int32 Index)
+	{
+		checkVoxelSlow(Controls[Index] != Voxel::SwissTable::Empty);
+		return *reinterpret_cast<ElementType*>(&Slots[Index]);
+	}
+	FORCEINLINE const ElementType& GetElement(const int32 Index) const
+	{
+		return ConstCast(this)->GetElement(Index);
+	}
+	// Raw storage of a slot returned by AddIndexHashed_CheckNew
+	FORCEINLINE void* GetSlot(const int32 Index)
+	{
+		return &Slots[Index];
+	}
+
+	// -1 if not found
+	FORCEINLINE int32 FindIndexHashed(const uint32 Hash, const KeyType& Key) const
+	{
+		checkVoxelSlow(HashValue(Key) == Hash);
+
+		if (NumElements == 0)
+		{
+			return -1;
+		}
+
+		const uint32 MixedHash = MixHash(Hash);
+		const uint8 Hash7 = GetHash7(MixedHash);
+		const int32 Mask = GetCapacity() - 1;
+
+		int32 GroupStart = GetHomeIndex(MixedHash);
+		while (true)
+		{
+			const Voxel::SwissTable::FGroup Group(&Controls[GroupStart]);
+
+			uint32 Matches = Group.Match(Hash7);
+			while (Matches)
+			{
+				const int32 Index = (GroupStart + FMath::CountTrailingZeros(Matches)) & Mask;
+				Matches &= Matches - 1;
+
+				if (GetElement(Index).Key == Key)
+				{
+					return Index;
+				}
+			}
+
+			// Elements are never stored past an empty slot of their probe sequence
+			if (Group.MatchEmpty())
+			{
+				return -1;
+			}
+
+			GroupStart = (GroupStart + Voxel::SwissTable::GroupSize) & Mask;
+		}
+	}
+
+	// Returns the index of an empty slot, the element must be constructed there by the caller
+	FORCEINLINE int32 AddIndexHashed_CheckNew(const uint32 Hash)
+	{
+		if (NumElements + 1 > GetMaxNum(GetCapacity()))
+		{
+			Rehash(GetCapacityForNum(NumElements + 1));
+		}
+
+		const int32 Index = FindEmptyIndex(MixHash(Hash));
+		SetControl(Index, GetHash7(MixHash(Hash)));
+		NumElements++;
+		return Index;
+	}
+
+	FORCEINLINE void RemoveIndex(int32 Index)
+	{
+		const int32 Mask = GetCapacity() - 1;
+
+		GetElement(Index).~ElementType();
+		NumElements--;
+
+		// Backward shift: move back the following elements whose probe sequence went through the hole
+		int32 NextIndex = (Index + 1) & Mask;
+		while (Controls[NextIndex] != Voxel::SwissTable::Empty)
+		{
+			ElementType& NextElement = GetElement(NextIndex);
+			const int32 HomeIndex = GetHomeIndex(MixHash(HashValue(NextElement.Key)));
+
+			if (((Index - HomeIndex) & Mask) < ((NextIndex - HomeIndex) & Mask))
+			{
+				new (&Slots[Index]) ElementType(MoveTemp(NextElement));
+				NextElement.~ElementType();
+
+				SetControl(Index, Controls[NextIndex]);
+				Index = NextIndex;
+			}
+
+			NextIndex = (NextIndex + 1) & Mask;
+		}
+
+		SetControl(Index, Voxel::SwissTable::Empty);
+	}
+
+	template<typename LambdaType>
+	FORCEINLINE void ForeachIndex(LambdaType&& Lambda) const
+	{
+		for (int32 Index = 0; Index < GetCapacity(); Index++)
+		{
+			if (Controls[Index] != Voxel::SwissTable::Empty)
+			{
+				Lambda(Index);
+			}
+		}
+	}
+	// Capacity if there are no more elements
+	FORCEINLINE int32 GetNextIndex(int32 Index) const
+	{
+		while (Index < GetCapacity() &&
+			Controls[Index] == Voxel::SwissTable::Empty)
+		{
+			Index++;
+		}
+		return Index;
+	}
+
+private:
+	// Capacity + GroupSize - 1 bytes: the first GroupSize - 1 control bytes are mirrored at the end
+	// so that groups can be loaded from any slot without wrapping around
+	TVoxelArray<uint8> Controls;
+	TVoxelArray<TTypeCompatibleBytes<ElementType>> Slots;
+	int32 NumElements = 0;
+
+	FORCEINLINE static uint32 MixHash(const uint32 Hash)
+	{
+		// FVoxelUtilities::HashValue is the identity for integers
+		return FVoxelUtilities::MurmurHash32(Hash);
+	}
+	// Top bits for the control byte, low bits for the slot: only correlated past 2^25 slots
+	FORCEINLINE static uint8 GetHash7(const uint32 MixedHash)
+	{
+		return MixedHash >> 25;
+	}
+	FORCEINLINE int32 GetHomeIndex(const uint32 MixedHash) const
+	{
+		checkVoxelSlow(FMath::IsPowerOfTwo(GetCapacity()));
+		return MixedHash & (GetCapacity() - 1);
+	}
+
+	FORCEINLINE static int32 GetMaxNum(const int32 Capacity)
+	{
+		return Capacity / MaxLoadDenominator * MaxLoadNumerator;
+	}
+	FORCEINLINE static int32 GetCapacityForNum(const int32 Number)
+	{
+		if (Number == 0)
+		{
+			return 0;
+		}
+
+		int32 Capacity = Voxel::SwissTable::GroupSize;
+		while (GetMaxNum(Capacity) < Number)
+		{
+			Capacity *= 2;
+		}
+		return Capacity;
+	}
+
+	FORCEINLINE void SetControl(const int32 Index, const uint8 Control)
+	{
+		Controls[Index] = Control;
+
+		if (Index < Voxel::SwissTable::GroupSize - 1)
+		{
+			Controls[GetCapacity() + Index] = Control;
+		}
+	}
+	FORCEINLINE int32 FindEmptyIndex(const uint32 MixedHash) const
+	{
+		const int32 Mask = GetCapacity() - 1;
+
+		int32 GroupStart = GetHomeIndex(MixedHash);
+		while (true)
+		{
+			const uint32 EmptyMask = Voxel::SwissTable::FGroup(&Controls[GroupStart]).MatchEmpty();
+			if (EmptyMask)
+			{
+				return (GroupStart + FMath::CountTrailingZeros(EmptyMask)) & Mask;
+			}
+
+			GroupStart = (GroupStart + Voxel::SwissTable::GroupSize) & Mask;
+		}
+	}
+
+	void DestructElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<ElementType>)
+		{
+			ForeachIndex([&](const int32 Index)
+			{
+				GetElement(Index).~ElementType();
+			});
+		}
+
+		NumElements = 0;
+	}
+
+	FORCENOINLINE void Rehash(const int32 NewCapacity)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(NumElements, 1024);
+		checkVoxelSlow(FMath::IsPowerOfTwo(NewCapacity));
+		checkVoxelSlow(GetMaxNum(NewCapacity) >= NumElements);
+
+		TVoxelArray<uint8> OldControls = MoveTemp(Controls);
+		TVoxelArray<TTypeCompatibleBytes<ElementType>> OldSlots = MoveTemp(Slots);
+
+		FVoxelUtilities::SetNumFast(Controls, NewCapacity + Voxel::SwissTable::GroupSize - 1);
+		FVoxelUtilities::Memset(Controls, Voxel::SwissTable::Empty);
+		FVoxelUtilities::SetNumFast(Slots, NewCapacity);
+
+		for (int32 OldIndex = 0; OldIndex < OldSlots.Num(); OldIndex++)
+		{
+			if (OldControls[OldIndex] == Voxel::SwissTable::Empty)
+			{
+				continue;
+			}
+
+			ElementType& OldElement = *reinterpret_cast<ElementType*>(&OldSlots[OldIndex]);
+			const uint32 MixedHash = MixHash(HashValue(OldElement.Key));
+
+			const int32 Index = FindEmptyIndex(MixedHash);
+			SetControl(Index, GetHash7(MixedHash));
+
+			new (&Slots[Index]) ElementType(MoveTemp(OldElement));
+			OldElement.~ElementType();
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Open addressing variant of TVoxelMap, see TVoxelSwissTable
+// Faster lookups, especially misses, but iteration is over the whole capacity and elements aren't contiguous
+template<typename KeyType, typename ValueType>
+class TVoxelSwissMap : public TVoxelSwissTable<KeyType, TVoxelSwissMapElement<KeyType, ValueType>>
+{
+public:
+	using FElement = TVoxelSwissMapElement<KeyType, ValueType>;
+	using Super = TVoxelSwissTable<KeyType, FElement>;
+
+	using Super::HashValue;
+
+public:
+	FORCEINLINE ValueType* Find(const KeyType& Key)
+	{
+		return this->FindHashed(HashValue(Key), Key);
+	}
+	FORCEINLINE const ValueType* Find(const KeyType& Key) const
+	{
+		return ConstCast(this)->Find(Key);
+	}
+	FORCEINLINE ValueType* FindHashed(const uint32 Hash, const KeyType& Key)
+	{
+		const int32 Index = this->FindIndexHashed(Hash, Key);
+		if (Index == -1)
+		{
+			return nullptr;
+		}
+		return &this->GetElement(Index).Value;
+	}
+	FORCEINLINE const ValueType* FindHashed(const uint32 Hash, const KeyType& Key) const
+	{
+		return ConstCast(this)->FindHashed(Hash, Key);
+	}
+
+	FORCEINLINE ValueType& FindChecked(const KeyType& Key)
+	{
+		const int32 Index = this->FindIndexHashed(HashValue(Key), Key);
+		checkVoxelSlow(Index != -1);
+		return this->GetElement(Index).Value;
+	}
+	FORCEINLINE const ValueType& FindChecked(const KeyType& Key) const
+	{
+		return ConstCast(this)->FindChecked(Key);
+	}
+
+	FORCEINLINE bool Contains(const KeyType& Key) const
+	{
+		return this->FindIndexHashed(HashValue(Key), Key) != -1;
+	}
+
+	FORCEINLINE ValueType& operator[](const KeyType& Key)
+	{
+		return this->FindChecked(Key);
+	}
+	FORCEINLINE const ValueType& operator[](const KeyType& Key) const
+	{
+		return this->FindChecked(Key);
+	}
+
+public:
+	template<typename InKeyType>
+	requires
+	(
+		std::is_convertible_v<const InKeyType&, KeyType> &&
+		FVoxelUtilities::CanMakeSafe<ValueType>
+	)
+	FORCEINLINE ValueType& FindOrAdd(const InKeyType& Key)
+	{
+		const uint32 Hash = HashValue(Key);
+
+		if (ValueType* Value = this->FindHashed(Hash, Key))
+		{
+			return *Value;
+		}
+
+		return this->AddHashed_CheckNew(Hash, Key, FVoxelUtilities::MakeSafe<ValueType>());
+	}
+
+	// Will crash if Key is already in the map
+	template<typename InKeyType>
+	requires
+	(
+		std::is_convertible_v<const InKeyType&, KeyType> &&
+		FVoxelUtilities::CanMakeSafe<ValueType>
+	)
+	FORCEINLINE ValueType& Add_CheckNew(const InKeyType& Key)
+	{
+		return this->Add_CheckNew(Key, FVoxelUtilities::MakeSafe<ValueType>());
+	}
+	template<typename InValueType>
+	requires std::is_constructible_v<ValueType, InValueType&&>
+	FORCEINLINE ValueType& Add_CheckNew(const KeyType& Key, InValueType&& Value)
+	{
+		return this->AddHashed_CheckNew(HashValue(Key), Key, Forward<InValueType>(Value));
+	}
+	template<typename InValueType>
+	requires std::is_constructible_v<ValueType, InValueType&&>
+	FORCEINLINE ValueType& AddHashed_CheckNew(const uint32 Hash, const KeyType& Key, InValueType&& Value)
+	{
+		checkVoxelSlow(!this->Contains(Key));
+		checkVoxelSlow(HashValue(Key) == Hash);
+
+		const int32 Index = this->AddIndexHashed_CheckNew(Hash);
+		FElement* Element = new (this->GetSlot(Index)) FElement(Key, Forward<InValueType>(Value));
+		return Element->Value;
+	}
+
+public:
+	FORCEINLINE bool Remove(const KeyType& Key)
+	{
+		const int32 Index = this->FindIndexHashed(HashValue(Key), Key);
+		if (Index == -1)
+		{
+			return false;
+		}
+
+		this->RemoveIndex(Index);
+		return true;
+	}
+	FORCEINLINE void RemoveChecked(const KeyType& Key)
+	{
+		this->RemoveHashedChecked(HashValue(Key), Key);
+	}
+	FORCEINLINE void RemoveHashedChecked(const uint32 Hash, const KeyType& Key)
+	{
+		const int32 Index = this->FindIndexHashed(Hash, Key);
+		checkVoxelSlow(Index != -1);
+		this->RemoveIndex(Index);
+	}
+
+public:
+	template<bool bConst>
+	struct TIterator
+	{
+		template<typename T>
+		using TType = std::conditional_t<bConst, const T, T>;
+
+		TType<TVoxelSwissMap>* MapPtr = nullptr;
+		int32 Index = 0;
+
+		TIterator() = default;
+		FORCEINLINE explicit TIterator(TType<TVoxelSwissMap>& Map)
+			: MapPtr(&Map)
+			, Index(Map.GetNextIndex(0))
+		{
+		}
+
+		FORCEINLINE TIterator& operator++()
+		{
+			Index = MapPtr->GetNextIndex(Index + 1);
+			return *this;
+		}
+		FORCEINLINE explicit operator bool() const
+		{
+			return MapPtr && Index < MapPtr->GetCapacity();
+		}
+		FORCEINLINE TType<FElement>& operator*() const
+		{
+			return MapPtr->GetElement(Index);
+		}
+		FORCEINLINE TType<FElement>* operator->() const
+		{
+			return &MapPtr->GetElement(Index);
+		}
+		FORCEINLINE bool operator!=(const TIterator&) const
+		{
+			return bool(*this);
+		}
+
+		FORCEINLINE const KeyType& Key() const
+		{
+			return MapPtr->GetElement(Index).Key;
+		}
+		FORCEINLINE TType<ValueType>& Value() const
+		{
+			return MapPtr->GetElement(Index).Value;
+		}
+	};
+	using FIterator = TIterator<false>;
+	using FConstIterator = TIterator<true>;
+
+	FORCEINLINE FIterator begin()
+	{
+		return FIterator(*this);
+	}
+	FORCEINLINE FIterator end()
+	{
+		return {};
+	}
+
+	FORCEINLINE FConstIterator begin() const
+	{
+		return FConstIterator(*this);
+	}
+	FORCEINLINE FConstIterator end() const
+	{
+		return {};
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Open addressing variant of TVoxelSet, see TVoxelSwissTable
+// Indices are slot indices: they are invalidated by any add or remove
+template<typename Type>
+class TVoxelSwissSet : public TVoxelSwissTable<Type, TVoxelSwissSetElement<Type>>
+{
+public:
+	using FElement = TVoxelSwissSetElement<Type>;
+	using Super = TVoxelSwissTable<Type, FElement>;
+
+	using Super::HashValue;
+
+public:
+	FORCEINLINE const Type& GetValue(const FVoxelSetIndex& Index) const
+	{
+		return this->GetElement(Index).Key;
+	}
+
+	FORCEINLINE FVoxelSetIndex Find(const Type& Value) const
+	{
+		return this->FindHashed(HashValue(Value), Value);
+	}
+	FORCEINLINE FVoxelSetIndex FindHashed(const uint32 Hash, const Type& Value) const
+	{
+		return this->FindIndexHashed(Hash, Value);
+	}
+
+	FORCEINLINE bool Contains(const Type& Value) const
+	{
+		return this->Find(Value).IsValid();
+	}
+	FORCEINLINE bool ContainsHashed(const uint32 Hash, const Type& Value) const
+	{
+		return this->FindHashed(Hash, Value).IsValid();
+	}
+
+public:
+	// Will crash if Value is already in the set
+	FORCEINLINE FVoxelSetIndex Add_CheckNew(const Type& Value)
+	{
+		return this->AddHashed_CheckNew(HashValue(Value), Value);
+	}
+	FORCEINLINE FVoxelSetIndex AddHashed_CheckNew(const uint32 Hash, const Type& Value)
+	{
+		checkVoxelSlow(!this->Contains(Value));
+		checkVoxelSlow(HashValue(Value) == Hash);
+
+		const int32 Index = this->AddIndexHashed_CheckNew(Hash);
+		new (this->GetSlot(Index)) FElement(Value);
+		return Index;
+	}
+
+	FORCEINLINE FVoxelSetIndex Add(const Type& Value)
+	{
+		const uint32 Hash = HashValue(Value);
+
+		const FVoxelSetIndex Index = this->FindHashed(Hash, Value);
+		if (Index.IsValid())
+		{
+			return Index;
+		}
+
+		return this->AddHashed_CheckNew(Hash, Value);
+	}
+
+public:
+	FORCEINLINE bool Remove(const Type& Value)
+	{
+		const int32 Index = this->FindIndexHashed(HashValue(Value), Value);
+		if (Index == -1)
+		{
+			return false;
+		}
+
+		this->RemoveIndex(Index);
+		return true;
+	}
+	FORCEINLINE void RemoveChecked(const Type& Value)
+	{
+		const int32 Index = this->FindIndexHashed(HashValue(Value), Value);
+		checkVoxelSlow(Index != -1);
+		this->RemoveIndex(Index);
+	}
+
+public:
+	struct FIterator
+	{
+		const TVoxelSwissSet* SetPtr = nullptr;
+		int32 Index = 0;
+
+		FIterator() = default;
+		FORCEINLINE explicit FIterator(const TVoxelSwissSet& Set)
+			: SetPtr(&Set)
+			, Index(Set.GetNextIndex(0))
+		{
+		}
+
+		FORCEINLINE FIterator& operator++()
+		{
+			Index = SetPtr->GetNextIndex(Index + 1);
+			return *this;
+		}
+		FORCEINLINE explicit operator bool() const
+		{
+			return SetPtr && Index < SetPtr->GetCapacity();
+		}
+		FORCEINLINE const Type& operator*() const
+		{
+			return SetPtr->GetElement(Index).Key;
+		}
+		FORCEINLINE bool operator!=(const FIterator&) const
+		{
+			return bool(*this);
+		}
+	};
+
+	FORCEINLINE FIterator begin() const
+	{
+		return FIterator(*this);
+	}
+	FORCEINLINE FIterator end() const
+	{
+		return {};
+	}
+};
\ No newline at end of file
@@ -559,6 +559,48 @@ namespace FVoxelUtilities
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
 
+	// Stable parallel LSD radix sort, 8 bits per pass
+	// Passes over bits that are the same for all keys are skipped, so small key ranges are cheap
+	VOXELCORE_API void RadixSort(TVoxelArrayView<uint32> Keys);
+	VOXELCORE_API void RadixSort(TVoxelArrayView<uint64> Keys);
+
+	// Payloads are moved along with their keys, eg pass indices to sort SoA data by key
+	VOXELCORE_API void RadixSort(
+		TVoxelArrayView<uint32> Keys,
+		TVoxelArrayView<uint32> Payloads);
+	VOXELCORE_API void RadixSort(
+		TVoxelArrayView<uint64> Keys,
+		TVoxelArrayView<uint32> Payloads);
+
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+
+	// Large arrays are split in blocks processed in parallel, each block is scanned with SIMD
+	// Values and OutValues can be the same array. Sums must fit in an int32
+	// Returns the sum of all values
+	VOXELCORE_API int32 InclusiveScan(
+		TConstVoxelArrayView<int32> Values,
+		TVoxelArrayView<int32> OutValues);
+	VOXELCORE_API int32 ExclusiveScan(
+		TConstVoxelArrayView<int32> Values,
+		TVoxelArrayView<int32> OutValues);
+
+	// Indices of the true values, in increasing order
+	VOXELCORE_API void CompactIndices(
+		TConstVoxelArrayView<bool> Mask,
+		TVoxelArray<int32>& OutIndices);
+
+	// Indices of the true values followed by the indices of the false values, both in increasing order
+	// OutIndices must have as many elements as Mask. Returns the number of true values
+	VOXELCORE_API int32 PartitionIndices(
+		TConstVoxelArrayView<bool> Mask,
+		TVoxelArrayView<int32> OutIndices);
+
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+
 	VOXELCORE_API bool IsCompressedData(TConstVoxelArrayView64<uint8> CompressedData);
 
 	VOXELCORE_API TVoxelArray64<uint8> Compress(
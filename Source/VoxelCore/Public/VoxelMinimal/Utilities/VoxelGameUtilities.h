@@ -20,6 +20,7 @@ namespace FVoxelUtilities
 	//////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////////////
 
+	// See FVoxelInvokerChunkTracker for an incremental version returning added/removed chunks
 	VOXELCORE_API bool ComputeInvokerChunks(
 		TVoxelSet<FIntVector>& OutChunks,
 		TVoxelArray<FSphere> Invokers,
@@ -30,6 +30,49 @@ namespace FVoxelUtilities
 	{
 		return FMath::Sqrt(double(SizeSquared(V)));
 	}
+
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+
+	// Spread the 32 bits of Value so that there is one 0 bit between each bit
+	FORCEINLINE constexpr uint64 MortonDilate2D(const uint32 Value)
+	{
+		uint64 Result = Value;
+		Result = (Result | Result << 16) & 0x0000ffff0000ffff;
+		Result = (Result | Result << 8) & 0x00ff00ff00ff00ff;
+		Result = (Result | Result << 4) & 0x0f0f0f0f0f0f0f0f;
+		Result = (Result | Result << 2) & 0x3333333333333333;
+		Result = (Result | Result << 1) & 0x5555555555555555;
+		return Result;
+	}
+	FORCEINLINE constexpr uint32 MortonCompact2D(const uint64 Value)
+	{
+		uint64 Result = Value & 0x5555555555555555;
+		Result = (Result ^ (Result >> 1)) & 0x3333333333333333;
+		Result = (Result ^ (Result >> 2)) & 0x0f0f0f0f0f0f0f0f;
+		Result = (Result ^ (Result >> 4)) & 0x00ff00ff00ff00ff;
+		Result = (Result ^ (Result >> 8)) & 0x0000ffff0000ffff;
+		Result = (Result ^ (Result >> 16)) & 0x00000000ffffffff;
+		return uint32(Result);
+	}
+
+	// X is the lowest bit. Each component must be positive
+	FORCEINLINE uint64 MortonEncode2D(const FIntPoint& Position)
+	{
+		checkVoxelSlow(Position.X >= 0);
+		checkVoxelSlow(Position.Y >= 0);
+
+		return
+			(MortonDilate2D(Position.X) << 0) |
+			(MortonDilate2D(Position.Y) << 1);
+	}
+	FORCEINLINE FIntPoint MortonDecode2D(const uint64 Code)
+	{
+		return FIntPoint(
+			MortonCompact2D(Code >> 0),
+			MortonCompact2D(Code >> 1));
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -54,6 +54,51 @@ namespace FVoxelUtilities
 		return FMath::Sqrt(double(SizeSquared(Vector)));
 	}
 
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+	//////////////////////////////////////////////////////////////////////////////
+
+	// Spread the 21 low bits of Value so that there are two 0 bits between each bit
+	FORCEINLINE constexpr uint64 MortonDilate3D(const uint32 Value)
+	{
+		uint64 Result = Value & 0x1fffff;
+		Result = (Result | Result << 32) & 0x1f00000000ffff;
+		Result = (Result | Result << 16) & 0x1f0000ff0000ff;
+		Result = (Result | Result << 8) & 0x100f00f00f00f00f;
+		Result = (Result | Result << 4) & 0x10c30c30c30c30c3;
+		Result = (Result | Result << 2) & 0x1249249249249249;
+		return Result;
+	}
+	FORCEINLINE constexpr uint32 MortonCompact3D(const uint64 Value)
+	{
+		uint64 Result = Value & 0x1249249249249249;
+		Result = (Result ^ (Result >> 2)) & 0x10c30c30c30c30c3;
+		Result = (Result ^ (Result >> 4)) & 0x100f00f00f00f00f;
+		Result = (Result ^ (Result >> 8)) & 0x1f0000ff0000ff;
+		Result = (Result ^ (Result >> 16)) & 0x1f00000000ffff;
+		Result = (Result ^ (Result >> 32)) & 0x1fffff;
+		return uint32(Result);
+	}
+
+	// X is the lowest bit. Each component must be in [0, 2^21)
+	FORCEINLINE uint64 MortonEncode3D(const FIntVector& Position)
+	{
+		checkVoxelSlow(0 <= Position.X && Position.X < (1 << 21));
+		checkVoxelSlow(0 <= Position.Y && Position.Y < (1 << 21));
+		checkVoxelSlow(0 <= Position.Z && Position.Z < (1 << 21));
+
+		return
+			(MortonDilate3D(Position.X) << 0) |
+			(MortonDilate3D(Position.Y) << 1) |
+			(MortonDilate3D(Position.Z) << 2);
+	}
+	FORCEINLINE FIntVector MortonDecode3D(const uint64 Code)
+	{
+		return FIntVector(
+			MortonCompact3D(Code >> 0),
+			MortonCompact3D(Code >> 1),
+			MortonCompact3D(Code >> 2));
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -5,9 +5,12 @@
 #include "VoxelCoreMinimal.h"
 #include "Async/ParallelFor.h"
 #include "VoxelMinimal/VoxelFuture.h"
+#include "VoxelMinimal/VoxelIntBox.h"
+#include "VoxelMinimal/VoxelIntBox2D.h"
 #include "VoxelMinimal/Containers/VoxelMap.h"
 #include "VoxelMinimal/Containers/VoxelArray.h"
 #include "VoxelMinimal/Containers/VoxelArrayView.h"
+#include "VoxelMinimal/Utilities/VoxelArrayUtilities.h"
 #include "VoxelMinimal/Utilities/VoxelLambdaUtilities.h"
 
 namespace Voxel
@@ -343,6 +346,300 @@ void ParallelFor_Values(
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
+// Adaptive version of the ParallelFors above: each worker starts with an equal slice of [0, Num) and processes it GrainSize elements at a time
+// Workers done with their slice steal half of the largest remaining slice, so uneven per-element costs don't leave cores idle
+// GrainSize <= 0 picks one automatically
+VOXELCORE_API void ParallelFor_Adaptive(
+	int32 Num,
+	int32 GrainSize,
+	TFunctionRef<void(int32 WorkerIndex, int32 StartIndex, int32 EndIndex)> Lambda);
+
+// Number of workers ParallelFor_Adaptive will use, WorkerIndex is always less than this
+VOXELCORE_API int32 ParallelFor_Adaptive_GetNumWorkers(
+	int32 Num,
+	int32 GrainSize);
+
+template<
+	typename Type,
+	typename SizeType,
+	typename LambdaType,
+	typename = std::enable_if_t<
+		LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<Type, SizeType>)> ||
+		LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<const Type, SizeType>)> ||
+		LambdaHasSignature_V<LambdaType, void(Type&)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&)> ||
+		LambdaHasSignature_V<LambdaType, void(Type&, SizeType)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&, SizeType)>>>
+void ParallelFor(
+	const TVoxelArrayView<Type, SizeType> ArrayView,
+	const int32 GrainSize,
+	LambdaType Lambda)
+{
+	VOXEL_FUNCTION_COUNTER();
+	check(ArrayView.Num() <= MAX_int32);
+
+	ParallelFor_Adaptive(ArrayView.Num(), GrainSize, [&](int32, const int32 StartIndex, const int32 EndIndex)
+	{
+		if constexpr (
+			LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<Type, SizeType>)> ||
+			LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<const Type, SizeType>)>)
+		{
+			Lambda(ArrayView.Slice(StartIndex, EndIndex - StartIndex));
+		}
+		else if constexpr (
+			LambdaHasSignature_V<LambdaType, void(Type&)> ||
+			LambdaHasSignature_V<LambdaType, void(const Type&)>)
+		{
+			for (SizeType Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Lambda(ArrayView[Index]);
+			}
+		}
+		else if constexpr (
+			LambdaHasSignature_V<LambdaType, void(Type&, SizeType)> ||
+			LambdaHasSignature_V<LambdaType, void(const Type&, SizeType)>)
+		{
+			for (SizeType Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Lambda(ArrayView[Index], Index);
+			}
+		}
+		else
+		{
+			checkStatic(std::is_same_v<LambdaType, void>);
+		}
+	});
+}
+
+template<
+	typename Type,
+	typename Allocator,
+	typename LambdaType,
+	typename SizeType = typename Allocator::SizeType,
+	typename = std::enable_if_t<
+		LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<Type, SizeType>)> ||
+		LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<const Type, SizeType>)> ||
+		LambdaHasSignature_V<LambdaType, void(Type&)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&)> ||
+		LambdaHasSignature_V<LambdaType, void(Type&, SizeType)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&, SizeType)>>>
+void ParallelFor(
+	TArray<Type, Allocator>& Array,
+	const int32 GrainSize,
+	LambdaType Lambda)
+{
+	ParallelFor(
+		MakeVoxelArrayView(Array),
+		GrainSize,
+		MoveTemp(Lambda));
+}
+
+template<
+	typename Type,
+	typename Allocator,
+	typename LambdaType,
+	typename SizeType = typename Allocator::SizeType,
+	typename = std::enable_if_t<
+		LambdaHasSignature_V<LambdaType, void(TVoxelArrayView<const Type, SizeType>)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&)> ||
+		LambdaHasSignature_V<LambdaType, void(const Type&, SizeType)>>>
+void ParallelFor(
+	const TArray<Type, Allocator>& Array,
+	const int32 GrainSize,
+	LambdaType Lambda)
+{
+	ParallelFor(
+		MakeVoxelArrayView(Array),
+		GrainSize,
+		MoveTemp(Lambda));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// RangeLambda accumulates [StartIndex, EndIndex) into a per-worker accumulator initialized to Identity
+// Reduce then merges the accumulators: it must be associative and commutative, as ranges are stolen between workers
+template<typename ValueType, typename RangeLambdaType, typename ReduceLambdaType>
+requires LambdaHasSignature_V<RangeLambdaType, void(int32, int32, ValueType&)>
+ValueType ParallelReduce(
+	const int32 Num,
+	const ValueType& Identity,
+	RangeLambdaType RangeLambda,
+	ReduceLambdaType Reduce,
+	const int32 GrainSize = 0)
+{
+	VOXEL_FUNCTION_COUNTER_NUM(Num, 1024);
+
+	const int32 NumWorkers = ParallelFor_Adaptive_GetNumWorkers(Num, GrainSize);
+	if (NumWorkers == 0)
+	{
+		return Identity;
+	}
+
+	// Avoid false sharing between workers
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FAccumulator
+	{
+		ValueType Value;
+	};
+	TVoxelArray<FAccumulator> Accumulators;
+	Accumulators.Reserve(NumWorkers);
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; WorkerIndex++)
+	{
+		Accumulators.Add(FAccumulator{ Identity });
+	}
+
+	ParallelFor_Adaptive(Num, GrainSize, [&](const int32 WorkerIndex, const int32 StartIndex, const int32 EndIndex)
+	{
+		RangeLambda(StartIndex, EndIndex, Accumulators[WorkerIndex].Value);
+	});
+
+	ValueType Result = Identity;
+	for (const FAccumulator& Accumulator : Accumulators)
+	{
+		Result = Reduce(Result, Accumulator.Value);
+	}
+	return Result;
+}
+
+// Reduce(Transform(Array[0]), Transform(Array[1]), ...)
+// Reduce must be associative and commutative
+template<typename ArrayType, typename ValueType, typename TransformLambdaType, typename ReduceLambdaType>
+ValueType ParallelTransformReduce(
+	const ArrayType& Array,
+	const ValueType& Identity,
+	TransformLambdaType Transform,
+	ReduceLambdaType Reduce,
+	const int32 GrainSize = 0)
+{
+	const auto ArrayView = MakeVoxelArrayView(Array);
+	check(ArrayView.Num() <= MAX_int32);
+
+	return ParallelReduce(
+		int32(ArrayView.Num()),
+		Identity,
+		[&](const int32 StartIndex, const int32 EndIndex, ValueType& Accumulator)
+		{
+			for (int32 Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Accumulator = Reduce(Accumulator, Transform(ArrayView[Index]));
+			}
+		},
+		Reduce,
+		GrainSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+enum class EVoxelParallelForTileOrder : uint8
+{
+	// X first, then Y, then Z
+	Linear,
+	// Consecutive tiles are close to each other, so tiles stolen together share more neighbors
+	Morton
+};
+
+// Split Bounds into TileSize tiles starting at Bounds.Min, and call Lambda on each tile in parallel
+// Tiles on the Max edges are clamped to Bounds. Pick TileSize so that a tile's working set fits in L2
+VOXELCORE_API void ParallelFor_Tiles(
+	const FVoxelIntBox& Bounds,
+	const FIntVector& TileSize,
+	EVoxelParallelForTileOrder Order,
+	TFunctionRef<void(const FVoxelIntBox& Tile)> Lambda);
+
+VOXELCORE_API void ParallelFor_Tiles(
+	const FVoxelIntBox2D& Bounds,
+	const FIntPoint& TileSize,
+	EVoxelParallelForTileOrder Order,
+	TFunctionRef<void(const FVoxelIntBox2D& Tile)> Lambda);
+
+template<typename LambdaType>
+requires LambdaHasSignature_V<LambdaType, void(const FVoxelIntBox&)>
+FORCEINLINE void ParallelFor(
+	const FVoxelIntBox& Bounds,
+	const FIntVector& TileSize,
+	LambdaType Lambda,
+	const EVoxelParallelForTileOrder Order = EVoxelParallelForTileOrder::Linear)
+{
+	ParallelFor_Tiles(Bounds, TileSize, Order, Lambda);
+}
+template<typename LambdaType>
+requires LambdaHasSignature_V<LambdaType, void(const FVoxelIntBox&)>
+FORCEINLINE void ParallelFor(
+	const FVoxelIntBox& Bounds,
+	const int32 TileSize,
+	LambdaType Lambda,
+	const EVoxelParallelForTileOrder Order = EVoxelParallelForTileOrder::Linear)
+{
+	ParallelFor_Tiles(Bounds, FIntVector(TileSize), Order, Lambda);
+}
+
+template<typename LambdaType>
+requires LambdaHasSignature_V<LambdaType, void(const FVoxelIntBox2D&)>
+FORCEINLINE void ParallelFor(
+	const FVoxelIntBox2D& Bounds,
+	const FIntPoint& TileSize,
+	LambdaType Lambda,
+	const EVoxelParallelForTileOrder Order = EVoxelParallelForTileOrder::Linear)
+{
+	ParallelFor_Tiles(Bounds, TileSize, Order, Lambda);
+}
+template<typename LambdaType>
+requires LambdaHasSignature_V<LambdaType, void(const FVoxelIntBox2D&)>
+FORCEINLINE void ParallelFor(
+	const FVoxelIntBox2D& Bounds,
+	const int32 TileSize,
+	LambdaType Lambda,
+	const EVoxelParallelForTileOrder Order = EVoxelParallelForTileOrder::Linear)
+{
+	ParallelFor_Tiles(Bounds, FIntPoint(TileSize), Order, Lambda);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace FVoxelUtilities
+{
+	// Values for which Predicate returns true, in order
+	// Predicate is evaluated in parallel, see CompactIndices
+	template<typename T, typename PredicateType>
+	TVoxelArray<std::remove_const_t<T>> CompactIf(
+		const TVoxelArrayView<T> Values,
+		PredicateType Predicate)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Values.Num(), 1024);
+
+		TVoxelArray<bool> Mask;
+		FVoxelUtilities::SetNumFast(Mask, Values.Num());
+
+		ParallelFor_Adaptive(Values.Num(), 0, [&](int32, const int32 StartIndex, const int32 EndIndex)
+		{
+			for (int32 Index = StartIndex; Index < EndIndex; Index++)
+			{
+				Mask[Index] = Predicate(Values[Index]);
+			}
+		});
+
+		TVoxelArray<int32> Indices;
+		FVoxelUtilities::CompactIndices(Mask, Indices);
+
+		TVoxelArray<std::remove_const_t<T>> Result;
+		Result.Reserve(Indices.Num());
+		for (const int32 Index : Indices)
+		{
+			Result.Add(Values[Index]);
+		}
+		return Result;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
 class VOXELCORE_API FVoxelParallelTaskScope
 {
 public:
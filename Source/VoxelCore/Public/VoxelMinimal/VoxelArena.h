@@ -0,0 +1,286 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/Containers/VoxelMap.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+
+DECLARE_VOXEL_MEMORY_STAT(VOXELCORE_API, STAT_VoxelArenaMemory, "Voxel Arena Memory");
+
+// Linear allocator for short-lived scratch memory
+// Allocating is a pointer bump, memory is only given back all at once by Reset
+// Freeing or growing the last allocation is done in place, which is what scratch arrays growing one at a time need
+// Not thread-safe: each thread uses its own arenas, see FVoxelArenaScope
+class VOXELCORE_API FVoxelArena
+{
+public:
+	explicit FVoxelArena(int64 InMinBlockSize = 64 * 1024);
+	~FVoxelArena();
+	UE_NONCOPYABLE(FVoxelArena);
+
+public:
+	FORCEINLINE void* Allocate(const int64 Size, const int32 Alignment)
+	{
+		checkVoxelSlow(Size > 0);
+		checkVoxelSlow(FMath::IsPowerOfTwo(Alignment));
+
+		const UPTRINT Result = Align(UPTRINT(Cursor), Alignment);
+		if (Result + Size > UPTRINT(End))
+		{
+			return AllocateSlow(Size, Alignment);
+		}
+
+		Cursor = reinterpret_cast<uint8*>(Result + Size);
+		LastAllocation = reinterpret_cast<uint8*>(Result);
+		NumLiveAllocations++;
+
+		return LastAllocation;
+	}
+	// Pointer can be null. OldSize is the number of bytes to keep
+	void* Reallocate(void* Pointer, int64 OldSize, int64 NewSize, int32 Alignment);
+	// Memory is only reused if Pointer is the last allocation
+	FORCEINLINE void Free(void* Pointer)
+	{
+		checkVoxelSlow(Pointer);
+		checkVoxelSlow(NumLiveAllocations > 0);
+		NumLiveAllocations--;
+
+		if (Pointer == LastAllocation)
+		{
+			Cursor = LastAllocation;
+			LastAllocation = nullptr;
+		}
+	}
+
+	// Free all allocations at once
+	// The largest block is kept around so that the next use of the arena fits in a single block
+	void Reset();
+
+public:
+	int64 GetUsedSize() const;
+	int64 GetAllocatedSize() const
+	{
+		return AllocatedSize;
+	}
+	// Peak used size since this arena was created
+	int64 GetHighWaterMark() const;
+	// Peak used size of any arena
+	static int64 GetGlobalHighWaterMark();
+
+public:
+	// Innermost arena pushed by a FVoxelArenaScope on this thread, null if none
+	static FVoxelArena* GetThreadArena();
+
+private:
+	struct FBlock
+	{
+		FBlock* Next = nullptr;
+		int64 Size = 0;
+
+		FORCEINLINE uint8* GetData()
+		{
+			return reinterpret_cast<uint8*>(this + 1);
+		}
+	};
+	checkStatic(sizeof(FBlock) == 16);
+
+	const int64 MinBlockSize;
+
+	uint8* Cursor = nullptr;
+	uint8* End = nullptr;
+	uint8* LastAllocation = nullptr;
+	int32 NumLiveAllocations = 0;
+
+	// Most recent first
+	FBlock* Blocks = nullptr;
+	int64 UsedSizeInPreviousBlocks = 0;
+	int64 AllocatedSize = 0;
+	mutable int64 HighWaterMark = 0;
+
+	void* AllocateSlow(int64 Size, int32 Alignment);
+	void UpdateHighWaterMark() const;
+};
+
+// Pushes an arena for the current thread: containers using FVoxelArenaAllocator created in this scope will allocate from it
+// Tasks opt in by pushing a scope around their scratch containers, see FVoxelFastAABBTree::BulkIntersectsChunk
+// Containers must not outlive the scope they were created in
+class VOXELCORE_API FVoxelArenaScope
+{
+public:
+	// Use a pooled thread arena, reset when the scope exits
+	FVoxelArenaScope();
+	// Use Arena, left untouched when the scope exits
+	explicit FVoxelArenaScope(FVoxelArena& InArena);
+	~FVoxelArenaScope();
+	UE_NONCOPYABLE(FVoxelArenaScope);
+
+private:
+	FVoxelArena* const Arena;
+	const bool bOwnsArena;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Allocator policy drawing from the thread arena active when the container is constructed
+// Falls back to the heap if there is no arena, so containers using it are valid anywhere
+class FVoxelArenaAllocator
+{
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = false };
+	enum { RequireRangeCheck = true };
+
+	class ForAnyElementType
+	{
+	public:
+		FORCEINLINE ForAnyElementType()
+			: Arena(FVoxelArena::GetThreadArena())
+		{
+		}
+		FORCEINLINE ~ForAnyElementType()
+		{
+			FreeData();
+		}
+		ForAnyElementType(const ForAnyElementType&) = delete;
+		ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+		FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+		{
+			checkVoxelSlow(this != &Other);
+
+			FreeData();
+
+			// The data stays in the arena it was allocated from
+			Data = Other.Data;
+			Arena = Other.Arena;
+
+			Other.Data = nullptr;
+		}
+
+		FORCEINLINE FScriptContainerElement* GetAllocation() const
+		{
+			return static_cast<FScriptContainerElement*>(Data);
+		}
+		FORCEINLINE bool HasAllocation() const
+		{
+			return Data != nullptr;
+		}
+		FORCEINLINE SizeType GetInitialCapacity() const
+		{
+			return 0;
+		}
+		FORCEINLINE SIZE_T GetAllocatedSize(const SizeType NumAllocatedElements, const SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		FORCEINLINE void ResizeAllocation(
+			const SizeType PreviousNumElements,
+			const SizeType NumElements,
+			const SIZE_T NumBytesPerElement)
+		{
+			ResizeAllocation(PreviousNumElements, NumElements, NumBytesPerElement, DEFAULT_ALIGNMENT);
+		}
+		void ResizeAllocation(
+			const SizeType PreviousNumElements,
+			const SizeType NumElements,
+			const SIZE_T NumBytesPerElement,
+			const uint32 AlignmentOfElement)
+		{
+			if (!Arena)
+			{
+				if (Data || NumElements)
+				{
+					Data = FMemory::Realloc(Data, NumElements * NumBytesPerElement, AlignmentOfElement);
+				}
+				return;
+			}
+
+			if (NumElements == 0)
+			{
+				FreeData();
+				return;
+			}
+
+			Data = Arena->Reallocate(
+				Data,
+				PreviousNumElements * NumBytesPerElement,
+				NumElements * NumBytesPerElement,
+				FMath::Max<int32>(AlignmentOfElement, alignof(void*)));
+		}
+
+		// No quantization: arena allocations have no size classes
+		FORCEINLINE SizeType CalculateSlackReserve(const SizeType NumElements, const SIZE_T NumBytesPerElement, const uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false, AlignmentOfElement);
+		}
+		FORCEINLINE SizeType CalculateSlackShrink(const SizeType NumElements, const SizeType NumAllocatedElements, const SIZE_T NumBytesPerElement, const uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false, AlignmentOfElement);
+		}
+		FORCEINLINE SizeType CalculateSlackGrow(const SizeType NumElements, const SizeType NumAllocatedElements, const SIZE_T NumBytesPerElement, const uint32 AlignmentOfElement = DEFAULT_ALIGNMENT) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false, AlignmentOfElement);
+		}
+
+	private:
+		void* Data = nullptr;
+		FVoxelArena* Arena = nullptr;
+
+		FORCEINLINE void FreeData()
+		{
+			if (!Data)
+			{
+				return;
+			}
+
+			if (Arena)
+			{
+				Arena->Free(Data);
+			}
+			else
+			{
+				FMemory::Free(Data);
+			}
+
+			Data = nullptr;
+		}
+	};
+
+	template<typename ElementType>
+	class ForElementType : public ForAnyElementType
+	{
+	public:
+		FORCEINLINE ElementType* GetAllocation() const
+		{
+			return static_cast<ElementType*>(static_cast<void*>(ForAnyElementType::GetAllocation()));
+		}
+	};
+};
+
+template<>
+struct TAllocatorTraits<FVoxelArenaAllocator> : TAllocatorTraitsBase<FVoxelArenaAllocator>
+{
+	static constexpr bool SupportsMove = true;
+	static constexpr bool IsZeroConstruct = false;
+	static constexpr bool SupportsElementAlignment = true;
+};
+
+template<typename KeyType, typename ValueType>
+struct TVoxelArenaMapAllocator
+{
+	static constexpr int32 MinHashSize = 0;
+
+	using FHashArray = TVoxelArray<int32, FVoxelArenaAllocator>;
+	using FElementArray = TVoxelArray<TVoxelMapElement<KeyType, ValueType>, FVoxelArenaAllocator>;
+};
+
+template<typename T>
+using TVoxelArenaArray = TVoxelArray<T, FVoxelArenaAllocator>;
+
+template<typename KeyType, typename ValueType>
+using TVoxelArenaMap = TVoxelMap<KeyType, ValueType, TVoxelArenaMapAllocator<KeyType, ValueType>>;
\ No newline at end of file
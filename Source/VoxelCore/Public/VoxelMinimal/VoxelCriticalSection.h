@@ -4,6 +4,7 @@
 
 #include "VoxelCoreMinimal.h"
 #include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/VoxelLockProfiler.h"
 
 namespace FVoxelUtilities
 {
@@ -109,20 +110,24 @@ using FVoxelCriticalSection_NoPadding = TVoxelCriticalSectionImpl<EVoxelAtomicPa
 ///////////////////////////////////////////////////////////////////////////////
 
 #define VOXEL_SCOPE_LOCK(...) \
+	VOXEL_LOCK_PROFILER_SCOPE(Lock, __VA_ARGS__) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats(), "Lock " #__VA_ARGS__); \
 		(__VA_ARGS__).Lock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		(__VA_ARGS__).Unlock(); \
 	};
 
 #define VOXEL_SCOPE_LOCK_ATOMIC(...) \
+	VOXEL_LOCK_PROFILER_SCOPE(Lock, __VA_ARGS__) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).Get(std::memory_order_relaxed), "Lock " #__VA_ARGS__); \
 		FVoxelUtilities::LockAtomic(__VA_ARGS__); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		FVoxelUtilities::UnlockAtomic(__VA_ARGS__); \
@@ -0,0 +1,62 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+
+// Epoch-based memory reclamation
+// Readers wrap their lock-free accesses in Enter/Exit, usually through FVoxelEpochScope
+// Writers unlink objects from shared structures, then Retire them instead of deleting them:
+// a retired object is only deleted once every reader that could have seen it has exited
+// Reclamation is done by the voxel task workers after each task and by the game thread every frame
+class VOXELCORE_API FVoxelEpoch
+{
+public:
+	using FDeleter = void(*)(void*);
+
+	// Can be nested
+	static void Enter();
+	static void Exit();
+	static bool IsInEpoch();
+
+public:
+	// Pointer must already be unreachable for readers entering from now on
+	static void Retire(void* Pointer, FDeleter Deleter);
+
+	template<typename T>
+	static void Retire(T* Pointer)
+	{
+		if (!Pointer)
+		{
+			return;
+		}
+
+		Retire(Pointer, [](void* InPointer)
+		{
+			delete static_cast<T*>(InPointer);
+		});
+	}
+
+public:
+	// Delete all the retired objects no reader can see anymore
+	static void Reclaim();
+	// Cheap, only calls Reclaim if enough objects are waiting
+	static void ReclaimIfNeeded();
+
+	static int64 GetNumRetired();
+};
+
+class FVoxelEpochScope
+{
+public:
+	FORCEINLINE FVoxelEpochScope()
+	{
+		FVoxelEpoch::Enter();
+	}
+	FORCEINLINE ~FVoxelEpochScope()
+	{
+		FVoxelEpoch::Exit();
+	}
+
+	UE_NONCOPYABLE(FVoxelEpochScope);
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelBox.h"
+#include "VoxelMinimal/VoxelIntBox.h"
+
+enum class EVoxelFrustumTest : uint8
+{
+	Outside,
+	Intersecting,
+	Inside
+};
+
+// Six planes + an optional max distance to the view origin
+// Planes are stored SoA so that a box is tested against all of them with a few SIMD ops
+struct VOXELCORE_API FVoxelFrustum
+{
+public:
+	// Max number of frustums that can be traversed at once, see TraverseFrustums
+	static constexpr int32 MaxViews = 32;
+
+	// Everything is inside
+	FVoxelFrustum();
+
+	// Planes are (Normal, W) with Dot(Normal, Position) + W >= 0 being inside
+	FVoxelFrustum(
+		TConstVoxelArrayView<FVector4f> Planes,
+		const FVector& ViewOrigin,
+		double MaxDistance = 0);
+
+	// MaxDistance <= 0 means no max distance
+	// Works with UE perspective, reversed-Z & orthographic projections
+	static FVoxelFrustum FromViewProjection(
+		const FMatrix& ViewProjectionMatrix,
+		const FVector& ViewOrigin,
+		double MaxDistance = 0);
+
+public:
+	FORCEINLINE const FVector3f& GetViewOrigin() const
+	{
+		return ViewOrigin;
+	}
+
+	FORCEINLINE EVoxelFrustumTest Test(
+		const FVector3f& Min,
+		const FVector3f& Max) const
+	{
+		const FVector3f Center = (Min + Max) / 2.f;
+		const FVector3f Extent = (Max - Min) / 2.f;
+
+		const VectorRegister4Float CenterX = VectorSetFloat1(Center.X);
+		const VectorRegister4Float CenterY = VectorSetFloat1(Center.Y);
+		const VectorRegister4Float CenterZ = VectorSetFloat1(Center.Z);
+		const VectorRegister4Float ExtentX = VectorSetFloat1(Extent.X);
+		const VectorRegister4Float ExtentY = VectorSetFloat1(Extent.Y);
+		const VectorRegister4Float ExtentZ = VectorSetFloat1(Extent.Z);
+
+		int32 OutsideMask = 0;
+		int32 IntersectMask = 0;
+
+		for (int32 Index = 0; Index < 2; Index++)
+		{
+			VectorRegister4Float Distance = VectorMultiplyAdd(PlanesX[Index], CenterX, PlanesW[Index]);
+			Distance = VectorMultiplyAdd(PlanesY[Index], CenterY, Distance);
+			Distance = VectorMultiplyAdd(PlanesZ[Index], CenterZ, Distance);
+
+			VectorRegister4Float Radius = VectorMultiply(VectorAbs(PlanesX[Index]), ExtentX);
+			Radius = VectorMultiplyAdd(VectorAbs(PlanesY[Index]), ExtentY, Radius);
+			Radius = VectorMultiplyAdd(VectorAbs(PlanesZ[Index]), ExtentZ, Radius);
+
+			// Box is fully on the outside of a plane if its closest point is outside
+			OutsideMask |= VectorMaskBits(VectorCompareLT(VectorAdd(Distance, Radius), VectorZeroFloat()));
+			// Box straddles a plane if its farthest point is outside
+			IntersectMask |= VectorMaskBits(VectorCompareLT(VectorSubtract(Distance, Radius), VectorZeroFloat()));
+		}
+
+		if (OutsideMask)
+		{
+			return EVoxelFrustumTest::Outside;
+		}
+
+		if (MaxDistanceSquared < MAX_flt)
+		{
+			const FVector3f ClosestPoint = FVoxelUtilities::Clamp(ViewOrigin, Min, Max);
+			if ((ClosestPoint - ViewOrigin).SizeSquared() > MaxDistanceSquared)
+			{
+				return EVoxelFrustumTest::Outside;
+			}
+
+			const FVector3f FarthestPoint = FVoxelUtilities::ComponentMax(ViewOrigin - Min, Max - ViewOrigin);
+			if (FarthestPoint.SizeSquared() > MaxDistanceSquared)
+			{
+				return EVoxelFrustumTest::Intersecting;
+			}
+		}
+
+		return IntersectMask ? EVoxelFrustumTest::Intersecting : EVoxelFrustumTest::Inside;
+	}
+	FORCEINLINE EVoxelFrustumTest Test(const FVoxelBox& Box) const
+	{
+		return Test(FVector3f(Box.Min), FVector3f(Box.Max));
+	}
+	FORCEINLINE EVoxelFrustumTest Test(const FVoxelIntBox& Box) const
+	{
+		return Test(FVector3f(Box.Min), FVector3f(Box.Max));
+	}
+
+	// Tests all the views in InOutVisibleMask that aren't in InOutInsideMask yet
+	// Views the box is outside of are removed from InOutVisibleMask, views it's fully inside of are added to InOutInsideMask
+	// Children of a fully inside node don't need to be tested again
+	FORCEINLINE static void TestViews(
+		const TConstVoxelArrayView<FVoxelFrustum> Frustums,
+		const FVector3f& Min,
+		const FVector3f& Max,
+		uint32& InOutVisibleMask,
+		uint32& InOutInsideMask)
+	{
+		uint32 ViewsToTest = InOutVisibleMask & ~InOutInsideMask;
+		while (ViewsToTest)
+		{
+			const int32 ViewIndex = FMath::CountTrailingZeros(ViewsToTest);
+			ViewsToTest &= ViewsToTest - 1;
+
+			switch (Frustums[ViewIndex].Test(Min, Max))
+			{
+			default: VOXEL_ASSUME(false);
+			case EVoxelFrustumTest::Outside: InOutVisibleMask &= ~(1u << ViewIndex); break;
+			case EVoxelFrustumTest::Intersecting: break;
+			case EVoxelFrustumTest::Inside: InOutInsideMask |= 1u << ViewIndex; break;
+			}
+		}
+	}
+	FORCEINLINE static uint32 GetAllViewsMask(const TConstVoxelArrayView<FVoxelFrustum> Frustums)
+	{
+		checkVoxelSlow(Frustums.Num() <= MaxViews);
+		return Frustums.Num() == MaxViews ? MAX_uint32 : (1u << Frustums.Num()) - 1;
+	}
+
+	// Used to sort front to back
+	FORCEINLINE float GetDistanceSquared(
+		const FVector3f& Min,
+		const FVector3f& Max) const
+	{
+		return (FVoxelUtilities::Clamp(ViewOrigin, Min, Max) - ViewOrigin).SizeSquared();
+	}
+
+private:
+	// 6 planes padded to 8, padding planes are always inside
+	VectorRegister4Float PlanesX[2];
+	VectorRegister4Float PlanesY[2];
+	VectorRegister4Float PlanesZ[2];
+	VectorRegister4Float PlanesW[2];
+
+	FVector3f ViewOrigin = FVector3f(ForceInit);
+	float MaxDistanceSquared = MAX_flt;
+};
\ No newline at end of file
@@ -0,0 +1,124 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+
+struct FVoxelLockStats
+{
+	int64 NumAcquisitions = 0;
+	// Acquisitions that didn't get the lock on the first try
+	int64 NumContendedAcquisitions = 0;
+	// Total time spent waiting in contended acquisitions
+	double WaitTime = 0.;
+};
+
+// Lock that spins with exponential backoff for a short while, then parks the thread until the lock is released
+// Unlike FVoxelCriticalSection, waiting threads don't steal time from the lock owner when there are more threads than cores
+// Unlock only touches the OS when a thread is parked
+class VOXELCORE_API FVoxelHybridCriticalSection
+{
+public:
+	FVoxelHybridCriticalSection() = default;
+	// Record per-instance stats, see GetStats
+	// Contended acquisitions and wait times are also reported as "{StatName} Contended" and "{StatName} Wait Time (us)" counter stats
+	explicit FVoxelHybridCriticalSection(FName StatName);
+	~FVoxelHybridCriticalSection();
+
+	// Allow copying for convenience, but don't copy the actual state
+	FVoxelHybridCriticalSection(const FVoxelHybridCriticalSection& Other);
+	FVoxelHybridCriticalSection& operator=(const FVoxelHybridCriticalSection& Other);
+
+public:
+	FORCEINLINE void Lock()
+	{
+		checkVoxelSlow(LockerThreadId.Get() != FPlatformTLS::GetCurrentThreadId());
+
+		uint8 Expected = 0;
+		if (State.CompareExchangeStrong(Expected, LockedFlag, std::memory_order_acquire))
+		{
+			if (Stats)
+			{
+				Stats->NumAcquisitions.Add(1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			LockSlow();
+		}
+
+		checkVoxelSlow(LockerThreadId.Get() == 0);
+		VOXEL_DEBUG_ONLY(LockerThreadId.Set(FPlatformTLS::GetCurrentThreadId()));
+	}
+	FORCEINLINE bool TryLock()
+	{
+		checkVoxelSlow(LockerThreadId.Get() != FPlatformTLS::GetCurrentThreadId());
+
+		uint8 CurrentState = State.Get(std::memory_order_relaxed);
+		while (!(CurrentState & LockedFlag))
+		{
+			if (State.CompareExchangeWeak(CurrentState, CurrentState | LockedFlag, std::memory_order_acquire))
+			{
+				if (Stats)
+				{
+					Stats->NumAcquisitions.Add(1, std::memory_order_relaxed);
+				}
+
+				checkVoxelSlow(LockerThreadId.Get() == 0);
+				VOXEL_DEBUG_ONLY(LockerThreadId.Set(FPlatformTLS::GetCurrentThreadId()));
+				return true;
+			}
+		}
+		return false;
+	}
+
+	FORCEINLINE void Unlock()
+	{
+		checkVoxelSlow(LockerThreadId.Get() == FPlatformTLS::GetCurrentThreadId());
+		VOXEL_DEBUG_ONLY(LockerThreadId.Set(0));
+
+		uint8 Expected = LockedFlag;
+		if (State.CompareExchangeStrong(Expected, 0, std::memory_order_release))
+		{
+			return;
+		}
+
+		UnlockSlow();
+	}
+
+public:
+	FORCEINLINE bool IsLocked() const
+	{
+		return State.Get(std::memory_order_relaxed) & LockedFlag;
+	}
+	FORCEINLINE bool ShouldRecordStats() const
+	{
+		return IsLocked();
+	}
+
+	FVoxelLockStats GetStats() const;
+
+private:
+	static constexpr uint8 LockedFlag = 1 << 0;
+	// At least one thread is parked on State
+	static constexpr uint8 ParkedFlag = 1 << 1;
+
+	struct FStats
+	{
+		FName ContendedStatName;
+		FName WaitTimeStatName;
+		FVoxelCounter64 NumAcquisitions;
+		FVoxelCounter64 NumContendedAcquisitions;
+		FVoxelCounter64 WaitTimeCycles;
+	};
+
+	TVoxelAtomic<uint8, EVoxelAtomicPadding::Enabled> State;
+	TUniquePtr<FStats> Stats;
+#if VOXEL_DEBUG
+	TVoxelAtomic<uint32> LockerThreadId = 0;
+#endif
+
+	void LockSlow();
+	void UnlockSlow();
+};
\ No newline at end of file
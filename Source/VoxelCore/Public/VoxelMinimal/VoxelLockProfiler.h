@@ -0,0 +1,110 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+
+#if VOXEL_LOCK_PROFILER
+enum class EVoxelLockProfilerType : uint8
+{
+	Lock,
+	ReadLock,
+	WriteLock
+};
+
+// One per VOXEL_SCOPE_LOCK call site, stored in a function-local static
+// Sites unregister themselves when destroyed, ie when the module owning them is unloaded
+struct VOXELCORE_API FVoxelLockProfilerSite
+{
+public:
+	// Bucket N counts durations in [2^N, 2^(N+1)) nanoseconds
+	static constexpr int32 NumBuckets = 40;
+
+	const TCHAR* const Name;
+	const ANSICHAR* const File;
+	const int32 Line;
+	const EVoxelLockProfilerType Type;
+
+	FVoxelCounter64 NumAcquisitions;
+	FVoxelCounter64 TotalWaitCycles;
+	FVoxelCounter64 TotalHoldCycles;
+	FVoxelCounter64 WaitHistogram[NumBuckets];
+	FVoxelCounter64 HoldHistogram[NumBuckets];
+
+	FVoxelLockProfilerSite(
+		const TCHAR* Name,
+		const ANSICHAR* File,
+		int32 Line,
+		EVoxelLockProfilerType Type);
+	~FVoxelLockProfilerSite();
+	UE_NONCOPYABLE(FVoxelLockProfilerSite);
+
+	void AddWait(uint64 Cycles);
+	void AddHold(uint64 Cycles);
+	void Reset();
+
+	// Lambda is called with the site list locked: modules can't unload sites while it runs
+	static void ForeachSite(TFunctionRef<void(FVoxelLockProfilerSite&)> Lambda);
+
+private:
+	// Intrusive list, guarded by a critical section. Registration happens once per site
+	FVoxelLockProfilerSite* Next = nullptr;
+	static FVoxelLockProfilerSite* Head;
+};
+
+extern VOXELCORE_API bool GVoxelLockProfilerEnabled;
+
+class FVoxelLockProfilerScope
+{
+public:
+	FORCEINLINE explicit FVoxelLockProfilerScope(
+		FVoxelLockProfilerSite& Site,
+		const bool bCondition = true)
+		: Site(Site)
+		, bEnabled(bCondition && GVoxelLockProfilerEnabled)
+	{
+		if (bEnabled)
+		{
+			StartCycles = FPlatformTime::Cycles64();
+		}
+	}
+	FORCEINLINE void OnLocked()
+	{
+		if (!bEnabled)
+		{
+			return;
+		}
+
+		LockedCycles = FPlatformTime::Cycles64();
+		Site.AddWait(LockedCycles - StartCycles);
+	}
+	FORCEINLINE ~FVoxelLockProfilerScope()
+	{
+		if (!bEnabled)
+		{
+			return;
+		}
+
+		Site.AddHold(FPlatformTime::Cycles64() - LockedCycles);
+	}
+
+private:
+	FVoxelLockProfilerSite& Site;
+	const bool bEnabled;
+	uint64 StartCycles = 0;
+	uint64 LockedCycles = 0;
+};
+
+// Must be declared before the ON_SCOPE_EXIT unlocking, so that the hold time is recorded after the unlock
+#define VOXEL_LOCK_PROFILER_SCOPE_COND(Condition, Type, ...) \
+	static FVoxelLockProfilerSite VOXEL_APPEND_LINE(__VoxelLockProfilerSite)(TEXT(#__VA_ARGS__), __FILE__, __LINE__, EVoxelLockProfilerType::Type); \
+	FVoxelLockProfilerScope VOXEL_APPEND_LINE(__VoxelLockProfilerScope)(VOXEL_APPEND_LINE(__VoxelLockProfilerSite), Condition);
+
+#define VOXEL_LOCK_PROFILER_ON_LOCKED() VOXEL_APPEND_LINE(__VoxelLockProfilerScope).OnLocked();
+#else
+#define VOXEL_LOCK_PROFILER_SCOPE_COND(Condition, Type, ...)
+#define VOXEL_LOCK_PROFILER_ON_LOCKED()
+#endif
+
+#define VOXEL_LOCK_PROFILER_SCOPE(Type, ...) VOXEL_LOCK_PROFILER_SCOPE_COND(true, Type, __VA_ARGS__)
\ No newline at end of file
@@ -22,6 +22,12 @@
 #define VOXEL_DEBUG DO_CHECK
 #endif
 
+// Record wait & hold times of VOXEL_SCOPE_LOCK, VOXEL_SCOPE_READ_LOCK & VOXEL_SCOPE_WRITE_LOCK per call site
+// See voxel.LockProfiler.Print
+#ifndef VOXEL_LOCK_PROFILER
+#define VOXEL_LOCK_PROFILER 0
+#endif
+
 #if INTELLISENSE_PARSER
 #define VOXEL_DEBUG 1
 #define INTELLISENSE_ONLY(...) __VA_ARGS__
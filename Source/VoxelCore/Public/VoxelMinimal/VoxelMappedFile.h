@@ -0,0 +1,71 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+#include "VoxelMinimal/Containers/VoxelArrayView.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Read-only memory mapping of a file, to use big baked data without loading it first
+// Pages are read on first access and can be evicted by the OS, so peak memory stays low
+// Falls back to loading the file in memory if the platform can't map it (eg, files in paks)
+// Views are valid as long as the file is alive: keep a shared ref to it while using them
+class VOXELCORE_API FVoxelMappedFile
+{
+public:
+	// bPreload: hint that the whole file will be read soon
+	static TSharedPtr<FVoxelMappedFile> Create(const FString& Path, bool bPreload = false);
+	~FVoxelMappedFile();
+	UE_NONCOPYABLE(FVoxelMappedFile);
+
+public:
+	FORCEINLINE const FString& GetPath() const
+	{
+		return Path;
+	}
+	FORCEINLINE int64 Num() const
+	{
+		return Data.Num();
+	}
+	// False if the file had to be loaded in memory, or if GetMutableView was called
+	FORCEINLINE bool IsMapped() const
+	{
+		return MappedRegion && !bHasMutableCopy;
+	}
+	FORCEINLINE TConstVoxelArrayView64<uint8> GetView() const
+	{
+		return Data;
+	}
+	FORCEINLINE TConstVoxelArrayView64<uint8> GetView(const int64 Offset, const int64 Count) const
+	{
+		return Data.Slice(Offset, Count);
+	}
+
+	// Hint that a range will be read soon so that the OS starts paging it in
+	void Prefetch(int64 Offset, int64 Count) const;
+	void Prefetch() const
+	{
+		Prefetch(0, Num());
+	}
+
+	// Copy-on-write access: the first call copies the file content, GetView then returns the copy
+	// Writes are never written back to the file
+	// Views returned before keep pointing to the original content, even if the file was loaded in memory
+	// Not thread-safe, call it before sharing the file
+	TVoxelArrayView64<uint8> GetMutableView();
+
+private:
+	const FString Path;
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// Used if the file can't be mapped
+	TVoxelArray64<uint8> LoadedData;
+	TVoxelArray64<uint8> MutableData;
+	bool bHasMutableCopy = false;
+	TConstVoxelArrayView64<uint8> Data;
+
+	explicit FVoxelMappedFile(const FString& InPath);
+};
\ No newline at end of file
@@ -0,0 +1,225 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/VoxelCriticalSection.h"
+#include "VoxelMinimal/Containers/VoxelArray.h"
+
+// Process-wide pool of T, for heavy helpers that are constructed and destroyed over and over
+// Each thread caches returned objects in a small magazine, magazines are refilled from and flushed to a shared depot
+// If T has a Reset() it is called on Return, if it has a GetAllocatedSize() it is used to cap the memory kept around
+// Objects that would exceed the caps are deleted instead of being pooled
+template<typename T>
+class TVoxelObjectPool
+{
+public:
+	static constexpr int32 MagazineSize = 32;
+	// In bytes, including the memory owned by the objects
+	static constexpr int64 MaxMagazineSize = 1 << 20;
+	static constexpr int64 MaxDepotSize = 16 << 20;
+
+	static TUniquePtr<T> Allocate()
+	{
+		FMagazine& Magazine = GetMagazine();
+
+		if (Magazine.Objects.Num() == 0)
+		{
+			Magazine.Refill();
+		}
+
+		if (Magazine.Objects.Num() == 0)
+		{
+			NumNew.Increment(std::memory_order_relaxed);
+			return MakeUnique<T>();
+		}
+
+		const FObject Object = Magazine.Objects.Pop();
+		Magazine.AllocatedSize -= Object.AllocatedSize;
+
+		NumReused.Increment(std::memory_order_relaxed);
+		return TUniquePtr<T>(Object.Pointer);
+	}
+	static void Return(TUniquePtr<T> Object)
+	{
+		if (!Object)
+		{
+			return;
+		}
+
+		if constexpr (requires { Object->Reset(); })
+		{
+			Object->Reset();
+		}
+
+		const int64 AllocatedSize = GetObjectSize(*Object);
+		if (AllocatedSize > MaxMagazineSize)
+		{
+			NumTrimmed.Increment(std::memory_order_relaxed);
+			return;
+		}
+
+		FMagazine& Magazine = GetMagazine();
+
+		if (Magazine.Objects.Num() == MagazineSize ||
+			Magazine.AllocatedSize + AllocatedSize > MaxMagazineSize)
+		{
+			Magazine.Flush();
+		}
+
+		Magazine.Objects.Add(FObject
+		{
+			Object.Release(),
+			AllocatedSize
+		});
+		Magazine.AllocatedSize += AllocatedSize;
+	}
+
+	// Delete the objects in the depot and in the magazine of the calling thread
+	static void Trim()
+	{
+		VOXEL_FUNCTION_COUNTER();
+
+		GetMagazine().Flush();
+
+		TVoxelArray<FObject> ObjectsToDelete;
+		{
+			FDepot& Depot = GetDepot();
+			VOXEL_SCOPE_LOCK(Depot.CriticalSection);
+
+			ObjectsToDelete = MoveTemp(Depot.Objects_RequiresLock);
+			Depot.AllocatedSize_RequiresLock = 0;
+		}
+
+		DeleteObjects(ObjectsToDelete);
+	}
+
+public:
+	// Number of objects Allocate had to create
+	static int64 GetNumNew()
+	{
+		return NumNew.Get();
+	}
+	// Number of objects Allocate took from the pool instead of creating them
+	static int64 GetNumReused()
+	{
+		return NumReused.Get();
+	}
+	// Number of objects deleted because of the memory caps
+	static int64 GetNumTrimmed()
+	{
+		return NumTrimmed.Get();
+	}
+
+private:
+	struct FObject
+	{
+		T* Pointer = nullptr;
+		int64 AllocatedSize = 0;
+	};
+
+	struct FDepot
+	{
+		FVoxelCriticalSection CriticalSection;
+		TVoxelArray<FObject> Objects_RequiresLock;
+		int64 AllocatedSize_RequiresLock = 0;
+	};
+
+	struct FMagazine
+	{
+		TVoxelInlineArray<FObject, MagazineSize> Objects;
+		int64 AllocatedSize = 0;
+
+		~FMagazine()
+		{
+			Flush();
+		}
+
+		void Refill()
+		{
+			checkVoxelSlow(Objects.Num() == 0);
+
+			FDepot& Depot = GetDepot();
+			VOXEL_SCOPE_LOCK(Depot.CriticalSection);
+
+			// Only take half a magazine so that a thread returning objects right after doesn't flush them straight back
+			const int32 NumToTake = FMath::Min(Depot.Objects_RequiresLock.Num(), MagazineSize / 2);
+			for (int32 Index = 0; Index < NumToTake; Index++)
+			{
+				const FObject Object = Depot.Objects_RequiresLock.Pop();
+				Depot.AllocatedSize_RequiresLock -= Object.AllocatedSize;
+
+				Objects.Add(Object);
+				AllocatedSize += Object.AllocatedSize;
+			}
+		}
+		void Flush()
+		{
+			if (Objects.Num() == 0)
+			{
+				return;
+			}
+
+			TVoxelInlineArray<FObject, MagazineSize> ObjectsToDelete;
+			{
+				FDepot& Depot = GetDepot();
+				VOXEL_SCOPE_LOCK(Depot.CriticalSection);
+
+				for (const FObject& Object : Objects)
+				{
+					if (Depot.AllocatedSize_RequiresLock + Object.AllocatedSize > MaxDepotSize)
+					{
+						ObjectsToDelete.Add(Object);
+						continue;
+					}
+
+					Depot.Objects_RequiresLock.Add(Object);
+					Depot.AllocatedSize_RequiresLock += Object.AllocatedSize;
+				}
+			}
+
+			Objects.Reset();
+			AllocatedSize = 0;
+
+			DeleteObjects(ObjectsToDelete);
+		}
+	};
+
+	static inline FVoxelCounter64 NumNew;
+	static inline FVoxelCounter64 NumReused;
+	static inline FVoxelCounter64 NumTrimmed;
+
+	static FDepot& GetDepot()
+	{
+		// Never deleted: threads flush their magazine when exiting, which can be after static destruction
+		static FDepot& Depot = *new FDepot();
+		return Depot;
+	}
+	static FMagazine& GetMagazine()
+	{
+		thread_local FMagazine Magazine;
+		return Magazine;
+	}
+
+	static int64 GetObjectSize(const T& Object)
+	{
+		if constexpr (requires { Object.GetAllocatedSize(); })
+		{
+			return sizeof(T) + Object.GetAllocatedSize();
+		}
+		else
+		{
+			return sizeof(T);
+		}
+	}
+	static void DeleteObjects(const TConstVoxelArrayView<FObject> Objects)
+	{
+		NumTrimmed.Add(Objects.Num(), std::memory_order_relaxed);
+
+		for (const FObject& Object : Objects)
+		{
+			delete Object.Pointer;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,263 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelCoreMinimal.h"
+#include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/VoxelCriticalSection.h"
+#include "VoxelMinimal/Utilities/VoxelLambdaUtilities.h"
+
+// Reader-writer lock for read-mostly state, same interface as FVoxelSharedCriticalSection
+// Readers only touch the counter of their shard, so concurrent readers on different threads don't fight over a cache line
+// Writers are expensive: they need to wait for all the shards to drain
+// Writers have priority: new readers wait while a writer is waiting for the lock
+// Unlike FVoxelSharedCriticalSection read locks must not nest: if a writer is waiting, the inner ReadLock waits for it
+// and the writer waits for the outer read lock, forever. Checked with VOXEL_DEBUG
+// ReadUnlock must be called on the thread that called ReadLock
+class FVoxelShardedSharedCriticalSection
+{
+public:
+	static constexpr int32 NumShards = 32;
+
+	FVoxelShardedSharedCriticalSection() = default;
+
+	// Allow copying for convenience, but don't copy the actual state
+	FORCEINLINE FVoxelShardedSharedCriticalSection(const FVoxelShardedSharedCriticalSection&)
+	{
+	}
+	FORCEINLINE FVoxelShardedSharedCriticalSection& operator=(const FVoxelShardedSharedCriticalSection&)
+	{
+		return *this;
+	}
+
+public:
+	FORCEINLINE bool TryReadLock()
+	{
+		if (bHasWriter.Get(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		FShard& Shard = GetShard();
+		Shard.NumReaders.Increment();
+
+		// Pairs with the NumReaders check in WriteLock: either we see the writer, or the writer sees us
+		if (bHasWriter.Get())
+		{
+			Shard.NumReaders.Decrement();
+			return false;
+		}
+
+		VOXEL_DEBUG_ONLY(GetThreadReadLocks().Add(this));
+		return true;
+	}
+	FORCEINLINE void ReadLock()
+	{
+		checkVoxelSlow(!GetThreadReadLocks().Contains(this));
+		VOXEL_DEBUG_ONLY(GetThreadReadLocks().Add(this));
+
+		FShard& Shard = GetShard();
+
+		while (true)
+		{
+			while (bHasWriter.Get(std::memory_order_relaxed))
+			{
+				FPlatformProcess::Yield();
+			}
+
+			Shard.NumReaders.Increment();
+
+			if (!bHasWriter.Get())
+			{
+				break;
+			}
+
+			// A writer got in between, let it through
+			Shard.NumReaders.Decrement();
+		}
+	}
+	FORCEINLINE void ReadUnlock()
+	{
+		checkVoxelSlow(GetShard().NumReaders.Get() > 0);
+		checkVoxelSlow(GetThreadReadLocks().RemoveSingleSwap(this) == 1);
+		GetShard().NumReaders.Decrement(std::memory_order_release);
+	}
+
+public:
+	FORCEINLINE bool TryWriteLock()
+	{
+		bool bExpected = false;
+		if (!bHasWriter.CompareExchangeStrong(bExpected, true))
+		{
+			return false;
+		}
+
+		for (const FShard& Shard : Shards)
+		{
+			if (Shard.NumReaders.Get() > 0)
+			{
+				bHasWriter.Set(false);
+				return false;
+			}
+		}
+
+		return true;
+	}
+	FORCEINLINE void WriteLock()
+	{
+		bool bExpected = false;
+		while (!bHasWriter.CompareExchangeStrong(bExpected, true))
+		{
+			FPlatformProcess::Yield();
+			bExpected = false;
+		}
+
+		// New readers are now blocked, wait for the existing ones to leave
+		for (const FShard& Shard : Shards)
+		{
+			while (Shard.NumReaders.Get() > 0)
+			{
+				FPlatformProcess::Yield();
+			}
+		}
+	}
+	FORCEINLINE void WriteUnlock()
+	{
+		checkVoxelSlow(bHasWriter.Get());
+		bHasWriter.Set(false, std::memory_order_release);
+	}
+
+public:
+	FORCEINLINE bool IsLocked_Read() const
+	{
+		if (bHasWriter.Get(std::memory_order_relaxed))
+		{
+			return true;
+		}
+
+		for (const FShard& Shard : Shards)
+		{
+			if (Shard.NumReaders.Get(std::memory_order_relaxed) > 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	FORCEINLINE bool IsLocked_Write() const
+	{
+		return bHasWriter.Get(std::memory_order_relaxed);
+	}
+
+public:
+	FORCEINLINE bool ShouldRecordStats_Read() const
+	{
+		return IsLocked_Write();
+	}
+	FORCEINLINE bool ShouldRecordStats_Write() const
+	{
+		return IsLocked_Read();
+	}
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FShard
+	{
+		TVoxelAtomic<int32> NumReaders;
+	};
+
+	// Set while a writer is waiting for readers to drain or holds the lock
+	TVoxelAtomic_WithPadding<bool> bHasWriter;
+	FShard Shards[NumShards];
+
+#if VOXEL_DEBUG
+	// Read locks held by the current thread, across all the sharded locks
+	static TArray<const FVoxelShardedSharedCriticalSection*, TInlineAllocator<8>>& GetThreadReadLocks()
+	{
+		thread_local TArray<const FVoxelShardedSharedCriticalSection*, TInlineAllocator<8>> ReadLocks;
+		return ReadLocks;
+	}
+#endif
+
+	FORCEINLINE FShard& GetShard()
+	{
+		// Fibonacci hashing: thread ids are often sequential, spread them across shards
+		static_assert(NumShards == 32);
+		return Shards[(FPlatformTLS::GetCurrentThreadId() * 0x9E3779B1u) >> 27];
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Sequence lock for small plain data read far more often than written
+// Readers never write to shared memory: they copy the data and retry if a write happened in the meantime
+// Writers are serialized by a regular lock
+template<typename T>
+class TVoxelSeqLock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "TVoxelSeqLock requires trivially copyable data");
+
+public:
+	TVoxelSeqLock() = default;
+	explicit TVoxelSeqLock(const T& Data)
+		: Data(Data)
+	{
+	}
+
+public:
+	FORCEINLINE T Read() const
+	{
+		while (true)
+		{
+			const uint32 StartSequence = Sequence.Get(std::memory_order_acquire);
+			if (StartSequence & 1)
+			{
+				// Write in progress
+				FPlatformProcess::Yield();
+				continue;
+			}
+
+			T Result;
+			FMemory::Memcpy(&Result, &Data, sizeof(T));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (Sequence.Get(std::memory_order_relaxed) == StartSequence)
+			{
+				return Result;
+			}
+		}
+	}
+
+	void Write(const T& NewData)
+	{
+		Update([&](T& InData)
+		{
+			InData = NewData;
+		});
+	}
+
+	template<typename LambdaType>
+	requires LambdaHasSignature_V<LambdaType, void(T&)>
+	void Update(LambdaType&& Lambda)
+	{
+		VOXEL_SCOPE_LOCK(WriteCriticalSection);
+
+		const uint32 StartSequence = Sequence.Get(std::memory_order_relaxed);
+		checkVoxelSlow(!(StartSequence & 1));
+
+		Sequence.Set(StartSequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		Lambda(Data);
+
+		Sequence.Set(StartSequence + 2, std::memory_order_release);
+	}
+
+private:
+	// Odd while a write is in progress
+	TVoxelAtomic<uint32> Sequence;
+	T Data{};
+	FVoxelCriticalSection WriteCriticalSection;
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "VoxelCoreMinimal.h"
 #include "VoxelMinimal/VoxelAtomic.h"
+#include "VoxelMinimal/VoxelLockProfiler.h"
 
 struct FVoxelSharedCriticalSectionState
 {
@@ -181,20 +182,24 @@ using FVoxelSharedCriticalSection_NoPadding = TVoxelSharedCriticalSectionImpl<EV
 ///////////////////////////////////////////////////////////////////////////////
 
 #define VOXEL_SCOPE_READ_LOCK(...) \
+	VOXEL_LOCK_PROFILER_SCOPE(ReadLock, __VA_ARGS__) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats_Read(), "ReadLock " #__VA_ARGS__); \
 		(__VA_ARGS__).ReadLock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		(__VA_ARGS__).ReadUnlock(); \
 	};
 
 #define VOXEL_SCOPE_WRITE_LOCK(...) \
+	VOXEL_LOCK_PROFILER_SCOPE(WriteLock, __VA_ARGS__) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats_Write(), "WriteLock " #__VA_ARGS__); \
 		(__VA_ARGS__).WriteLock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		(__VA_ARGS__).WriteUnlock(); \
@@ -203,10 +208,12 @@ using FVoxelSharedCriticalSection_NoPadding = TVoxelSharedCriticalSectionImpl<EV
 #define VOXEL_SCOPE_WRITE_LOCK_PROMOTED(...) \
 	checkVoxelSlow((__VA_ARGS__).IsLocked_Read()); \
 	(__VA_ARGS__).ReadUnlock(); \
+	VOXEL_LOCK_PROFILER_SCOPE(WriteLock, __VA_ARGS__) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats_Write(), "WriteLock " #__VA_ARGS__); \
 		(__VA_ARGS__).WriteLock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		(__VA_ARGS__).WriteUnlock(); \
@@ -221,11 +228,13 @@ using FVoxelSharedCriticalSection_NoPadding = TVoxelSharedCriticalSectionImpl<EV
 
 #define VOXEL_SCOPE_READ_LOCK_COND(Cond, ...) \
 	const bool VOXEL_APPEND_LINE(__bShouldLock) = Cond; \
+	VOXEL_LOCK_PROFILER_SCOPE_COND(VOXEL_APPEND_LINE(__bShouldLock), ReadLock, __VA_ARGS__) \
 	if (VOXEL_APPEND_LINE(__bShouldLock)) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats_Read(), "ReadLock " #__VA_ARGS__); \
 		(__VA_ARGS__).ReadLock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		if (VOXEL_APPEND_LINE(__bShouldLock)) \
@@ -236,11 +245,13 @@ using FVoxelSharedCriticalSection_NoPadding = TVoxelSharedCriticalSectionImpl<EV
 
 #define VOXEL_SCOPE_WRITE_LOCK_COND(Cond, ...) \
 	const bool VOXEL_APPEND_LINE(__bShouldLock) = Cond; \
+	VOXEL_LOCK_PROFILER_SCOPE_COND(VOXEL_APPEND_LINE(__bShouldLock), WriteLock, __VA_ARGS__) \
 	if (VOXEL_APPEND_LINE(__bShouldLock)) \
 	{ \
 		VOXEL_SCOPE_COUNTER_COND((__VA_ARGS__).ShouldRecordStats_Write(), "WriteLock " #__VA_ARGS__); \
 		(__VA_ARGS__).WriteLock(); \
 	} \
+	VOXEL_LOCK_PROFILER_ON_LOCKED() \
 	ON_SCOPE_EXIT \
 	{ \
 		if (VOXEL_APPEND_LINE(__bShouldLock)) \
@@ -0,0 +1,539 @@
+// Copyright Voxel Plugin SAS. All Rights Reserved.
+
+#pragma once
+
+#include "VoxelMinimal.h"
+
+// Uniform grid of FIntVector cells hashed into a few maps, for many small moving objects
+// Elements are added to every cell their bounds overlap, unless they overlap more than MaxCellsPerElement cells:
+// these are kept in a list tested by every query
+// Const queries are safe to run concurrently, as long as no write happens at the same time
+// Bulk functions split the work per shard and run in parallel
+template<typename PayloadType = int32>
+class TVoxelSpatialHashGrid
+{
+public:
+	static constexpr int32 NumShards = 16;
+	static constexpr int64 MaxCellsPerElement = 64;
+	// Cells are clamped to this so that huge or infinite bounds don't overflow
+	static constexpr int32 MaxCellCoordinate = 1 << 30;
+
+	struct FElement
+	{
+		FVoxelBox Bounds;
+		// Inclusive
+		FIntVector CellMin = FIntVector(ForceInit);
+		FIntVector CellMax = FIntVector(ForceInit);
+		PayloadType Payload = {};
+	};
+
+	const double CellSize;
+
+	explicit TVoxelSpatialHashGrid(const double CellSize)
+		: CellSize(CellSize)
+	{
+		ensure(CellSize > 0);
+	}
+
+public:
+	FORCEINLINE int32 Num() const
+	{
+		return Elements.Num();
+	}
+	FORCEINLINE bool IsValidId(const int32 Id) const
+	{
+		return Elements.IsValidIndex(Id);
+	}
+	FORCEINLINE const FElement& GetElement(const int32 Id) const
+	{
+		return Elements[Id];
+	}
+	FORCEINLINE const PayloadType& GetPayload(const int32 Id) const
+	{
+		return Elements[Id].Payload;
+	}
+	FORCEINLINE const FVoxelBox& GetBounds(const int32 Id) const
+	{
+		return Elements[Id].Bounds;
+	}
+
+	int64 GetAllocatedSize() const
+	{
+		int64 AllocatedSize = Elements.GetAllocatedSize() + LargeElementIds.GetAllocatedSize();
+		for (const FShard& Shard : Shards)
+		{
+			AllocatedSize += Shard.GetAllocatedSize();
+			for (const auto& It : Shard)
+			{
+				AllocatedSize += It.Value.GetAllocatedSize();
+			}
+		}
+		return AllocatedSize;
+	}
+
+	void Reset()
+	{
+		Elements.Reset();
+		LargeElementIds.Reset();
+		for (FShard& Shard : Shards)
+		{
+			Shard.Reset();
+		}
+	}
+
+	FORCEINLINE void GetCells(
+		const FVoxelBox& Bounds,
+		FIntVector& OutCellMin,
+		FIntVector& OutCellMax) const
+	{
+		OutCellMin = FVoxelUtilities::FloorToInt((Bounds.Min / CellSize).BoundToCube(MaxCellCoordinate));
+		OutCellMax = FVoxelUtilities::FloorToInt((Bounds.Max / CellSize).BoundToCube(MaxCellCoordinate));
+	}
+
+public:
+	int32 Add(
+		const FVoxelBox& Bounds,
+		const PayloadType& Payload)
+	{
+		FElement Element;
+		Element.Bounds = Bounds;
+		Element.Payload = Payload;
+		GetCells(Bounds, Element.CellMin, Element.CellMax);
+
+		const int32 Id = Elements.Add(Element);
+		AddToCells(Id, Element.CellMin, Element.CellMax);
+		return Id;
+	}
+	void Remove(const int32 Id)
+	{
+		const FElement& Element = Elements[Id];
+		RemoveFromCells(Id, Element.CellMin, Element.CellMax);
+		Elements.RemoveAt(Id);
+	}
+	void Update(
+		const int32 Id,
+		const FVoxelBox& NewBounds)
+	{
+		FElement& Element = Elements[Id];
+		Element.Bounds = NewBounds;
+
+		FIntVector NewCellMin;
+		FIntVector NewCellMax;
+		GetCells(NewBounds, NewCellMin, NewCellMax);
+
+		if (NewCellMin == Element.CellMin &&
+			NewCellMax == Element.CellMax)
+		{
+			// Most updates of small objects don't change cells
+			return;
+		}
+
+		if (IsLarge(Element.CellMin, Element.CellMax) ||
+			IsLarge(NewCellMin, NewCellMax))
+		{
+			RemoveFromCells(Id, Element.CellMin, Element.CellMax);
+			AddToCells(Id, NewCellMin, NewCellMax);
+		}
+		else
+		{
+			ForeachCell(Element.CellMin, Element.CellMax, [&](const FIntVector& Cell)
+			{
+				if (!IsInCells(Cell, NewCellMin, NewCellMax))
+				{
+					RemoveFromCell(GetShard(Cell), Cell, Id);
+				}
+			});
+			ForeachCell(NewCellMin, NewCellMax, [&](const FIntVector& Cell)
+			{
+				if (!IsInCells(Cell, Element.CellMin, Element.CellMax))
+				{
+					GetShard(Cell).FindOrAdd(Cell).Add(Id);
+				}
+			});
+		}
+
+		Element.CellMin = NewCellMin;
+		Element.CellMax = NewCellMax;
+	}
+
+public:
+	void BulkAdd(
+		const TConstVoxelArrayView<FVoxelBox> Bounds,
+		const TConstVoxelArrayView<PayloadType> Payloads,
+		TVoxelArray<int32>& OutIds)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Bounds.Num(), 128);
+		check(Bounds.Num() == Payloads.Num());
+
+		FVoxelUtilities::SetNumFast(OutIds, Bounds.Num());
+
+		for (int32 Index = 0; Index < Bounds.Num(); Index++)
+		{
+			FElement Element;
+			Element.Bounds = Bounds[Index];
+			Element.Payload = Payloads[Index];
+			GetCells(Element.Bounds, Element.CellMin, Element.CellMax);
+
+			OutIds[Index] = Elements.Add(Element);
+
+			if (IsLarge(Element.CellMin, Element.CellMax))
+			{
+				LargeElementIds.Add(OutIds[Index]);
+			}
+		}
+
+		ParallelFor(NumShards, [&](const int32 ShardIndex)
+		{
+			VOXEL_SCOPE_COUNTER("Add to shard");
+
+			FShard& Shard = Shards[ShardIndex];
+			for (const int32 Id : OutIds)
+			{
+				const FElement& Element = Elements[Id];
+				if (IsLarge(Element.CellMin, Element.CellMax))
+				{
+					continue;
+				}
+
+				ForeachCell(Element.CellMin, Element.CellMax, [&](const FIntVector& Cell)
+				{
+					if (GetShardIndex(Cell) == ShardIndex)
+					{
+						Shard.FindOrAdd(Cell).Add(Id);
+					}
+				});
+			}
+		});
+	}
+	void BulkUpdate(
+		const TConstVoxelArrayView<int32> Ids,
+		const TConstVoxelArrayView<FVoxelBox> NewBounds)
+	{
+		VOXEL_FUNCTION_COUNTER_NUM(Ids.Num(), 128);
+		check(Ids.Num() == NewBounds.Num());
+
+		struct FMovedElement
+		{
+			int32 Id;
+			FIntVector OldCellMin;
+			FIntVector OldCellMax;
+		};
+		TVoxelArray<FMovedElement> MovedElements;
+
+		for (int32 Index = 0; Index < Ids.Num(); Index++)
+		{
+			FElement& Element = Elements[Ids[Index]];
+			Element.Bounds = NewBounds[Index];
+
+			FIntVector NewCellMin;
+			FIntVector NewCellMax;
+			GetCells(Element.Bounds, NewCellMin, NewCellMax);
+
+			if (NewCellMin == Element.CellMin &&
+				NewCellMax == Element.CellMax)
+			{
+				continue;
+			}
+
+			if (IsLarge(Element.CellMin, Element.CellMax) ||
+				IsLarge(NewCellMin, NewCellMax))
+			{
+				// Rare, not worth handling in the shards
+				RemoveFromCells(Ids[Index], Element.CellMin, Element.CellMax);
+				AddToCells(Ids[Index], NewCellMin, NewCellMax);
+			}
+			else
+			{
+				MovedElements.Add(FMovedElement
+				{
+					Ids[Index],
+					Element.CellMin,
+					Element.CellMax
+				});
+			}
+
+			Element.CellMin = NewCellMin;
+			Element.CellMax = NewCellMax;
+		}
+
+		if (MovedElements.Num() == 0)
+		{
+			return;
+		}
+
+		// Each shard is only touched by one thread
+		ParallelFor(NumShards, [&](const int32 ShardIndex)
+		{
+			VOXEL_SCOPE_COUNTER("Update shard");
+
+			FShard& Shard = Shards[ShardIndex];
+			for (const FMovedElement& MovedElement : MovedElements)
+			{
+				const FElement& Element = Elements[MovedElement.Id];
+
+				ForeachCell(MovedElement.OldCellMin, MovedElement.OldCellMax, [&](const FIntVector& Cell)
+				{
+					if (GetShardIndex(Cell) == ShardIndex &&
+						!IsInCells(Cell, Element.CellMin, Element.CellMax))
+					{
+						RemoveFromCell(Shard, Cell, MovedElement.Id);
+					}
+				});
+				ForeachCell(Element.CellMin, Element.CellMax, [&](const FIntVector& Cell)
+				{
+					if (GetShardIndex(Cell) == ShardIndex &&
+						!IsInCells(Cell, MovedElement.OldCellMin, MovedElement.OldCellMax))
+					{
+						Shard.FindOrAdd(Cell).Add(MovedElement.Id);
+					}
+				});
+			}
+		});
+	}
+
+public:
+	// Lambda: void(int32 Id, const PayloadType&) or EVoxelIterate(int32 Id, const PayloadType&)
+	// Each element is visited at most once
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		std::is_void_v<ReturnType> ||
+		std::is_same_v<ReturnType, EVoxelIterate>
+	)
+	EVoxelIterate ForeachIntersecting(
+		const FVoxelBox& Bounds,
+		LambdaType Lambda) const
+	{
+		return ForeachCandidate(Bounds, [&](const int32 Id, const FElement& Element)
+		{
+			if (!Element.Bounds.Intersects(Bounds))
+			{
+				return EVoxelIterate::Continue;
+			}
+
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(Id, Element.Payload);
+				return EVoxelIterate::Continue;
+			}
+			else
+			{
+				return Lambda(Id, Element.Payload);
+			}
+		});
+	}
+	template<typename LambdaType, typename ReturnType = LambdaReturnType_T<LambdaType>>
+	requires
+	(
+		std::is_void_v<ReturnType> ||
+		std::is_same_v<ReturnType, EVoxelIterate>
+	)
+	EVoxelIterate ForeachIntersectingSphere(
+		const FVector& Center,
+		const double Radius,
+		LambdaType Lambda) const
+	{
+		return ForeachCandidate(FVoxelBox(Center - Radius, Center + Radius), [&](const int32 Id, const FElement& Element)
+		{
+			if (!Element.Bounds.IntersectsSphere(Center, Radius))
+			{
+				return EVoxelIterate::Continue;
+			}
+
+			if constexpr (std::is_void_v<ReturnType>)
+			{
+				Lambda(Id, Element.Payload);
+				return EVoxelIterate::Continue;
+			}
+			else
+			{
+				return Lambda(Id, Element.Payload);
+			}
+		});
+	}
+
+	bool Intersects(const FVoxelBox& Bounds) const
+	{
+		return ForeachIntersecting(Bounds, [](int32, const PayloadType&)
+		{
+			return EVoxelIterate::Stop;
+		}) == EVoxelIterate::Stop;
+	}
+
+private:
+	using FShard = TVoxelMap<FIntVector, TVoxelInlineArray<int32, 4>>;
+
+	TVoxelSparseArray<FElement> Elements;
+	TVoxelArray<int32> LargeElementIds;
+	TVoxelStaticArray<FShard, NumShards> Shards;
+
+	FORCEINLINE static int32 GetShardIndex(const FIntVector& Cell)
+	{
+		// Use the high bits, the low ones are used by the map itself
+		return FVoxelUtilities::HashValue(Cell) >> (32 - FVoxelUtilities::ExactLog2<NumShards>());
+	}
+	FORCEINLINE FShard& GetShard(const FIntVector& Cell)
+	{
+		return Shards[GetShardIndex(Cell)];
+	}
+	FORCEINLINE const FShard& GetShard(const FIntVector& Cell) const
+	{
+		return Shards[GetShardIndex(Cell)];
+	}
+
+	FORCEINLINE static bool IsInCells(
+		const FIntVector& Cell,
+		const FIntVector& CellMin,
+		const FIntVector& CellMax)
+	{
+		return
+			CellMin.X <= Cell.X && Cell.X <= CellMax.X &&
+			CellMin.Y <= Cell.Y && Cell.Y <= CellMax.Y &&
+			CellMin.Z <= Cell.Z && Cell.Z <= CellMax.Z;
+	}
+
+	FORCEINLINE static double GetNumCells(
+		const FIntVector& CellMin,
+		const FIntVector& CellMax)
+	{
+		// Can overflow int64
+		return
+			double(int64(CellMax.X) - CellMin.X + 1) *
+			double(int64(CellMax.Y) - CellMin.Y + 1) *
+			double(int64(CellMax.Z) - CellMin.Z + 1);
+	}
+	FORCEINLINE static bool IsLarge(
+		const FIntVector& CellMin,
+		const FIntVector& CellMax)
+	{
+		return GetNumCells(CellMin, CellMax) > MaxCellsPerElement;
+	}
+
+	template<typename LambdaType>
+	FORCEINLINE static void ForeachCell(
+		const FIntVector& CellMin,
+		const FIntVector& CellMax,
+		LambdaType&& Lambda)
+	{
+		for (int32 Z = CellMin.Z; Z <= CellMax.Z; Z++)
+		{
+			for (int32 Y = CellMin.Y; Y <= CellMax.Y; Y++)
+			{
+				for (int32 X = CellMin.X; X <= CellMax.X; X++)
+				{
+					Lambda(FIntVector(X, Y, Z));
+				}
+			}
+		}
+	}
+
+	void AddToCells(
+		const int32 Id,
+		const FIntVector& CellMin,
+		const FIntVector& CellMax)
+	{
+		if (IsLarge(CellMin, CellMax))
+		{
+			LargeElementIds.Add(Id);
+			return;
+		}
+
+		ForeachCell(CellMin, CellMax, [&](const FIntVector& Cell)
+		{
+			GetShard(Cell).FindOrAdd(Cell).Add(Id);
+		});
+	}
+	void RemoveFromCells(
+		const int32 Id,
+		const FIntVector& CellMin,
+		const FIntVector& CellMax)
+	{
+		if (IsLarge(CellMin, CellMax))
+		{
+			ensureVoxelSlow(LargeElementIds.RemoveSingleSwap(Id) == 1);
+			return;
+		}
+
+		ForeachCell(CellMin, CellMax, [&](const FIntVector& Cell)
+		{
+			RemoveFromCell(GetShard(Cell), Cell, Id);
+		});
+	}
+	static void RemoveFromCell(
+		FShard& Shard,
+		const FIntVector& Cell,
+		const int32 Id)
+	{
+		TVoxelInlineArray<int32, 4>& Ids = Shard.FindChecked(Cell);
+		Ids.RemoveAtSwap(Ids.Find(Id));
+
+		if (Ids.Num() == 0)
+		{
+			Shard.RemoveChecked(Cell);
+		}
+	}
+
+	// Lambda: EVoxelIterate(int32 Id, const FElement&)
+	template<typename LambdaType>
+	EVoxelIterate ForeachCandidate(
+		const FVoxelBox& Bounds,
+		LambdaType&& Lambda) const
+	{
+		FIntVector QueryCellMin;
+		FIntVector QueryCellMax;
+		GetCells(Bounds, QueryCellMin, QueryCellMax);
+
+		// Large queries: scanning all the elements is cheaper than looking up every cell
+		if (GetNumCells(QueryCellMin, QueryCellMax) > Elements.Num())
+		{
+			return Elements.Foreach([&](const FElement& Element, const int32 Id)
+			{
+				return Lambda(Id, Element);
+			});
+		}
+
+		for (const int32 Id : LargeElementIds)
+		{
+			if (Lambda(Id, Elements[Id]) == EVoxelIterate::Stop)
+			{
+				return EVoxelIterate::Stop;
+			}
+		}
+
+		for (int32 Z = QueryCellMin.Z; Z <= QueryCellMax.Z; Z++)
+		{
+			for (int32 Y = QueryCellMin.Y; Y <= QueryCellMax.Y; Y++)
+			{
+				for (int32 X = QueryCellMin.X; X <= QueryCellMax.X; X++)
+				{
+					const FIntVector Cell(X, Y, Z);
+
+					const TVoxelInlineArray<int32, 4>* Ids = GetShard(Cell).Find(Cell);
+					if (!Ids)
+					{
+						continue;
+					}
+
+					for (const int32 Id : *Ids)
+					{
+						const FElement& Element = Elements[Id];
+
+						// Elements spanning several cells are only reported in the first cell shared with the query
+						// This avoids needing a visited set, keeping queries const & thread safe
+						if (Cell != FVoxelUtilities::ComponentMax(QueryCellMin, Element.CellMin))
+						{
+							continue;
+						}
+
+						if (Lambda(Id, Element) == EVoxelIterate::Stop)
+						{
+							return EVoxelIterate::Stop;
+						}
+					}
+				}
+			}
+		}
+
+		return EVoxelIterate::Continue;
+	}
+};
\ No newline at end of file
@@ -15,6 +15,8 @@ public:
 		const FReadLambda& ReadLambda);
 
 	static TSharedPtr<FVoxelZipReader> Create(TConstVoxelArrayView64<uint8> BulkData);
+	// Keeps the file mapped for as long as the reader is alive
+	static TSharedPtr<FVoxelZipReader> Create(const TSharedRef<const FVoxelMappedFile>& MappedFile);
 
 public:
 	FORCEINLINE int32 NumFiles() const